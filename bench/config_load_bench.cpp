@@ -0,0 +1,94 @@
+// Compares loading the project list from projects.json and from the binary snapshot.
+// Usage: config_load_bench [output directory]
+
+#include "project.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using namespace unreal;
+
+namespace
+{
+std::vector<Project> makeProjects(size_t count)
+{
+    std::vector<Project> projects;
+    projects.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Project proj;
+        proj.name = "Project" + std::to_string(i);
+        proj.path = "/home/user/UnrealProjects/Team" + std::to_string(i % 16) + "/" + proj.name;
+        proj.uprojectPath = proj.path / (proj.name + ".uproject");
+        proj.engineVersion = i % 3 == 0 ? "5.3" : "5.4";
+        if (i % 2 == 0)
+            proj.iconPath = proj.path / (proj.name + ".png");
+        proj.commandLineArgs = i % 4 == 0 ? "-log -windowed" : "";
+        projects.push_back(proj);
+    }
+    return projects;
+}
+
+void writeJson(const std::vector<Project>& projects, const std::filesystem::path& path)
+{
+    nlohmann::json json;
+    json["projects"] = nlohmann::json::array();
+    for (const auto& proj : projects)
+    {
+        nlohmann::json item;
+        item["name"] = proj.name;
+        item["path"] = proj.path.string();
+        item["uprojectPath"] = proj.uprojectPath.string();
+        item["engineVersion"] = proj.engineVersion;
+        item["iconPath"] = proj.iconPath ? nlohmann::json(proj.iconPath->string()) : nlohmann::json(nullptr);
+        item["commandLineArgs"] = proj.commandLineArgs;
+        json["projects"].push_back(item);
+    }
+    std::ofstream(path) << json.dump(4);
+}
+
+template <typename Fn> double bestOf(int runs, Fn&& fn)
+{
+    double best = 1e30;
+    for (int i = 0; i < runs; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+    }
+    return best;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::filesystem::path dir = argc > 1 ? argv[1] : std::filesystem::temp_directory_path() / "imunreal-bench";
+    std::filesystem::create_directories(dir);
+
+    printf("%10s %12s %14s %9s\n", "projects", "json (ms)", "snapshot (ms)", "speedup");
+    for (size_t count : {size_t(100), size_t(10000), size_t(100000)})
+    {
+        auto projects = makeProjects(count);
+        auto jsonPath = dir / ("projects_" + std::to_string(count) + ".json");
+        auto snapshotPath = ProjectSnapshot::pathFor(jsonPath);
+        writeJson(projects, jsonPath);
+        ProjectSnapshot::write(projects, snapshotPath, *SourceStamp::fromFile(jsonPath));
+
+        int runs = count >= 100000 ? 3 : 10;
+        size_t loaded = 0;
+        double jsonMs = bestOf(runs, [&]() { loaded = ProjectManager::readConfig(jsonPath).size(); });
+        double snapshotMs = bestOf(runs, [&]() { loaded = ProjectSnapshot::read(snapshotPath)->size(); });
+
+        if (loaded != count)
+        {
+            fprintf(stderr, "Loaded %zu projects, expected %zu\n", loaded, count);
+            return 1;
+        }
+        printf("%10zu %12.2f %14.2f %8.1fx\n", count, jsonMs, snapshotMs, jsonMs / snapshotMs);
+    }
+    return 0;
+}
@@ -1,11 +1,17 @@
 #include "app.h"
+#include "cgroup.h"
 #include "config.h"
+#include "editor_supervisor.h"
+#include "prefetch.h"
+#include "tasks.h"
+#include "trace.h"
+#include "trash.h"
 #include <spdlog/spdlog.h>
 
 namespace unreal
 {
 
-App::App() {}
+App::App() : m_startTime(std::chrono::steady_clock::now()) {}
 
 App::~App()
 {
@@ -15,20 +21,58 @@ App::~App()
 bool App::init()
 {
     spdlog::info("Initializing Unreal Launcher...");
+    Trace::setThreadName("Main");
+    TRACE_SCOPE("App::init", "startup");
 
     // Setup log callback for project manager
     m_projectManager.setLogCallback([this](const std::string& msg, bool isError) { m_ui.log(msg, isError); });
-
-    // Load configuration
-    loadConfig();
+    TrashDeleter::instance().setLogCallback([this](const std::string& msg, bool isError) { m_ui.log(msg, isError); });
+    EditorPrefetcher::instance().setLogCallback(
+        [this](const std::string& msg, bool isError) { m_ui.log(msg, isError); });
+    EditorSupervisor::instance().setLogCallback(
+        [this](const std::string& msg, bool isError) { m_ui.log(msg, isError); });
+
+    // Everything that does not need the window runs while it is being created
+    TaskGraph startup;
+    auto enginesTask =
+        startup.add("Load engines", [this]() { m_engineManager.load(Config::instance().getEnginesConfigPath()); });
+    auto projectsTask = startup.add("Load projects",
+                                    [this]()
+                                    {
+                                        m_projectManager.load(Config::instance().getProjectsConfigPath());
+                                        m_projectManager.startChecks();
+                                    });
+    auto iconTask = startup.add("Decode default icon", [this]() { m_ui.decodeDefaultIcon(); });
+    startup.add("Resume trash", []() { TrashDeleter::instance().resume(); });
+    startup.add("Setup resource groups", []() { ResourceGroups::instance().init(); });
+    startup.start();
 
     // Initialize UI
-    if (!m_ui.init())
+    auto windowStart = std::chrono::steady_clock::now();
+    bool uiReady = false;
+    {
+        TRACE_SCOPE("Create window", "startup");
+        uiReady = m_ui.init();
+    }
+    double windowMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - windowStart).count();
+
+    {
+        TRACE_SCOPE("Wait for startup tasks", "startup");
+        startup.waitAll();
+    }
+    if (!uiReady)
     {
         spdlog::error("Failed to initialize UI");
         return false;
     }
 
+    spdlog::info("Startup: window {:.1f} ms, engines {:.1f} ms, projects {:.1f} ms, default icon {:.1f} ms",
+                 windowMs, startup.getDurationMs(enginesTask), startup.getDurationMs(projectsTask),
+                 startup.getDurationMs(iconTask));
+
+    trackConfig();
+
     // Connect managers to UI
     m_ui.setProjectManager(&m_projectManager);
     m_ui.setEngineManager(&m_engineManager);
@@ -41,36 +85,55 @@ void App::run()
 {
     while (!m_ui.shouldClose())
     {
+        m_projectManager.update();
         m_ui.render();
+        m_persistence.update();
+
+        if (!m_firstFrameRendered)
+        {
+            m_firstFrameRendered = true;
+            double elapsed =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+            m_ui.log("Time to first frame: " + std::to_string(static_cast<int>(elapsed)) + " ms");
+            spdlog::info("Time to first frame: {:.1f} ms", elapsed);
+        }
     }
 }
 
 void App::shutdown()
 {
+    if (m_shutdown)
+        return;
+    m_shutdown = true;
+
     spdlog::info("Shutting down Unreal Launcher...");
 
-    // Save configuration
+    // Write pending changes
     saveConfig();
 
+    TrashDeleter::instance().setLogCallback(nullptr);
+    EditorPrefetcher::instance().cancel();
+    EditorPrefetcher::instance().setLogCallback(nullptr);
+    EditorSupervisor::instance().setLogCallback(nullptr);
     m_ui.shutdown();
+    EditorSupervisor::instance().shutdown();
 
     spdlog::info("Unreal Launcher shutdown complete");
 }
 
-void App::loadConfig()
+void App::trackConfig()
 {
-    auto& config = Config::instance();
-
-    m_engineManager.load(config.getEnginesConfigPath());
-    m_projectManager.load(config.getProjectsConfigPath());
+    m_persistence.track(
+        "engines", [this]() { return m_engineManager.getRevision(); },
+        [this]() { return m_engineManager.createSaveTask(Config::instance().getEnginesConfigPath()); });
+    m_persistence.track(
+        "projects", [this]() { return m_projectManager.getRevision(); },
+        [this]() { return m_projectManager.createSaveTask(Config::instance().getProjectsConfigPath()); });
 }
 
 void App::saveConfig()
 {
-    auto& config = Config::instance();
-
-    m_engineManager.save(config.getEnginesConfigPath());
-    m_projectManager.save(config.getProjectsConfigPath());
+    m_persistence.flush();
 }
 
 } // namespace unreal
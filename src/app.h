@@ -1,6 +1,9 @@
 #pragma once
 
+#include <chrono>
+
 #include "engine.h"
+#include "persistence.h"
 #include "project.h"
 #include "ui.h"
 
@@ -18,12 +21,17 @@ class App
     void shutdown();
 
   private:
-    void loadConfig();
+    void trackConfig();
     void saveConfig();
 
     UI m_ui;
     ProjectManager m_projectManager;
     EngineManager m_engineManager;
+    ConfigPersistence m_persistence;
+    bool m_shutdown = false;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_firstFrameRendered = false;
 };
 
 } // namespace unreal
@@ -0,0 +1,295 @@
+#include "archive.h"
+#include "sha256.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+#include <zstd.h>
+
+namespace unreal
+{
+
+namespace
+{
+// 2: file hashes are SHA-256, named by "hashAlgorithm"
+constexpr int kManifestVersion = 2;
+constexpr int kCompressionLevel = 3;
+// Input handed to zstd per call, large enough to keep its workers busy
+constexpr size_t kFeedSize = 4 << 20;
+constexpr size_t kBlockSize = 512;
+
+struct ArchiveEntry
+{
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    unsigned mode = 0644;
+    bool directory = false;
+};
+
+// file_clock has no portable epoch before C++20's clock_cast, offset it by the distance between the two clocks
+int64_t toUnixSeconds(std::filesystem::file_time_type time)
+{
+    auto system = std::chrono::system_clock::now() + (time - std::filesystem::file_time_type::clock::now());
+    return std::chrono::duration_cast<std::chrono::seconds>(system.time_since_epoch()).count();
+}
+
+void writeOctal(char* field, size_t length, uint64_t value)
+{
+    snprintf(field, length, "%0*llo", static_cast<int>(length - 1), static_cast<unsigned long long>(value));
+}
+
+// "<length> key=value\n" where length counts the whole record including its own digits
+std::string paxRecord(const std::string& key, const std::string& value)
+{
+    size_t length = key.size() + value.size() + 3;
+    size_t digits = std::to_string(length).size();
+    while (std::to_string(length + digits).size() != digits)
+        digits++;
+    return std::to_string(length + digits) + " " + key + "=" + value + "\n";
+}
+
+class CompressedWriter
+{
+  public:
+    CompressedWriter(FILE* file) : m_file(file), m_output(ZSTD_CStreamOutSize())
+    {
+        m_context = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel, kCompressionLevel);
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_checksumFlag, 1);
+        // Fails without multithread support, zstd then compresses on this thread
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_nbWorkers,
+                               static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    }
+    ~CompressedWriter()
+    {
+        ZSTD_freeCCtx(m_context);
+    }
+
+    bool write(const void* data, size_t size)
+    {
+        return compress(data, size, ZSTD_e_continue);
+    }
+    bool finish()
+    {
+        return compress(nullptr, 0, ZSTD_e_end);
+    }
+    uint64_t getWritten() const
+    {
+        return m_written;
+    }
+
+  private:
+    bool compress(const void* data, size_t size, ZSTD_EndDirective mode)
+    {
+        ZSTD_inBuffer input = {data, size, 0};
+        while (true)
+        {
+            ZSTD_outBuffer output = {m_output.data(), m_output.size(), 0};
+            size_t remaining = ZSTD_compressStream2(m_context, &output, &input, mode);
+            if (ZSTD_isError(remaining))
+            {
+                spdlog::error("zstd compression failed: {}", ZSTD_getErrorName(remaining));
+                return false;
+            }
+            if (output.pos > 0 && fwrite(m_output.data(), 1, output.pos, m_file) != output.pos)
+                return false;
+            m_written += output.pos;
+
+            bool done = mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size;
+            if (done)
+                return true;
+        }
+    }
+
+    FILE* m_file;
+    ZSTD_CCtx* m_context = nullptr;
+    std::vector<char> m_output;
+    uint64_t m_written = 0;
+};
+
+bool writeHeader(CompressedWriter& writer, const std::string& name, uint64_t size, int64_t mtime, unsigned mode,
+                 char type)
+{
+    char header[kBlockSize] = {};
+    memcpy(header, name.data(), std::min<size_t>(name.size(), 100));
+    writeOctal(header + 100, 8, mode & 07777);
+    writeOctal(header + 108, 8, 0);
+    writeOctal(header + 116, 8, 0);
+    // Sizes beyond the 11 octal digits are carried by the pax header
+    writeOctal(header + 124, 12, size < 077777777777ull ? size : 0);
+    writeOctal(header + 136, 12, static_cast<uint64_t>(std::max<int64_t>(mtime, 0)));
+    header[156] = type;
+    memcpy(header + 257, "ustar", 6);
+    memcpy(header + 263, "00", 2);
+
+    memset(header + 148, ' ', 8);
+    unsigned checksum = 0;
+    for (unsigned char c : header)
+        checksum += c;
+    snprintf(header + 148, 8, "%06o", checksum);
+    header[155] = ' ';
+    return writer.write(header, sizeof(header));
+}
+
+bool writePadding(CompressedWriter& writer, uint64_t size)
+{
+    static const char zeros[kBlockSize] = {};
+    size_t padding = static_cast<size_t>((kBlockSize - size % kBlockSize) % kBlockSize);
+    return padding == 0 || writer.write(zeros, padding);
+}
+
+bool writeEntryHeader(CompressedWriter& writer, const ArchiveEntry& entry, const std::string& name)
+{
+    std::string pax;
+    if (name.size() > 100)
+        pax += paxRecord("path", name);
+    if (entry.size >= 077777777777ull)
+        pax += paxRecord("size", std::to_string(entry.size));
+    if (!pax.empty())
+    {
+        if (!writeHeader(writer, "PaxHeader", pax.size(), entry.mtime, 0644, 'x') ||
+            !writer.write(pax.data(), pax.size()) || !writePadding(writer, pax.size()))
+            return false;
+    }
+    return writeHeader(writer, name, entry.directory ? 0 : entry.size, entry.mtime, entry.mode,
+                       entry.directory ? '5' : '0');
+}
+
+std::vector<ArchiveEntry> collectEntries(const std::filesystem::path& root)
+{
+    std::vector<ArchiveEntry> entries;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(root, ec), end;
+    for (; !ec && it != end; it.increment(ec))
+    {
+        bool directory = it->is_directory(ec);
+        if (!directory && !it->is_regular_file(ec))
+            continue;
+
+        ArchiveEntry entry;
+        entry.path = it->path().lexically_relative(root).generic_string();
+        entry.directory = directory;
+        entry.size = directory ? 0 : it->file_size(ec);
+        entry.mode = static_cast<unsigned>(it->status(ec).permissions()) & 07777;
+        entry.mtime = toUnixSeconds(it->last_write_time(ec));
+        entries.push_back(std::move(entry));
+    }
+    // Same entry order on every run, whatever order the filesystem lists them in
+    std::sort(entries.begin(), entries.end(),
+              [](const ArchiveEntry& a, const ArchiveEntry& b) { return a.path < b.path; });
+    return entries;
+}
+} // namespace
+
+ArchiveResult writeCompressedArchive(const std::filesystem::path& root, const std::string& prefix,
+                                     const std::filesystem::path& archivePath, const std::atomic<bool>& cancelled,
+                                     const ArchiveProgressCallback& progress)
+{
+    TRACE_SCOPE("Compress package", "operations", root.string());
+    auto start = std::chrono::steady_clock::now();
+    ArchiveResult result;
+
+    auto entries = collectEntries(root);
+    uint64_t total = 0;
+    for (const auto& entry : entries)
+    {
+        total += entry.size;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(archivePath.parent_path(), ec);
+    auto partPath = archivePath;
+    partPath += ".part";
+    FILE* file = fopen(partPath.string().c_str(), "wb");
+    if (!file)
+    {
+        spdlog::error("Failed to create {}", partPath.string());
+        return result;
+    }
+
+    nlohmann::json manifest;
+    manifest["version"] = kManifestVersion;
+    manifest["hashAlgorithm"] = "sha256";
+    auto& files = manifest["files"] = nlohmann::json::object();
+
+    bool ok = true;
+    {
+        CompressedWriter writer(file);
+        for (const auto& entry : entries)
+        {
+            if (cancelled)
+            {
+                ok = false;
+                break;
+            }
+
+            std::string name = prefix.empty() ? entry.path : prefix + "/" + entry.path;
+            if (entry.directory)
+            {
+                ok = writeEntryHeader(writer, entry, name + "/");
+                if (!ok)
+                    break;
+                continue;
+            }
+
+            MappedFile mapped;
+            if (entry.size > 0 && (!mapped.open(root / entry.path) || mapped.size() != entry.size))
+            {
+                spdlog::error("Failed to read {}", (root / entry.path).string());
+                ok = false;
+                break;
+            }
+
+            // Hashed chunk by chunk while the chunk is still in cache from compressing it
+            Sha256 hash;
+            ok = writeEntryHeader(writer, entry, name);
+            for (size_t offset = 0; ok && offset < mapped.size() && !cancelled; offset += kFeedSize)
+            {
+                size_t size = std::min(kFeedSize, mapped.size() - offset);
+                ok = writer.write(mapped.data() + offset, size);
+                hash.update(mapped.data() + offset, size);
+                result.inputBytes += size;
+                if (progress)
+                    progress(result.inputBytes, total);
+            }
+            ok = ok && !cancelled && writePadding(writer, entry.size);
+            if (!ok)
+                break;
+
+            files[name] = {{"size", entry.size}, {"hash", hash.finishHex()}};
+            result.files++;
+        }
+
+        // Two zero blocks end the tar stream
+        static const char zeros[kBlockSize * 2] = {};
+        ok = ok && writer.write(zeros, sizeof(zeros)) && writer.finish();
+        result.outputBytes = writer.getWritten();
+    }
+    ok = fclose(file) == 0 && ok;
+
+    result.cancelled = cancelled;
+    if (ok)
+    {
+        manifest["compressedBytes"] = result.outputBytes;
+        auto manifestPath = archivePath;
+        manifestPath += ".json";
+        std::filesystem::rename(partPath, archivePath, ec);
+        ok = !ec && writeFileAtomic(manifestPath, manifest.dump(2));
+    }
+    if (!ok)
+        std::filesystem::remove(partPath, ec);
+
+    result.success = ok;
+    result.durationMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace unreal
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace unreal
+{
+
+struct ArchiveResult
+{
+    bool success = false;
+    bool cancelled = false;
+    size_t files = 0;
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    double durationMs = 0.0;
+};
+
+using ArchiveProgressCallback = std::function<void(uint64_t done, uint64_t total)>;
+
+// Streams every file under root into a tar archive (entries named prefix/<relative path>) compressed with zstd
+// on all cores, and writes a manifest with the size and SHA-256 of each file to archivePath + ".json". The archive
+// is written under a temporary name and only appears once it is complete.
+ArchiveResult writeCompressedArchive(const std::filesystem::path& root, const std::string& prefix,
+                                     const std::filesystem::path& archivePath, const std::atomic<bool>& cancelled,
+                                     const ArchiveProgressCallback& progress = nullptr);
+
+} // namespace unreal
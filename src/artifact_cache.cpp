@@ -0,0 +1,517 @@
+#include "artifact_cache.h"
+#include "config.h"
+#include "sha256.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+// 2: objects named by the SHA-256 of their content, sizes stored in the entry
+constexpr int kEntryVersion = 2;
+
+enum class PlaceMethod
+{
+    Failed,
+    Reflink,
+    Copy
+};
+
+struct ArtifactFile
+{
+    std::string path;
+    std::string object;
+    uint64_t size = 0;
+    unsigned mode = 0644;
+};
+
+int64_t nowSeconds()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool tryReflink(const std::filesystem::path& source, const std::filesystem::path& target)
+{
+#ifdef __linux__
+    int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+    int out = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0)
+    {
+        close(in);
+        return false;
+    }
+    bool cloned = ioctl(out, FICLONE, in) == 0;
+    close(in);
+    close(out);
+    if (!cloned)
+        unlink(target.c_str());
+    return cloned;
+#else
+    return false;
+#endif
+}
+
+// target must not exist. Never a hardlink: UBT and the editor may rewrite an output in place, which would
+// corrupt the cache object sharing its inode.
+PlaceMethod placeFile(const std::filesystem::path& source, const std::filesystem::path& target)
+{
+    if (tryReflink(source, target))
+        return PlaceMethod::Reflink;
+
+    std::error_code ec;
+    std::filesystem::copy_file(source, target, ec);
+    return ec ? PlaceMethod::Failed : PlaceMethod::Copy;
+}
+
+// Lowercase hex SHA-256 of a whole file, empty when it cannot be read
+std::string hashFile(const std::filesystem::path& path)
+{
+    // Empty files cannot be mapped
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) == 0 && !ec)
+        return Sha256().finishHex();
+
+    MappedFile mapped;
+    if (!mapped.open(path))
+        return {};
+    Sha256 hasher;
+    hasher.update(mapped.data(), mapped.size());
+    return hasher.finishHex();
+}
+
+std::string toHex(uint64_t value)
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+} // namespace
+
+std::filesystem::path getReceiptPath(const std::filesystem::path& projectDir, const ArtifactTarget& target)
+{
+    auto name = target.target;
+    if (target.configuration != "Development")
+        name += "-" + target.platform + "-" + target.configuration;
+    return projectDir / "Binaries" / target.platform / (name + ".target");
+}
+
+std::vector<std::string> collectOutputs(const std::filesystem::path& projectDir, const ArtifactTarget& target)
+{
+    std::vector<std::string> outputs;
+    auto receipt = getReceiptPath(projectDir, target);
+    try
+    {
+        std::ifstream file(receipt);
+        if (!file.is_open())
+            return outputs;
+        nlohmann::json json;
+        file >> json;
+
+        static const std::string kProjectDir = "$(ProjectDir)/";
+        for (const auto& product : json.value("BuildProducts", nlohmann::json::array()))
+        {
+            auto path = product.value("Path", "");
+            if (path.rfind(kProjectDir, 0) != 0)
+                continue;
+            auto relative = std::filesystem::path(path.substr(kProjectDir.size())).lexically_normal();
+            if (relative.empty() || *relative.begin() == "..")
+                continue;
+            outputs.push_back(relative.generic_string());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Failed to read target receipt {}: {}", receipt.string(), e.what());
+        return {};
+    }
+    outputs.push_back(receipt.lexically_relative(projectDir).generic_string());
+    std::sort(outputs.begin(), outputs.end());
+    outputs.erase(std::unique(outputs.begin(), outputs.end()), outputs.end());
+    return outputs;
+}
+
+ArtifactCache& ArtifactCache::instance()
+{
+    static ArtifactCache instance;
+    return instance;
+}
+
+ArtifactCache::ArtifactCache()
+{
+    m_root = Config::instance().getArtifactCacheDirectory();
+    auto settings = Config::instance().getArtifactCacheSettings();
+    m_enabled = settings.enabled;
+    m_maxSize = settings.maxSize;
+}
+
+std::string ArtifactCache::makeKey(uint64_t fingerprint, const std::string& buildKey)
+{
+    return toHex(hashBytes(buildKey.data(), buildKey.size(), fingerprint));
+}
+
+std::filesystem::path ArtifactCache::getObjectPath(const std::string& object) const
+{
+    return m_root / "objects" / object.substr(0, 2) / object;
+}
+
+std::filesystem::path ArtifactCache::getEntryPath(const std::string& key) const
+{
+    return m_root / "entries" / (key + ".json");
+}
+
+ArtifactCacheResult ArtifactCache::store(const std::filesystem::path& projectDir, const std::string& key,
+                                         const ArtifactTarget& target)
+{
+    TRACE_SCOPE("Store artifacts", "operations", projectDir.string());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto start = std::chrono::steady_clock::now();
+
+    ArtifactCacheResult result;
+    std::vector<ArtifactFile> files;
+    for (auto& output : collectOutputs(projectDir, target))
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(projectDir / output, ec))
+            continue;
+        ArtifactFile file;
+        file.path = std::move(output);
+        files.push_back(file);
+    }
+    if (files.empty())
+    {
+        spdlog::info("Artifact cache: no receipt outputs for {} {} {}", target.target, target.platform,
+                     target.configuration);
+        return result;
+    }
+
+    std::atomic<size_t> reflinked{0}, copied{0}, failed{0};
+    parallelFor(files.size(),
+                [&](size_t i)
+                {
+                    auto& file = files[i];
+                    auto source = projectDir / file.path;
+
+                    std::error_code ec;
+                    file.size = std::filesystem::file_size(source, ec);
+                    file.object = hashFile(source);
+                    if (ec || file.object.empty())
+                    {
+                        failed++;
+                        return;
+                    }
+
+                    auto status = std::filesystem::status(source, ec);
+                    file.mode = static_cast<unsigned>(status.permissions()) & 0777;
+
+                    auto object = getObjectPath(file.object);
+                    if (std::filesystem::exists(object, ec))
+                        return;
+
+                    // Objects become visible under their final name only once complete
+                    std::filesystem::create_directories(object.parent_path(), ec);
+                    auto temp = object;
+                    temp += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+                    std::filesystem::remove(temp, ec);
+                    auto method = placeFile(source, temp);
+                    if (method == PlaceMethod::Failed)
+                    {
+                        failed++;
+                        return;
+                    }
+                    (method == PlaceMethod::Reflink ? reflinked : copied)++;
+
+                    // Read-only, the store is never written through
+                    std::filesystem::permissions(temp, static_cast<std::filesystem::perms>(file.mode & 0555), ec);
+                    std::filesystem::rename(temp, object, ec);
+                },
+                8);
+
+    if (failed > 0)
+    {
+        spdlog::warn("Artifact cache: {} file(s) of {} could not be stored", failed.load(), projectDir.string());
+        return result;
+    }
+
+    nlohmann::json manifest;
+    manifest["version"] = kEntryVersion;
+    manifest["lastUsed"] = nowSeconds();
+    manifest["target"] = target.target;
+    manifest["platform"] = target.platform;
+    manifest["config"] = target.configuration;
+    auto& entries = manifest["files"] = nlohmann::json::array();
+    for (const auto& file : files)
+    {
+        entries.push_back({file.path, file.object, file.mode, file.size});
+        result.bytes += file.size;
+    }
+    manifest["bytes"] = result.bytes;
+
+    std::error_code ec;
+    std::filesystem::create_directories(getEntryPath(key).parent_path(), ec);
+    if (!writeFileAtomic(getEntryPath(key), manifest.dump()))
+        return result;
+
+    evict();
+
+    result.success = true;
+    result.files = files.size();
+    result.reflinked = reflinked;
+    result.copied = copied;
+    result.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+ArtifactCacheResult ArtifactCache::restore(const std::filesystem::path& projectDir, const std::string& key,
+                                           const ArtifactTarget& target)
+{
+    TRACE_SCOPE("Restore artifacts", "operations", projectDir.string());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto start = std::chrono::steady_clock::now();
+
+    ArtifactCacheResult result;
+    nlohmann::json manifest;
+    try
+    {
+        std::ifstream file(getEntryPath(key));
+        if (!file.is_open())
+            return result;
+        file >> manifest;
+        // Entries of an older layout are left to eviction, their objects are named differently
+        if (manifest.value("version", 0) != kEntryVersion)
+            return result;
+        if (manifest.value("target", "") != target.target || manifest.value("platform", "") != target.platform ||
+            manifest.value("config", "") != target.configuration)
+            return result;
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Dropping broken artifact cache entry {}: {}", key, e.what());
+        std::error_code ec;
+        std::filesystem::remove(getEntryPath(key), ec);
+        return result;
+    }
+
+    std::vector<ArtifactFile> files;
+    std::error_code ec;
+    for (const auto& item : manifest["files"])
+    {
+        ArtifactFile file;
+        file.path = item[0].get<std::string>();
+        file.object = item[1].get<std::string>();
+        file.mode = item[2].get<unsigned>();
+        file.size = item[3].get<uint64_t>();
+        if (!std::filesystem::exists(getObjectPath(file.object), ec))
+        {
+            // Partially evicted or damaged, a normal build will replace it
+            std::filesystem::remove(getEntryPath(key), ec);
+            return result;
+        }
+        files.push_back(file);
+    }
+
+    // What the target has now, read before the cached receipt replaces it
+    auto previous = collectOutputs(projectDir, target);
+
+    std::atomic<size_t> reflinked{0}, copied{0}, failed{0}, corrupt{0};
+    std::atomic<uint64_t> bytes{0};
+    parallelFor(files.size(),
+                [&](size_t i)
+                {
+                    const auto& file = files[i];
+                    auto object = getObjectPath(file.object);
+                    auto output = projectDir / file.path;
+                    auto temp = output;
+                    temp += ".imul-restore";
+
+                    std::error_code ec;
+                    std::filesystem::create_directories(output.parent_path(), ec);
+                    std::filesystem::remove(temp, ec);
+
+                    auto method = placeFile(object, temp);
+                    if (method == PlaceMethod::Failed)
+                    {
+                        failed++;
+                        return;
+                    }
+
+                    // Only what still hashes to its name goes into the project
+                    if (hashFile(temp) != file.object)
+                    {
+                        std::filesystem::remove(temp, ec);
+                        std::filesystem::remove(object, ec);
+                        corrupt++;
+                        failed++;
+                        return;
+                    }
+                    std::filesystem::permissions(temp, static_cast<std::filesystem::perms>(file.mode), ec);
+
+                    // Replaces the name, so a file still hardlinked to the store by an older restore is detached
+                    std::filesystem::rename(temp, output, ec);
+                    if (ec)
+                    {
+                        std::filesystem::remove(temp, ec);
+                        failed++;
+                        return;
+                    }
+
+                    bytes += file.size;
+                    (method == PlaceMethod::Reflink ? reflinked : copied)++;
+                },
+                8);
+
+    if (corrupt > 0)
+    {
+        spdlog::warn("Artifact cache: {} object(s) of entry {} did not match their hash, dropping it", corrupt.load(),
+                     key);
+        std::filesystem::remove(getEntryPath(key), ec);
+    }
+    if (failed > 0)
+    {
+        spdlog::warn("Artifact cache: {} file(s) could not be restored into {}", failed.load(), projectDir.string());
+        return result;
+    }
+
+    // Modules the cached build does not have would otherwise still be found and loaded
+    std::unordered_set<std::string> restored;
+    for (const auto& file : files)
+    {
+        restored.insert(file.path);
+    }
+    for (const auto& output : previous)
+    {
+        std::error_code ec;
+        if (!restored.count(output) && std::filesystem::remove(projectDir / output, ec))
+            result.removed++;
+    }
+
+    manifest["lastUsed"] = nowSeconds();
+    writeFileAtomic(getEntryPath(key), manifest.dump());
+
+    result.success = true;
+    result.files = files.size();
+    result.bytes = bytes;
+    result.reflinked = reflinked;
+    result.copied = copied;
+    result.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void ArtifactCache::evict()
+{
+    TRACE_SCOPE("Evict artifacts", "operations");
+
+    struct Entry
+    {
+        std::filesystem::path path;
+        int64_t lastUsed = 0;
+        // Name and size of every object
+        std::vector<std::pair<std::string, uint64_t>> objects;
+    };
+
+    std::vector<Entry> entries;
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(m_root / "entries", ec))
+    {
+        try
+        {
+            std::ifstream file(item.path());
+            nlohmann::json manifest;
+            file >> manifest;
+            if (manifest.value("version", 0) != kEntryVersion)
+            {
+                // Older layout, its objects go with it below
+                std::filesystem::remove(item.path(), ec);
+                continue;
+            }
+
+            Entry entry;
+            entry.path = item.path();
+            entry.lastUsed = manifest.value("lastUsed", int64_t(0));
+            for (const auto& object : manifest["files"])
+            {
+                entry.objects.emplace_back(object[1].get<std::string>(), object[3].get<uint64_t>());
+            }
+            entries.push_back(std::move(entry));
+        }
+        catch (const std::exception&)
+        {
+            std::filesystem::remove(item.path(), ec);
+        }
+    }
+
+    // Most recently used first, keep entries while their unique objects fit in the cap
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed > b.lastUsed; });
+
+    std::unordered_set<std::string> kept;
+    uint64_t keptSize = 0;
+    size_t evicted = 0;
+    for (const auto& entry : entries)
+    {
+        uint64_t added = 0;
+        std::vector<std::string> fresh;
+        for (const auto& [object, size] : entry.objects)
+        {
+            if (kept.count(object) || std::find(fresh.begin(), fresh.end(), object) != fresh.end())
+                continue;
+            fresh.push_back(object);
+            added += size;
+        }
+
+        // The newest entry always stays, even if it alone exceeds the cap
+        if (keptSize + added > m_maxSize && keptSize > 0)
+        {
+            std::filesystem::remove(entry.path, ec);
+            evicted++;
+            continue;
+        }
+        keptSize += added;
+        for (auto& object : fresh)
+        {
+            kept.insert(std::move(object));
+        }
+    }
+
+    // Drop objects no remaining entry references
+    uint64_t freed = 0;
+    for (const auto& bucket : std::filesystem::directory_iterator(m_root / "objects", ec))
+    {
+        for (const auto& object : std::filesystem::directory_iterator(bucket.path(), ec))
+        {
+            auto name = object.path().filename().string();
+            if (kept.count(name))
+                continue;
+            freed += object.file_size(ec);
+            std::filesystem::remove(object.path(), ec);
+        }
+    }
+
+    if (evicted > 0 || freed > 0)
+    {
+        spdlog::info("Artifact cache: evicted {} entries, freed {}, {} in use", evicted, formatBytes(freed),
+                     formatBytes(keptSize));
+    }
+}
+
+} // namespace unreal
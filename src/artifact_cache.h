@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+struct ArtifactCacheResult
+{
+    bool success = false;
+    size_t files = 0;
+    uint64_t bytes = 0;
+    // How files were materialized, reflinks cost no data copy
+    size_t reflinked = 0;
+    size_t copied = 0;
+    // Outputs of the target that the restored build does not have
+    size_t removed = 0;
+    double durationMs = 0.0;
+};
+
+// The build an entry holds, its outputs are the project build products listed in the target receipt
+struct ArtifactTarget
+{
+    std::string target;
+    std::string platform;
+    std::string configuration;
+};
+
+// Binaries/<Platform>/<Target>.target, with the platform and configuration in the name unless Development
+std::filesystem::path getReceiptPath(const std::filesystem::path& projectDir, const ArtifactTarget& target);
+// Project relative paths of the receipt and the build products it lists under the project, empty when the
+// target has no receipt. Engine products are not the project's.
+std::vector<std::string> collectOutputs(const std::filesystem::path& projectDir, const ArtifactTarget& target);
+
+// Local content-addressed store of the project outputs of one build target, keyed by the source fingerprint,
+// target, platform, configuration and engine. Files are named by their SHA-256, deduplicated across entries and
+// verified when restored, and the least recently used entries are evicted beyond the size cap. Restores never share
+// an inode with the store.
+class ArtifactCache
+{
+  public:
+    static ArtifactCache& instance();
+
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    static std::string makeKey(uint64_t fingerprint, const std::string& buildKey);
+
+    ArtifactCacheResult store(const std::filesystem::path& projectDir, const std::string& key,
+                              const ArtifactTarget& target);
+    // Also removes the outputs the target currently has that the cached build does not
+    ArtifactCacheResult restore(const std::filesystem::path& projectDir, const std::string& key,
+                                const ArtifactTarget& target);
+
+  private:
+    ArtifactCache();
+
+    void evict();
+    std::filesystem::path getObjectPath(const std::string& object) const;
+    std::filesystem::path getEntryPath(const std::string& key) const;
+
+    std::filesystem::path m_root;
+    uint64_t m_maxSize = 0;
+    bool m_enabled = false;
+    std::mutex m_mutex;
+};
+
+} // namespace unreal
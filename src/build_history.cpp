@@ -0,0 +1,359 @@
+#include "build_history.h"
+#include "history_store.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <regex>
+
+namespace unreal
+{
+
+namespace
+{
+// Actions shorter than this are noise for regression purposes
+constexpr double kMinRegressionSeconds = 5.0;
+constexpr size_t kBaselineBuilds = 5;
+
+std::string formatSeconds(double seconds)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), seconds >= 10.0 ? "%.0fs" : "%.1fs", seconds);
+    return buffer;
+}
+
+// "Module.Foo.cpp", "Module.Foo.2_of_4.cpp" -> "Foo"; "libUnrealEditor-Foo.so", "UnrealEditor-Foo.dll" -> "Foo"
+std::string moduleFor(const std::string& name)
+{
+    if (name.rfind("Module.", 0) == 0)
+    {
+        auto end = name.find('.', 7);
+        return name.substr(7, end == std::string::npos ? std::string::npos : end - 7);
+    }
+
+    auto editor = name.find("UnrealEditor-");
+    if (editor != std::string::npos)
+    {
+        auto start = editor + 13;
+        auto end = name.find_first_of("-.", start);
+        return name.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+    return "";
+}
+
+} // namespace
+
+std::string BuildRegression::describe() const
+{
+    auto time = static_cast<std::time_t>(since);
+    char date[32];
+    strftime(date, sizeof(date), "%a %d %b", localtime(&time));
+    return subject + " time went from " + formatSeconds(before) + " to " + formatSeconds(after) + " since " + date;
+}
+
+BuildTimingParser::BuildTimingParser(unsigned parallelism)
+{
+    m_start = m_actionsStart = Clock::now();
+    m_record.parallelism = parallelism;
+}
+
+void BuildTimingParser::feed(const std::string& line)
+{
+    // "[12/40] Compile [x64] Module.Foo.cpp", "[40/40] Link (lld) libUnrealEditor-Foo.so"
+    static const std::regex progressPattern(
+        R"(^\s*\[(\d+)/(\d+)\]\s+(\S+)\s+(?:\[[^\]]*\]\s+)?(?:\([^)]*\)\s+)?(.*?)\s*$)");
+    static const std::regex actionsPattern(R"(Building (\d+) actions? with (\d+) (?:parallel )?process)");
+    static const std::regex uhtPattern(R"(Reflection code generated for .* in ([0-9.]+) seconds)");
+
+    auto now = Clock::now();
+    std::smatch match;
+
+    if (line.find("[") != std::string::npos && std::regex_match(line, match, progressPattern))
+    {
+        if (m_uhtRunning)
+        {
+            m_record.uhtStart = std::chrono::duration<double>(m_uhtStart - m_start).count();
+            m_record.uhtSeconds = std::chrono::duration<double>(now - m_uhtStart).count();
+            m_uhtRunning = false;
+        }
+
+        // The action started when a process slot freed up, i.e. when the action P completions ago finished,
+        // which also means it ran on that action's slot
+        size_t slots = std::max(1u, m_record.parallelism);
+        size_t index = m_completions.size();
+        auto started = index >= slots ? m_completions[index - slots] : m_actionsStart;
+        m_completions.push_back(now);
+
+        ActionTiming action;
+        action.kind = match[3].str();
+        action.name = match[4].str();
+        action.module = moduleFor(action.name);
+        action.slot = static_cast<unsigned>(index % slots);
+        if (!action.module.empty())
+        {
+            auto previous = m_moduleCompletions.find(action.module);
+            if (action.kind == "Link" && previous != m_moduleCompletions.end())
+                started = std::max(started, previous->second);
+            m_moduleCompletions[action.module] = now;
+        }
+        action.start = std::chrono::duration<float>(started - m_start).count();
+        action.seconds = std::chrono::duration<float>(now - started).count();
+        if (action.kind == "Link")
+            m_record.linkSeconds += action.seconds;
+        m_record.actions.push_back(std::move(action));
+        return;
+    }
+
+    if (line.find("Parsing headers for") != std::string::npos ||
+        line.find("Running UnrealHeaderTool") != std::string::npos)
+    {
+        if (!m_uhtRunning)
+        {
+            m_uhtRunning = true;
+            m_uhtStart = now;
+        }
+        return;
+    }
+
+    if (std::regex_search(line, match, uhtPattern))
+    {
+        m_record.uhtSeconds = std::stod(match[1].str());
+        m_record.uhtStart = std::max(0.0, std::chrono::duration<double>(now - m_start).count() - m_record.uhtSeconds);
+        m_uhtRunning = false;
+        return;
+    }
+
+    if (std::regex_search(line, match, actionsPattern))
+    {
+        // An explicit -MaxParallelActions already decided the slot count
+        if (m_record.parallelism == 0)
+            m_record.parallelism = static_cast<unsigned>(std::stoul(match[2].str()));
+        m_actionsStart = now;
+    }
+}
+
+BuildRecord BuildTimingParser::finish(bool success)
+{
+    m_record.success = success;
+    m_record.totalSeconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+    m_record.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+    return m_record;
+}
+
+BuildTimeline analyzeTimeline(const BuildRecord& record)
+{
+    BuildTimeline timeline;
+    const auto& actions = record.actions;
+    if (actions.empty() || std::any_of(actions.begin(), actions.end(), [](const auto& a) { return a.start < 0.0f; }))
+        return timeline;
+
+    for (const auto& action : actions)
+    {
+        timeline.slots = std::max(timeline.slots, action.slot + 1);
+    }
+    timeline.rows.resize(timeline.slots);
+    timeline.uhtStart = record.uhtStart;
+    timeline.uhtEnd = record.uhtStart + record.uhtSeconds;
+
+    float firstStart = actions.front().start;
+    for (uint32_t i = 0; i < actions.size(); ++i)
+    {
+        const auto& action = actions[i];
+        float end = action.start + action.seconds;
+        timeline.rows[action.slot].push_back({action.start, end, i, false});
+        timeline.duration = std::max(timeline.duration, static_cast<double>(end));
+        firstStart = std::min(firstStart, action.start);
+    }
+    timeline.duration = std::max(timeline.duration, timeline.uhtEnd);
+    timeline.actionsSeconds = timeline.duration - firstStart;
+    for (auto& row : timeline.rows)
+    {
+        std::sort(row.begin(), row.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+    }
+
+    // Longest chain of estimated durations: UHT -> compile -> link of the same module. Actions are in
+    // completion order, so a module's compiles are always seen before its link.
+    std::vector<double> chain(actions.size());
+    std::vector<int64_t> previous(actions.size(), -1);
+    std::unordered_map<std::string, uint32_t> longestCompile;
+    int64_t tail = -1;
+    for (uint32_t i = 0; i < actions.size(); ++i)
+    {
+        const auto& action = actions[i];
+        chain[i] = record.uhtSeconds + action.seconds;
+        if (action.kind == "Link")
+        {
+            auto compile = longestCompile.find(action.module);
+            if (compile != longestCompile.end())
+            {
+                chain[i] = chain[compile->second] + action.seconds;
+                previous[i] = compile->second;
+            }
+        }
+        else if (!action.module.empty())
+        {
+            auto [it, inserted] = longestCompile.emplace(action.module, i);
+            if (!inserted && chain[i] > chain[it->second])
+                it->second = i;
+        }
+        if (tail < 0 || chain[i] > chain[tail])
+            tail = i;
+    }
+    timeline.criticalSeconds = chain[tail];
+    for (int64_t i = tail; i >= 0; i = previous[i])
+    {
+        timeline.criticalPath.insert(timeline.criticalPath.begin(), static_cast<uint32_t>(i));
+    }
+    for (auto& row : timeline.rows)
+    {
+        for (auto& bar : row)
+        {
+            bar.critical = std::find(timeline.criticalPath.begin(), timeline.criticalPath.end(), bar.action) !=
+                           timeline.criticalPath.end();
+        }
+    }
+
+    return timeline;
+}
+
+BuildHistory& BuildHistory::instance()
+{
+    static BuildHistory instance;
+    return instance;
+}
+
+void BuildHistory::append(const BuildRecord& record)
+{
+    TRACE_SCOPE("Append build history", "io", record.project);
+
+    nlohmann::json json;
+    json["time"] = record.timestamp;
+    json["target"] = record.target;
+    json["platform"] = record.platform;
+    json["config"] = record.configuration;
+    json["success"] = record.success;
+    json["total"] = record.totalSeconds;
+    json["uhtStart"] = record.uhtStart;
+    json["uht"] = record.uhtSeconds;
+    json["link"] = record.linkSeconds;
+    json["parallelism"] = record.parallelism;
+    auto& actions = json["actions"] = nlohmann::json::array();
+    for (const auto& action : record.actions)
+    {
+        actions.push_back({action.kind, action.name, action.module, std::round(action.seconds * 100.0f) / 100.0f,
+                           std::round(action.start * 100.0f) / 100.0f, action.slot});
+    }
+
+    m_store.append(record.project, json.dump());
+}
+
+std::vector<BuildRecord> BuildHistory::load(const std::string& project) const
+{
+    TRACE_SCOPE("Load build history", "io", project);
+    std::vector<BuildRecord> records;
+    m_store.load(project,
+                 [&](const std::string& line)
+                 {
+                     auto json = nlohmann::json::parse(line);
+                     BuildRecord record;
+                     record.project = project;
+                     record.timestamp = json.value("time", int64_t(0));
+                     record.target = json.value("target", "");
+                     record.platform = json.value("platform", "");
+                     record.configuration = json.value("config", "");
+                     record.success = json.value("success", false);
+                     record.totalSeconds = json.value("total", 0.0);
+                     record.uhtStart = json.value("uhtStart", 0.0);
+                     record.uhtSeconds = json.value("uht", 0.0);
+                     record.linkSeconds = json.value("link", 0.0);
+                     record.parallelism = json.value("parallelism", 0u);
+                     for (const auto& item : json["actions"])
+                     {
+                         ActionTiming action;
+                         action.kind = item[0].get<std::string>();
+                         action.name = item[1].get<std::string>();
+                         action.module = item[2].get<std::string>();
+                         action.seconds = item[3].get<float>();
+                         if (item.size() > 5)
+                         {
+                             action.start = item[4].get<float>();
+                             action.slot = item[5].get<unsigned>();
+                         }
+                         record.actions.push_back(std::move(action));
+                     }
+                     records.push_back(std::move(record));
+                 });
+    return records;
+}
+
+std::vector<BuildRegression> BuildHistory::findRegressions(const std::vector<BuildRecord>& records)
+{
+    std::vector<BuildRegression> regressions;
+
+    // Latest successful build per target/platform/configuration
+    std::map<std::string, size_t> latest;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (records[i].success)
+            latest[records[i].target + "|" + records[i].platform + "|" + records[i].configuration] = i;
+    }
+
+    for (const auto& [key, index] : latest)
+    {
+        const auto& current = records[index];
+        for (const auto& action : current.actions)
+        {
+            if (action.seconds < kMinRegressionSeconds)
+                continue;
+
+            // Same action in the previous successful builds of this target
+            std::vector<double> previous;
+            int64_t since = 0;
+            for (size_t i = index; i-- > 0 && previous.size() < kBaselineBuilds;)
+            {
+                const auto& older = records[i];
+                if (!older.success || older.target != current.target || older.platform != current.platform ||
+                    older.configuration != current.configuration)
+                    continue;
+
+                for (const auto& candidate : older.actions)
+                {
+                    if (candidate.kind == action.kind && candidate.name == action.name)
+                    {
+                        previous.push_back(candidate.seconds);
+                        if (since == 0)
+                            since = older.timestamp;
+                        break;
+                    }
+                }
+            }
+            if (previous.empty())
+                continue;
+
+            double baseline = median(previous);
+            if (action.seconds >= 2.0 * baseline && action.seconds - baseline >= kMinRegressionSeconds)
+            {
+                BuildRegression regression;
+                std::string kind = action.kind;
+                std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+                regression.subject = action.name + " " + kind;
+                regression.before = baseline;
+                regression.after = action.seconds;
+                regression.since = since;
+                regressions.push_back(regression);
+            }
+        }
+    }
+
+    std::sort(regressions.begin(), regressions.end(), [](const BuildRegression& a, const BuildRegression& b)
+              { return a.after - a.before > b.after - b.before; });
+    return regressions;
+}
+
+} // namespace unreal
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "history_store.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unreal
+{
+
+struct ActionTiming
+{
+    // "Compile", "Link", ...
+    std::string kind;
+    std::string name;
+    std::string module;
+    float seconds = 0.0f;
+    // Estimated start, in seconds from the start of the build, and the UBT process slot that ran it.
+    // Negative for records written before timelines were kept.
+    float start = -1.0f;
+    unsigned slot = 0;
+};
+
+struct BuildRecord
+{
+    int64_t timestamp = 0;
+    std::string project;
+    std::string target;
+    std::string platform;
+    std::string configuration;
+    bool success = false;
+    double totalSeconds = 0.0;
+    double uhtStart = 0.0;
+    double uhtSeconds = 0.0;
+    double linkSeconds = 0.0;
+    unsigned parallelism = 0;
+    std::vector<ActionTiming> actions;
+};
+
+struct BuildRegression
+{
+    std::string subject;
+    double before = 0.0;
+    double after = 0.0;
+    // Time of the last build that was still at the old level
+    int64_t since = 0;
+
+    std::string describe() const;
+};
+
+// Derives timings from UBT's console output as it streams in. UBT prints "[n/m] Compile Foo.cpp" when an
+// action completes; with P parallel processes an action is assumed to have started when the action n-P
+// finished, which estimates per-action durations without extra tool invocations.
+class BuildTimingParser
+{
+  public:
+    explicit BuildTimingParser(unsigned parallelism = 0);
+
+    void feed(const std::string& line);
+    BuildRecord finish(bool success);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point m_start;
+    Clock::time_point m_actionsStart;
+    Clock::time_point m_uhtStart;
+    std::vector<Clock::time_point> m_completions;
+    // Last completion per module, a link cannot start before the module's objects exist
+    std::unordered_map<std::string, Clock::time_point> m_moduleCompletions;
+    BuildRecord m_record;
+    bool m_uhtRunning = false;
+};
+
+// Action stream of one build laid out per process slot, with the critical path through the dependencies
+// that can be inferred from the log: compiles wait for UHT, and a module links after its last compile.
+// UBT only reports completions, so the layout follows the slot estimate of BuildTimingParser and keeps every
+// slot busy by construction; it shows the order and estimated length of actions, not measured concurrency.
+struct BuildTimeline
+{
+    struct Bar
+    {
+        float start = 0.0f;
+        float end = 0.0f;
+        uint32_t action = 0;
+        bool critical = false;
+    };
+
+    unsigned slots = 0;
+    double duration = 0.0;
+    double uhtStart = 0.0;
+    double uhtEnd = 0.0;
+    // Per slot, sorted by start so views can binary search the visible range
+    std::vector<std::vector<Bar>> rows;
+    std::vector<uint32_t> criticalPath;
+    double criticalSeconds = 0.0;
+    // Wall time between the first action start and the last end
+    double actionsSeconds = 0.0;
+
+    bool isValid() const
+    {
+        return slots > 0;
+    }
+};
+
+BuildTimeline analyzeTimeline(const BuildRecord& record);
+
+// Append-only JSON lines store of build records, one file per project.
+class BuildHistory
+{
+  public:
+    static BuildHistory& instance();
+
+    void append(const BuildRecord& record);
+    std::vector<BuildRecord> load(const std::string& project) const;
+
+    // Incremented on every append, lets views reload only when something changed
+    uint64_t getRevision() const
+    {
+        return m_store.getRevision();
+    }
+
+    // Compares the newest successful build of each target against the ones before it
+    static std::vector<BuildRegression> findRegressions(const std::vector<BuildRecord>& records);
+
+  private:
+    BuildHistory() = default;
+
+    JsonLinesStore m_store{""};
+};
+
+} // namespace unreal
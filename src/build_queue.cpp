@@ -0,0 +1,512 @@
+#include "build_queue.h"
+#include "trace.h"
+#include <algorithm>
+#include <set>
+
+namespace unreal
+{
+
+namespace
+{
+// Memory reserved for a job is only trusted to show up in MemAvailable once it has been running a while
+constexpr auto kMemoryRampUp = std::chrono::seconds(60);
+
+// UBT allows one instance per project and engine, a second one would only wait on its mutex holding cores
+bool runsBuildTool(JobKind kind)
+{
+    return kind == JobKind::Generate || kind == JobKind::Build || kind == JobKind::Package ||
+           kind == JobKind::Compile;
+}
+
+std::string getBuildToolKey(const BuildJob& job)
+{
+    return job.enginePath.generic_string() + "|" + job.uprojectPath.generic_string();
+}
+} // namespace
+
+BuildQueue::BuildQueue(LogCallback callback) : m_logCallback(callback)
+{
+    m_capacity = readMachineCapacity();
+    m_pressure = std::make_unique<PressureMonitor>([this]() { return getThrottleTargets(); }, callback);
+    m_thread = std::thread([this]() { schedulerLoop(); });
+}
+
+BuildQueue::~BuildQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        for (auto& running : m_running)
+        {
+            running.operations->cancel();
+        }
+    }
+    m_condition.notify_all();
+
+    // Paused jobs only act on their cancellation once resumed, the scheduler waits for them to unwind
+    m_pressure->stop();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    // The scheduler and the views dereference the monitor until here
+    m_pressure.reset();
+}
+
+std::string BuildQueue::jobKindToString(JobKind kind)
+{
+    switch (kind)
+    {
+        case JobKind::Generate:
+            return "Generate";
+        case JobKind::Build:
+            return "Build";
+        case JobKind::Package:
+            return "Package";
+        case JobKind::Compile:
+            return "Compile";
+        case JobKind::Cook:
+            return "Cook";
+        case JobKind::Stage:
+            return "Stage";
+    }
+    return "Unknown";
+}
+
+std::string BuildQueue::jobStateToString(JobState state)
+{
+    switch (state)
+    {
+        case JobState::Queued:
+            return "Queued";
+        case JobState::Running:
+            return "Running";
+        case JobState::Succeeded:
+            return "Succeeded";
+        case JobState::Failed:
+            return "Failed";
+        case JobState::Cancelled:
+            return "Cancelled";
+    }
+    return "Unknown";
+}
+
+uint64_t BuildQueue::enqueue(BuildJob job)
+{
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!job.replaceKey.empty())
+        {
+            for (auto& other : m_jobs)
+            {
+                if (other.replaceKey == job.replaceKey)
+                    cancelJob(other);
+            }
+        }
+        job.id = id = m_nextId++;
+        job.state = JobState::Queued;
+        job.queuedAt = std::chrono::steady_clock::now();
+        m_logCallback("Queued " + jobKindToString(job.kind) + " for " + job.projectName, false);
+        m_jobs.push_back(std::move(job));
+    }
+    m_condition.notify_all();
+    return id;
+}
+
+uint64_t BuildQueue::enqueuePackageMatrix(const BuildJob& base, const std::vector<Platform>& platforms,
+                                          const std::vector<BuildConfiguration>& configs)
+{
+    uint64_t matrixId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        matrixId = m_nextMatrixId++;
+    }
+
+    auto makeJob = [&](JobKind kind, Platform platform, BuildConfiguration config, std::vector<uint64_t> dependsOn)
+    {
+        BuildJob job = base;
+        job.kind = kind;
+        job.platform = platform;
+        job.config = config;
+        job.dependsOn = std::move(dependsOn);
+        job.matrixId = matrixId;
+        return enqueue(std::move(job));
+    };
+
+    // Cooking runs the editor, which has to be built first
+    uint64_t editor = makeJob(JobKind::Build, getCurrentPlatform(), BuildConfiguration::Development, {});
+    for (auto platform : platforms)
+    {
+        uint64_t cook = makeJob(JobKind::Cook, platform, configs.front(), {editor});
+        for (auto config : configs)
+        {
+            uint64_t compile = makeJob(JobKind::Compile, platform, config, {});
+            makeJob(JobKind::Stage, platform, config, {compile, cook});
+        }
+    }
+    return matrixId;
+}
+
+void BuildQueue::cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto* job = findJob(id))
+        cancelJob(*job);
+}
+
+void BuildQueue::cancelJob(BuildJob& job)
+{
+    if (job.state == JobState::Queued)
+    {
+        job.state = JobState::Cancelled;
+        job.finishedAt = std::chrono::steady_clock::now();
+    }
+    else if (job.state == JobState::Running)
+    {
+        for (auto& running : m_running)
+        {
+            if (running.id == job.id)
+            {
+                running.operations->cancel();
+                job.state = JobState::Cancelled;
+            }
+        }
+    }
+}
+
+void BuildQueue::cancelAll()
+{
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& job : m_jobs)
+        {
+            ids.push_back(job.id);
+        }
+    }
+    for (auto id : ids)
+    {
+        cancel(id);
+    }
+}
+
+void BuildQueue::clearFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Finished jobs that queued jobs still wait on are kept, their outcome decides whether those run
+    std::vector<uint64_t> awaited;
+    for (const auto& job : m_jobs)
+    {
+        if (job.state == JobState::Queued)
+            awaited.insert(awaited.end(), job.dependsOn.begin(), job.dependsOn.end());
+    }
+
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                [&](const BuildJob& job)
+                                {
+                                    bool running = std::any_of(m_running.begin(), m_running.end(),
+                                                               [&](const RunningJob& r) { return r.id == job.id; });
+                                    bool needed = std::find(awaited.begin(), awaited.end(), job.id) != awaited.end();
+                                    return !running && !needed && job.state != JobState::Queued;
+                                }),
+                 m_jobs.end());
+}
+
+std::vector<BuildJob> BuildQueue::getJobs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto jobs = m_jobs;
+    for (auto& job : jobs)
+    {
+        if (job.state == JobState::Running)
+            job.throttleReason = m_pressure->getThrottleReason(job.id);
+    }
+    return jobs;
+}
+
+std::optional<JobState> BuildQueue::getJobState(uint64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& job : m_jobs)
+    {
+        if (job.id == id)
+            return job.state;
+    }
+    return std::nullopt;
+}
+
+std::vector<PressureMonitor::Target> BuildQueue::getThrottleTargets() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<PressureMonitor::Target> targets;
+    for (const auto& running : m_running)
+    {
+        for (const auto& job : m_jobs)
+        {
+            if (job.id != running.id || job.state != JobState::Running)
+                continue;
+
+            PressureMonitor::Target target;
+            target.id = job.id;
+            target.processGroup = running.operations->getProcessGroup();
+            auto launch = running.operations->getLaunchPolicy();
+            if (!launch.cgroupProcs.empty())
+                target.cgroup = std::filesystem::path(launch.cgroupProcs).parent_path();
+            target.nice = launch.nice;
+            target.priority = job.priority;
+            target.name = job.projectName;
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+MachineCapacity BuildQueue::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+BuildQueueSettings BuildQueue::getSettings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_settings;
+}
+
+void BuildQueue::setSettings(const BuildQueueSettings& settings)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_settings = settings;
+    }
+    m_condition.notify_all();
+}
+
+BuildJob* BuildQueue::findJob(uint64_t id)
+{
+    for (auto& job : m_jobs)
+    {
+        if (job.id == id)
+            return &job;
+    }
+    return nullptr;
+}
+
+uint64_t BuildQueue::estimateMemory(const BuildJob& job, unsigned cores) const
+{
+    switch (job.kind)
+    {
+        case JobKind::Generate:
+            return 1ull << 30;
+        case JobKind::Build:
+            return cores * m_settings.memoryPerAction;
+        case JobKind::Package:
+            // Compile and cook phases run one after the other, the larger one is what matters
+            return std::max<uint64_t>(cores * m_settings.memoryPerAction, m_settings.memoryForCook);
+        case JobKind::Compile:
+            return cores * m_settings.memoryPerAction;
+        case JobKind::Cook:
+            return m_settings.memoryForCook;
+        case JobKind::Stage:
+            // Mostly file copies and compression
+            return 2ull << 30;
+    }
+    return 0;
+}
+
+bool BuildQueue::resolveDependencies(BuildJob& job)
+{
+    for (auto id : job.dependsOn)
+    {
+        const auto* dependency = findJob(id);
+        if (!dependency || dependency->state == JobState::Succeeded)
+            continue;
+        if (dependency->state == JobState::Queued || dependency->state == JobState::Running)
+            return false;
+
+        job.state = JobState::Cancelled;
+        job.finishedAt = std::chrono::steady_clock::now();
+        m_logCallback("[" + job.projectName + "] " + jobKindToString(job.kind) + " skipped, " +
+                          jobKindToString(dependency->kind) + " " + jobStateToString(dependency->state),
+                      true);
+        return false;
+    }
+    return true;
+}
+
+void BuildQueue::schedulerLoop()
+{
+    Trace::setThreadName("Build queue");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_quit)
+    {
+        // Memory availability changes on its own, re-evaluate periodically
+        m_condition.wait_for(lock, std::chrono::seconds(1));
+        if (m_quit)
+            break;
+
+        reapFinished();
+        admitQueued();
+    }
+
+    // Let running jobs unwind after their cancellation, without holding the lock
+    auto running = std::move(m_running);
+    lock.unlock();
+    for (auto& job : running)
+    {
+        job.result.wait();
+    }
+}
+
+void BuildQueue::reapFinished()
+{
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_running.begin(); it != m_running.end();)
+    {
+        if (it->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        bool success = it->result.get();
+        if (auto* job = findJob(it->id))
+        {
+            if (job->state != JobState::Cancelled)
+            {
+                job->state = success ? JobState::Succeeded : JobState::Failed;
+            }
+            job->finishedAt = now;
+
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now - job->startedAt).count();
+            m_logCallback("[" + job->projectName + "] " + jobKindToString(job->kind) + " " +
+                              jobStateToString(job->state) + " after " + std::to_string(seconds) + "s",
+                          job->state != JobState::Succeeded);
+        }
+        it = m_running.erase(it);
+    }
+}
+
+void BuildQueue::admitQueued()
+{
+    m_capacity = readMachineCapacity();
+    auto now = std::chrono::steady_clock::now();
+
+    // Starting more work while jobs are paused for memory would only make the pressure worse
+    if (!m_running.empty() && m_pressure->isThrottling())
+        return;
+
+    unsigned usedCores = 0;
+    uint64_t rampingMemory = 0;
+    // Cancelled jobs keep their key until their process exited and they were reaped
+    std::set<std::string> busyBuildTools;
+    for (const auto& running : m_running)
+    {
+        if (auto* job = findJob(running.id))
+        {
+            if (runsBuildTool(job->kind))
+                busyBuildTools.insert(getBuildToolKey(*job));
+            usedCores += job->cores;
+            if (now - job->startedAt < kMemoryRampUp)
+                rampingMemory += job->memoryReserved;
+        }
+    }
+
+    bool memoryKnown = m_capacity.memoryAvailable > 0;
+    uint64_t freeMemory = 0;
+    if (memoryKnown)
+    {
+        uint64_t unavailable = m_settings.memoryReserve + rampingMemory;
+        freeMemory = m_capacity.memoryAvailable > unavailable ? m_capacity.memoryAvailable - unavailable : 0;
+    }
+
+    std::vector<BuildJob*> queued;
+    for (auto& job : m_jobs)
+    {
+        if (job.state == JobState::Queued && resolveDependencies(job))
+            queued.push_back(&job);
+    }
+    std::stable_sort(queued.begin(), queued.end(),
+                     [](const BuildJob* a, const BuildJob* b) { return a->priority > b->priority; });
+
+    unsigned share = std::max(m_settings.minCoresPerJob,
+                              m_capacity.cores / std::max(1u, m_settings.targetConcurrentJobs));
+
+    for (auto* job : queued)
+    {
+        if (runsBuildTool(job->kind) && busyBuildTools.count(getBuildToolKey(*job)))
+            continue;
+
+        unsigned freeCores = m_capacity.cores > usedCores ? m_capacity.cores - usedCores : 0;
+        // Generating project files and staging barely use more than one core
+        bool light = job->kind == JobKind::Generate || job->kind == JobKind::Stage;
+        unsigned cores = light ? 1 : std::min(share, freeCores);
+        unsigned minCores = light ? 1 : m_settings.minCoresPerJob;
+
+        bool fitsMemory = true;
+        if (memoryKnown && job->kind != JobKind::Generate)
+        {
+            // Trade parallelism for memory before refusing the job
+            while (cores > 0 && estimateMemory(*job, cores) > freeMemory)
+                --cores;
+            fitsMemory = cores > 0;
+        }
+
+        // The first job always runs so an undersized machine still makes progress
+        if (!m_running.empty() && (cores < minCores || !fitsMemory || freeCores == 0))
+            break;
+        cores = std::max(cores, 1u);
+
+        if (runsBuildTool(job->kind))
+            busyBuildTools.insert(getBuildToolKey(*job));
+        job->state = JobState::Running;
+        job->cores = cores;
+        job->memoryReserved = estimateMemory(*job, cores);
+        job->startedAt = now;
+        usedCores += cores;
+        freeMemory = freeMemory > job->memoryReserved ? freeMemory - job->memoryReserved : 0;
+
+        auto prefix = "[" + job->projectName + "] ";
+        auto log = m_logCallback;
+        RunningJob running;
+        running.id = job->id;
+        running.operations = std::make_unique<ProjectOperations>(
+            [log, prefix](const std::string& msg, bool isError) { log(prefix + msg, isError); });
+
+        log(prefix + "Starting " + jobKindToString(job->kind) + " with " + std::to_string(cores) + " cores, " +
+                formatBytes(job->memoryReserved) + " reserved",
+            false);
+
+        switch (job->kind)
+        {
+            case JobKind::Generate:
+                running.result = running.operations->generateProjectFiles(job->enginePath, job->uprojectPath);
+                break;
+            case JobKind::Build:
+                running.result =
+                    running.operations->build(job->enginePath, job->uprojectPath, job->config, cores);
+                break;
+            case JobKind::Package:
+                running.result = running.operations->package(job->enginePath, job->uprojectPath, job->platform,
+                                                             job->outputPath, cores, job->packageOptions);
+                break;
+            case JobKind::Compile:
+            case JobKind::Cook:
+            case JobKind::Stage:
+            {
+                auto step = job->kind == JobKind::Compile ? PackageStep::Compile
+                            : job->kind == JobKind::Cook  ? PackageStep::Cook
+                                                          : PackageStep::Stage;
+                running.result = running.operations->packageStep(job->enginePath, job->uprojectPath, step,
+                                                                 job->platform, job->config, job->outputPath, cores);
+                break;
+            }
+        }
+        m_running.push_back(std::move(running));
+    }
+}
+
+} // namespace unreal
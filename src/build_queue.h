@@ -0,0 +1,156 @@
+#pragma once
+
+#include "pressure.h"
+#include "system.h"
+#include "utils.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+
+enum class JobKind
+{
+    Generate,
+    Build,
+    Package,
+    // Package matrix steps, see PackageStep
+    Compile,
+    Cook,
+    Stage
+};
+
+enum class JobState
+{
+    Queued,
+    Running,
+    Succeeded,
+    Failed,
+    Cancelled
+};
+
+struct BuildJob
+{
+    std::string projectName;
+    std::filesystem::path enginePath;
+    std::filesystem::path uprojectPath;
+    JobKind kind = JobKind::Build;
+    BuildConfiguration config = BuildConfiguration::Development;
+    Platform platform = Platform::Linux;
+    std::filesystem::path outputPath;
+    // Package jobs only
+    PackageOptions packageOptions;
+    // Higher runs first, jobs of equal priority run in submission order
+    int priority = 0;
+    // Jobs that must succeed first, the job is cancelled if one of them does not
+    std::vector<uint64_t> dependsOn;
+    // Groups the jobs of one package matrix, 0 otherwise
+    uint64_t matrixId = 0;
+    // A queued or running job with the same key is cancelled when this one is queued, empty for none
+    std::string replaceKey;
+
+    // Filled by the queue
+    uint64_t id = 0;
+    JobState state = JobState::Queued;
+    unsigned cores = 0;
+    uint64_t memoryReserved = 0;
+    std::chrono::steady_clock::time_point queuedAt;
+    std::chrono::steady_clock::time_point startedAt;
+    std::chrono::steady_clock::time_point finishedAt;
+    // Why the pressure monitor paused or deprioritized the job, empty otherwise
+    std::string throttleReason;
+};
+
+struct BuildQueueSettings
+{
+    // Jobs sharing the machine, a second job overlaps the serial phases (UHT, link) of the first
+    unsigned targetConcurrentJobs = 2;
+    unsigned minCoresPerJob = 2;
+    uint64_t memoryPerAction = 2ull << 30;
+    uint64_t memoryForCook = 8ull << 30;
+    // Kept free for the desktop, the editor and the launcher itself
+    uint64_t memoryReserve = 2ull << 30;
+};
+
+// Runs generate/build/package jobs for many projects at once, admitting them according to free cores
+// and available memory, and passes the resulting parallelism limit down to UBT. Jobs that run UBT on the same
+// project and engine are admitted one at a time.
+class BuildQueue
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    explicit BuildQueue(LogCallback callback);
+    ~BuildQueue();
+
+    uint64_t enqueue(BuildJob job);
+    // Queues the jobs of a package matrix: the editor build, one cook per platform, and a compile and a stage
+    // per platform and configuration. Returns the matrix id set on every job.
+    uint64_t enqueuePackageMatrix(const BuildJob& base, const std::vector<Platform>& platforms,
+                                  const std::vector<BuildConfiguration>& configs);
+    void cancel(uint64_t id);
+    void cancelAll();
+    void clearFinished();
+
+    std::vector<BuildJob> getJobs() const;
+    // Empty once the job was cleared
+    std::optional<JobState> getJobState(uint64_t id) const;
+    MachineCapacity getCapacity() const;
+
+    BuildQueueSettings getSettings() const;
+    void setSettings(const BuildQueueSettings& settings);
+
+    PressureMonitor& getPressureMonitor()
+    {
+        return *m_pressure;
+    }
+
+    static std::string jobKindToString(JobKind kind);
+    static std::string jobStateToString(JobState state);
+
+  private:
+    struct RunningJob
+    {
+        uint64_t id = 0;
+        std::unique_ptr<ProjectOperations> operations;
+        std::future<bool> result;
+    };
+
+    void schedulerLoop();
+    void reapFinished();
+    void admitQueued();
+    void cancelJob(BuildJob& job);
+    // False while a dependency is pending, cancels the job when one failed
+    bool resolveDependencies(BuildJob& job);
+    uint64_t estimateMemory(const BuildJob& job, unsigned cores) const;
+    BuildJob* findJob(uint64_t id);
+    std::vector<PressureMonitor::Target> getThrottleTargets() const;
+
+    std::vector<BuildJob> m_jobs;
+    std::vector<RunningJob> m_running;
+    BuildQueueSettings m_settings;
+    MachineCapacity m_capacity;
+    LogCallback m_logCallback;
+    uint64_t m_nextId = 1;
+    uint64_t m_nextMatrixId = 1;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_quit = false;
+
+    // Stopped once the jobs are cancelled and freed after the scheduler thread joined, see ~BuildQueue
+    std::unique_ptr<PressureMonitor> m_pressure;
+};
+
+} // namespace unreal
@@ -0,0 +1,276 @@
+#include "cgroup.h"
+#include "config.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+const char* kCgroupMount = "/sys/fs/cgroup";
+const char* kLauncherLeaf = "imunreal-launcher";
+const char* kJobsGroup = "imunreal-jobs";
+const char* kControllers[] = {"cpu", "io", "memory"};
+
+std::string readControl(const std::filesystem::path& file)
+{
+    std::ifstream in(file);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+bool writeControl(const std::filesystem::path& file, const std::string& value)
+{
+    // Control files reject partial writes, the value must go out in a single write
+    std::ofstream out(file);
+    if (!out.is_open())
+        return false;
+    out << value;
+    out.flush();
+    return out.good();
+}
+
+bool hasWord(const std::string& text, const std::string& word)
+{
+    std::istringstream stream(text);
+    std::string item;
+    while (stream >> item)
+    {
+        if (item == word)
+            return true;
+    }
+    return false;
+}
+
+std::string sanitizeLabel(const std::string& label)
+{
+    std::string result;
+    for (char c : label)
+    {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-')
+            result += c;
+        if (result.size() >= 32)
+            break;
+    }
+    return result;
+}
+} // namespace
+
+ResourceGroups& ResourceGroups::instance()
+{
+    static ResourceGroups instance;
+    return instance;
+}
+
+std::string ResourceGroups::jobClassToString(JobClass jobClass)
+{
+    switch (jobClass)
+    {
+        case JobClass::Build:
+            return "build";
+        case JobClass::Package:
+            return "package";
+        case JobClass::Clean:
+            return "clean";
+        case JobClass::Editor:
+            return "editor";
+    }
+    return "unknown";
+}
+
+void ResourceGroups::init()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_initialized)
+        return;
+    m_initialized = true;
+
+    TRACE_SCOPE("Setup resource groups", "startup");
+
+#ifdef __linux__
+    m_delegated = setupHierarchy();
+    if (m_delegated)
+    {
+        removeStaleLeaves();
+        spdlog::info("Jobs run in cgroup v2 leaves under {}", m_jobsRoot.string());
+    }
+    else
+    {
+        spdlog::info("cgroup v2 is not delegated to the launcher, jobs use nice/ionice instead");
+    }
+#endif
+}
+
+ResourcePolicy ResourceGroups::getPolicy(JobClass jobClass) const
+{
+    return Config::instance().getJobClassPolicy(jobClass);
+}
+
+bool ResourceGroups::setupHierarchy()
+{
+#ifdef __linux__
+    // Unified hierarchy entry: "0::/user.slice/.../app.scope"
+    std::ifstream self("/proc/self/cgroup");
+    std::string line;
+    std::filesystem::path own;
+    while (std::getline(self, line))
+    {
+        if (line.rfind("0::", 0) == 0)
+            own = std::filesystem::path(kCgroupMount) / std::filesystem::path(line.substr(3)).relative_path();
+    }
+    if (own.empty() || !std::filesystem::exists(own / "cgroup.controllers"))
+        return false;
+
+    // Restarting inside a scope we already reorganized
+    auto base = own.filename() == kLauncherLeaf ? own.parent_path() : own;
+    if (access(base.c_str(), W_OK) != 0 || access((base / "cgroup.subtree_control").c_str(), W_OK) != 0)
+        return false;
+
+    std::error_code ec;
+    auto launcher = base / kLauncherLeaf;
+    if (own != launcher)
+    {
+        // Controllers can only be enabled below a cgroup without processes, so move ourselves into a leaf.
+        // Only do it when we are alone, a shared cgroup (launched from a terminal) is not ours to reshape.
+        std::istringstream procs(readControl(base / "cgroup.procs"));
+        std::string pid;
+        while (procs >> pid)
+        {
+            if (pid != std::to_string(getpid()))
+                return false;
+        }
+
+        std::filesystem::create_directory(launcher, ec);
+        if (ec || !writeControl(launcher / "cgroup.procs", std::to_string(getpid())))
+            return false;
+    }
+
+    auto jobs = base / kJobsGroup;
+    std::filesystem::create_directory(jobs, ec);
+    if (ec)
+        return false;
+
+    // Enable the controllers at both levels down to the job leaves
+    for (const auto& parent : {base, jobs})
+    {
+        auto available = readControl(parent / "cgroup.controllers");
+        for (const char* controller : kControllers)
+        {
+            if (hasWord(available, controller))
+                writeControl(parent / "cgroup.subtree_control", std::string("+") + controller);
+        }
+    }
+
+    m_jobsRoot = jobs;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ResourceGroups::removeStaleLeaves()
+{
+    // Leaves whose processes outlived the previous session, rmdir only succeeds once they are empty
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_jobsRoot, ec))
+    {
+        if (entry.is_directory(ec))
+            std::filesystem::remove(entry.path(), ec);
+    }
+}
+
+ResourcePlacement ResourceGroups::place(JobClass jobClass, const std::string& label)
+{
+    init();
+    auto policy = getPolicy(jobClass);
+
+    ResourcePlacement placement;
+    if (m_delegated)
+    {
+        auto name = jobClassToString(jobClass) + "-" + sanitizeLabel(label) + "-" + std::to_string(m_counter++);
+        auto leaf = m_jobsRoot / name;
+
+        std::error_code ec;
+        if (std::filesystem::create_directory(leaf, ec) && !ec)
+        {
+            // Controllers missing from the kernel or the delegation simply keep their defaults
+            writeControl(leaf / "cpu.weight", std::to_string(policy.cpuWeight));
+            writeControl(leaf / "io.weight", "default " + std::to_string(policy.ioWeight));
+            if (policy.memoryMax > 0)
+                writeControl(leaf / "memory.max", std::to_string(policy.memoryMax));
+
+            placement.cgroup = leaf;
+            placement.launch.cgroupProcs = (leaf / "cgroup.procs").string();
+            return placement;
+        }
+        spdlog::warn("Failed to create cgroup {}: {}", leaf.string(), ec.message());
+    }
+
+    placement.launch.nice = policy.nice;
+    placement.launch.idleIo = policy.idleIo;
+    return placement;
+}
+
+uint64_t ResourceGroups::release(const ResourcePlacement& placement)
+{
+    if (placement.cgroup.empty())
+        return 0;
+
+    uint64_t oomKills = 0;
+    std::istringstream events(readControl(placement.cgroup / "memory.events"));
+    std::string key;
+    uint64_t value = 0;
+    while (events >> key >> value)
+    {
+        if (key == "oom_kill")
+            oomKills = value;
+    }
+
+    // Fails while daemons spawned by the job (build servers, shader workers) are still alive
+    std::error_code ec;
+    std::filesystem::remove(placement.cgroup, ec);
+    return oomKills;
+}
+
+unsigned ResourceGroups::getCpuWeight(const std::filesystem::path& cgroup)
+{
+    unsigned weight = 0;
+    std::istringstream(readControl(cgroup / "cpu.weight")) >> weight;
+    return weight;
+}
+
+bool ResourceGroups::setCpuWeight(const std::filesystem::path& cgroup, unsigned weight)
+{
+    return writeControl(cgroup / "cpu.weight", std::to_string(weight));
+}
+
+void ResourceGroups::applyToCurrentThread(JobClass jobClass) const
+{
+#ifdef __linux__
+    auto policy = getPolicy(jobClass);
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    if (policy.nice > 0)
+        setpriority(PRIO_PROCESS, tid, policy.nice);
+    if (policy.idleIo)
+    {
+        constexpr int ioprioWhoProcess = 1;
+        constexpr int ioprioClassIdle = 3;
+        constexpr int ioprioClassShift = 13;
+        syscall(SYS_ioprio_set, ioprioWhoProcess, static_cast<int>(tid), ioprioClassIdle << ioprioClassShift);
+    }
+#endif
+}
+
+} // namespace unreal
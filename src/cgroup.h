@@ -0,0 +1,64 @@
+#pragma once
+
+#include "config.h"
+#include "utils.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace unreal
+{
+
+// A job's cgroup leaf, or only the fallback priorities when cgroups are unavailable
+struct ResourcePlacement
+{
+    std::filesystem::path cgroup;
+    LaunchPolicy launch;
+};
+
+// Places launcher jobs in per-job cgroup v2 leaves weighted by job class, so an editor session keeps
+// priority over background compiles. Falls back to nice/ionice when the launcher's cgroup is not delegated.
+class ResourceGroups
+{
+  public:
+    static ResourceGroups& instance();
+
+    // Moves the launcher into its own leaf and enables controllers for the job leaves
+    void init();
+
+    bool isDelegated() const
+    {
+        return m_delegated;
+    }
+    // The "jobClasses" policy of config.json
+    ResourcePolicy getPolicy(JobClass jobClass) const;
+
+    ResourcePlacement place(JobClass jobClass, const std::string& label);
+    // Removes the leaf once the job exited, returns the number of processes the kernel OOM-killed in it
+    uint64_t release(const ResourcePlacement& placement);
+
+    // cpu.weight of a job leaf, 0 when it cannot be read (the leaf is gone)
+    static unsigned getCpuWeight(const std::filesystem::path& cgroup);
+    static bool setCpuWeight(const std::filesystem::path& cgroup, unsigned weight);
+
+    // Applies the class fallback priority to the calling thread, for jobs that run in-process
+    void applyToCurrentThread(JobClass jobClass) const;
+
+    static std::string jobClassToString(JobClass jobClass);
+
+  private:
+    ResourceGroups() = default;
+
+    bool setupHierarchy();
+    void removeStaleLeaves();
+
+    std::filesystem::path m_jobsRoot;
+    std::atomic<uint64_t> m_counter{0};
+    bool m_delegated = false;
+    bool m_initialized = false;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace unreal
@@ -1,5 +1,10 @@
 #include "config.h"
+#include "cgroup.h"
 #include "utils.h"
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
 
 namespace unreal
 {
@@ -35,4 +40,165 @@ std::filesystem::path Config::getResourcesPath() const
     return m_configDir / "resources";
 }
 
+std::filesystem::path Config::getTrashRegistryPath() const
+{
+    return m_configDir / "trash.json";
+}
+
+std::filesystem::path Config::getTracesDirectory() const
+{
+    return m_configDir / "traces";
+}
+
+std::filesystem::path Config::getArtifactCacheDirectory() const
+{
+    return m_configDir / "artifacts";
+}
+
+std::filesystem::path Config::getHistoryDirectory() const
+{
+    return m_configDir / "history";
+}
+
+std::filesystem::path Config::getEditorLogsDirectory() const
+{
+    return m_configDir / "editor-logs";
+}
+
+ResourcePolicy Config::getJobClassPolicy(JobClass jobClass) const
+{
+    return getSettings().jobClasses[static_cast<size_t>(jobClass)];
+}
+
+ArtifactCacheSettings Config::getArtifactCacheSettings() const
+{
+    return getSettings().artifactCache;
+}
+
+PackageBudget Config::getPackageBudget(const std::string& platform) const
+{
+    const auto& budgets = getSettings().packageBudgets;
+    auto it = budgets.find(platform);
+    if (it == budgets.end())
+        it = budgets.find("*");
+    return it != budgets.end() ? it->second : PackageBudget{};
+}
+
+bool Config::isEditorPrefetchEnabled() const
+{
+    return getSettings().editorPrefetch;
+}
+
+const Config::Settings& Config::getSettings() const
+{
+    std::call_once(m_settingsLoaded, [this]() { loadSettings(); });
+    return m_settings;
+}
+
+void Config::loadSettings() const
+{
+    // The editor is interactive and wins over everything, cleaning only gets idle time
+    auto& policies = m_settings.jobClasses;
+    policies[static_cast<size_t>(JobClass::Build)] = {50, 50, 0, 10, false};
+    policies[static_cast<size_t>(JobClass::Package)] = {50, 50, 0, 10, false};
+    policies[static_cast<size_t>(JobClass::Clean)] = {20, 10, 0, 19, true};
+    policies[static_cast<size_t>(JobClass::Editor)] = {1000, 1000, 0, 0, false};
+
+    auto path = getAppConfigPath();
+    nlohmann::json json = nlohmann::json::object();
+    try
+    {
+        std::ifstream file(path);
+        if (file.is_open())
+        {
+            file >> json;
+        }
+
+        if (json.contains("jobClasses"))
+        {
+            for (size_t i = 0; i < policies.size(); ++i)
+            {
+                auto key = ResourceGroups::jobClassToString(static_cast<JobClass>(i));
+                if (!json["jobClasses"].contains(key))
+                    continue;
+
+                const auto& item = json["jobClasses"][key];
+                auto& policy = policies[i];
+                policy.cpuWeight = std::clamp(item.value("cpuWeight", policy.cpuWeight), 1u, 10000u);
+                policy.ioWeight = std::clamp(item.value("ioWeight", policy.ioWeight), 1u, 10000u);
+                policy.memoryMax = item.value("memoryMaxMB", policy.memoryMax >> 20) << 20;
+                // Raising priority needs privileges, only lowering it is allowed
+                policy.nice = std::clamp(item.value("nice", policy.nice), 0, 19);
+                policy.idleIo = item.value("idleIo", policy.idleIo);
+            }
+        }
+
+        auto& cache = m_settings.artifactCache;
+        if (json.contains("artifactCache"))
+        {
+            const auto& item = json["artifactCache"];
+            cache.enabled = item.value("enabled", cache.enabled);
+            cache.maxSize = item.value("maxSizeMB", cache.maxSize >> 20) << 20;
+        }
+
+        if (json.contains("packageBudgets"))
+        {
+            for (const auto& [platform, item] : json["packageBudgets"].items())
+            {
+                auto& budget = m_settings.packageBudgets[platform];
+                budget.maxTotalBytes = item.value("maxTotalMB", uint64_t(0)) << 20;
+                budget.maxGrowthBytes = item.value("maxGrowthMB", uint64_t(0)) << 20;
+                if (item.contains("maxTypeMB"))
+                {
+                    for (const auto& [type, value] : item["maxTypeMB"].items())
+                    {
+                        budget.maxTypeBytes[type] = value.get<uint64_t>() << 20;
+                    }
+                }
+            }
+        }
+
+        m_settings.editorPrefetch = json.value("editorPrefetch", m_settings.editorPrefetch);
+    }
+    catch (const std::exception& e)
+    {
+        // Keep the file as it is, a hand edit gone wrong should not be overwritten with defaults
+        spdlog::warn("Failed to read {}: {}", path.string(), e.what());
+        return;
+    }
+
+    // Write the defaults of missing sections so they can be discovered and tuned by hand
+    bool changed = false;
+    if (!json.contains("jobClasses"))
+    {
+        auto& classes = json["jobClasses"];
+        for (size_t i = 0; i < policies.size(); ++i)
+        {
+            const auto& policy = policies[i];
+            classes[ResourceGroups::jobClassToString(static_cast<JobClass>(i))] = {
+                {"cpuWeight", policy.cpuWeight},
+                {"ioWeight", policy.ioWeight},
+                {"memoryMaxMB", policy.memoryMax >> 20},
+                {"nice", policy.nice},
+                {"idleIo", policy.idleIo}};
+        }
+        changed = true;
+    }
+    if (!json.contains("artifactCache"))
+    {
+        json["artifactCache"] = {{"enabled", m_settings.artifactCache.enabled},
+                                 {"maxSizeMB", m_settings.artifactCache.maxSize >> 20}};
+        changed = true;
+    }
+    if (!json.contains("editorPrefetch"))
+    {
+        json["editorPrefetch"] = m_settings.editorPrefetch;
+        changed = true;
+    }
+    if (changed && !writeFileAtomic(path, json.dump(4)))
+    {
+        spdlog::warn("Failed to write default settings to {}", path.string());
+    }
+}
+
 } // namespace unreal
@@ -1,9 +1,42 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
 
 namespace unreal
 {
+enum class JobClass;
+
+// Scheduling share of one job class. Weights follow cgroup v2 (1-10000, default 100).
+struct ResourcePolicy
+{
+    unsigned cpuWeight = 100;
+    unsigned ioWeight = 100;
+    // 0 leaves memory unlimited
+    uint64_t memoryMax = 0;
+    // Used instead of the weights when cgroups are not delegated to us
+    int nice = 0;
+    bool idleIo = false;
+};
+
+// Size limits of a package, 0 disables a limit
+struct PackageBudget
+{
+    uint64_t maxTotalBytes = 0;
+    // Growth compared to the previous package of the same platform
+    uint64_t maxGrowthBytes = 0;
+    std::map<std::string, uint64_t> maxTypeBytes;
+};
+
+struct ArtifactCacheSettings
+{
+    bool enabled = true;
+    uint64_t maxSize = 20ull << 30;
+};
 
 class Config
 {
@@ -14,10 +47,38 @@ class Config
     std::filesystem::path getProjectsConfigPath() const;
     std::filesystem::path getAppConfigPath() const;
     std::filesystem::path getResourcesPath() const;
+    std::filesystem::path getTrashRegistryPath() const;
+    std::filesystem::path getTracesDirectory() const;
+    std::filesystem::path getArtifactCacheDirectory() const;
+    // Root of the build, editor startup, profiling, package size and prefetch histories
+    std::filesystem::path getHistoryDirectory() const;
+    std::filesystem::path getEditorLogsDirectory() const;
+
+    // Settings of config.json, read once on first use. Sections the file does not have yet are written with their
+    // defaults so they can be discovered and tuned by hand, edits take effect on the next start.
+    ResourcePolicy getJobClassPolicy(JobClass jobClass) const;
+    ArtifactCacheSettings getArtifactCacheSettings() const;
+    // "packageBudgets" of the platform, "*" as the fallback
+    PackageBudget getPackageBudget(const std::string& platform) const;
+    bool isEditorPrefetchEnabled() const;
 
   private:
+    struct Settings
+    {
+        // Indexed by JobClass
+        std::array<ResourcePolicy, 4> jobClasses;
+        ArtifactCacheSettings artifactCache;
+        std::map<std::string, PackageBudget> packageBudgets;
+        bool editorPrefetch = true;
+    };
+
     Config();
+    const Settings& getSettings() const;
+    void loadSettings() const;
+
     std::filesystem::path m_configDir;
+    mutable Settings m_settings;
+    mutable std::once_flag m_settingsLoaded;
 };
 
 } // namespace unreal
@@ -0,0 +1,404 @@
+#include "deploy.h"
+#include "package_diff.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+const char* kManifestName = ".imunreal-deploy.json";
+const char* kPartSuffix = ".imunreal-part";
+// Paths of the previous and the new package while a deploy runs, so an interrupted one still knows what it owns
+const char* kPendingName = ".imunreal-deploy.pending";
+constexpr size_t kCopyBufferSize = 1 << 20;
+
+int openRead(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    return _wopen(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+int openWrite(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    return _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+}
+
+void closeFile(int fd)
+{
+    if (fd < 0)
+        return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+bool copyBuffered(int in, uint64_t inOffset, int out, uint64_t outOffset, uint64_t length)
+{
+    std::vector<char> buffer(static_cast<size_t>(std::min<uint64_t>(length, kCopyBufferSize)));
+    while (length > 0)
+    {
+        size_t size = static_cast<size_t>(std::min<uint64_t>(length, buffer.size()));
+#ifdef _WIN32
+        if (_lseeki64(in, static_cast<__int64>(inOffset), SEEK_SET) < 0 ||
+            _read(in, buffer.data(), static_cast<unsigned>(size)) != static_cast<int>(size) ||
+            _lseeki64(out, static_cast<__int64>(outOffset), SEEK_SET) < 0 ||
+            _write(out, buffer.data(), static_cast<unsigned>(size)) != static_cast<int>(size))
+            return false;
+#else
+        ssize_t count = pread(in, buffer.data(), size, static_cast<off_t>(inOffset));
+        if (count <= 0 ||
+            pwrite(out, buffer.data(), static_cast<size_t>(count), static_cast<off_t>(outOffset)) != count)
+            return false;
+        size = static_cast<size_t>(count);
+#endif
+        inOffset += size;
+        outOffset += size;
+        length -= size;
+    }
+    return true;
+}
+
+// copy_file_range keeps the data in the kernel, and lets filesystems that support it (NFS 4.2, SMB3, XFS, btrfs)
+// copy or clone on the server side
+bool copyRange(int in, uint64_t inOffset, int out, uint64_t outOffset, uint64_t length)
+{
+#ifdef __linux__
+    while (length > 0)
+    {
+        loff_t from = static_cast<loff_t>(inOffset);
+        loff_t to = static_cast<loff_t>(outOffset);
+        ssize_t count = copy_file_range(in, &from, out, &to, static_cast<size_t>(length), 0);
+        if (count <= 0)
+        {
+            if (count < 0 && errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP)
+                return false;
+            // Not supported between these files, or the source ended early
+            return count == 0 ? false : copyBuffered(in, inOffset, out, outOffset, length);
+        }
+        inOffset += static_cast<uint64_t>(count);
+        outOffset += static_cast<uint64_t>(count);
+        length -= static_cast<uint64_t>(count);
+    }
+    return true;
+#else
+    return copyBuffered(in, inOffset, out, outOffset, length);
+#endif
+}
+
+bool verifyFile(const std::filesystem::path& path, const PackageFile& expected)
+{
+    if (expected.size == 0)
+    {
+        std::error_code ec;
+        return std::filesystem::file_size(path, ec) == 0 && !ec;
+    }
+
+    MappedFile file;
+    if (!file.open(path) || file.size() != expected.size)
+        return false;
+
+    uint64_t offset = 0;
+    for (const auto& chunk : expected.chunks)
+    {
+        if (offset + chunk.size > file.size() || hashBytes(file.data() + offset, chunk.size) != chunk.hash)
+            return false;
+        offset += chunk.size;
+    }
+    return offset == expected.size;
+}
+
+struct DeployCounters
+{
+    std::atomic<uint64_t> transferred{0};
+    std::atomic<uint64_t> reused{0};
+};
+
+// Writes the source version of a file next to its target from the chunks of the previous version (if any) and the
+// source, then verifies and renames it into place
+bool deployFile(const std::filesystem::path& sourcePath, const std::filesystem::path& targetPath,
+                const PackageFile& file, const PackageFile* previous, DeployCounters& counters,
+                const std::atomic<bool>& cancelled)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(targetPath.parent_path(), ec);
+    auto partPath = targetPath;
+    partPath += kPartSuffix;
+
+    int in = openRead(sourcePath);
+    if (in < 0)
+        return false;
+    int old = previous ? openRead(targetPath) : -1;
+    int out = openWrite(partPath);
+    if (out < 0)
+    {
+        closeFile(in);
+        closeFile(old);
+        return false;
+    }
+
+    std::unordered_map<uint64_t, uint64_t> oldOffsets;
+    if (old >= 0)
+    {
+        uint64_t offset = 0;
+        for (const auto& chunk : previous->chunks)
+        {
+            oldOffsets.emplace(chunk.hash, offset);
+            offset += chunk.size;
+        }
+    }
+
+    // Neighbouring chunks read from the same place are merged into one copy
+    bool ok = true;
+    int runFd = -1;
+    uint64_t runFrom = 0;
+    uint64_t runTo = 0;
+    uint64_t runLength = 0;
+    auto flush = [&]()
+    {
+        if (runLength == 0)
+            return;
+        ok = ok && copyRange(runFd, runFrom, out, runTo, runLength);
+        (runFd == in ? counters.transferred : counters.reused) += runLength;
+        runLength = 0;
+    };
+
+    uint64_t offset = 0;
+    for (const auto& chunk : file.chunks)
+    {
+        int fd = in;
+        uint64_t from = offset;
+        auto found = oldOffsets.find(chunk.hash);
+        if (found != oldOffsets.end())
+        {
+            fd = old;
+            from = found->second;
+        }
+
+        if (runLength > 0 && (fd != runFd || from != runFrom + runLength))
+        {
+            flush();
+            if (!ok || cancelled)
+                break;
+        }
+        if (runLength == 0)
+        {
+            runFd = fd;
+            runFrom = from;
+            runTo = offset;
+        }
+        runLength += chunk.size;
+        offset += chunk.size;
+    }
+    flush();
+
+    closeFile(in);
+    closeFile(old);
+    closeFile(out);
+
+    ok = ok && !cancelled && verifyFile(partPath, file);
+    if (ok)
+    {
+        std::filesystem::permissions(partPath, std::filesystem::status(sourcePath, ec).permissions(), ec);
+        std::filesystem::rename(partPath, targetPath, ec);
+        ok = !ec;
+    }
+    if (!ok)
+        std::filesystem::remove(partPath, ec);
+    return ok;
+}
+
+std::set<std::string> loadPending(const std::filesystem::path& path)
+{
+    std::set<std::string> paths;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty())
+            paths.insert(line);
+    }
+    return paths;
+}
+
+bool savePending(const std::filesystem::path& path, const std::set<std::string>& paths)
+{
+    std::ofstream file(path, std::ios::trunc);
+    for (const auto& owned : paths)
+    {
+        file << owned << '\n';
+    }
+    file.flush();
+    return file.good();
+}
+
+} // namespace
+
+DeployResult deployPackage(const std::filesystem::path& source, const std::filesystem::path& destination,
+                           const std::atomic<bool>& cancelled, const std::filesystem::path& sourceManifestPath)
+{
+    TRACE_SCOPE("Deploy", "operations", source.string() + " -> " + destination.string());
+    auto start = std::chrono::steady_clock::now();
+    DeployResult result;
+
+    std::error_code ec;
+    std::filesystem::create_directories(destination, ec);
+    auto manifestPath = destination / kManifestName;
+    auto pendingPath = destination / kPendingName;
+
+    // Files this launcher deployed there, the only ones it may remove
+    PackageManifest targetManifest;
+    bool hasManifest = targetManifest.load(manifestPath);
+    bool interrupted = std::filesystem::exists(pendingPath, ec);
+    std::set<std::string> owned = interrupted ? loadPending(pendingPath) : std::set<std::string>();
+    for (const auto& [path, file] : targetManifest.getFiles())
+    {
+        owned.insert(path);
+    }
+
+    if (!hasManifest && !interrupted && !std::filesystem::is_empty(destination, ec))
+    {
+        result.error = "Not deploying into " + destination.string() +
+                       ": it is not empty and was not deployed to before, pick an empty or a deployed folder";
+        return result;
+    }
+
+    PackageManifest knownSource;
+    if (!sourceManifestPath.empty())
+        knownSource.load(sourceManifestPath);
+    auto sourceManifest = PackageManifest::scan(source, knownSource);
+    if (!sourceManifestPath.empty() && !sourceManifest.save(sourceManifestPath))
+        spdlog::warn("Failed to write package manifest {}", sourceManifestPath.string());
+
+    // What the destination holds: its manifest when every listed file still has the recorded size, otherwise
+    // whatever a scan finds
+    bool trusted = hasManifest && !interrupted;
+    for (const auto& [path, file] : targetManifest.getFiles())
+    {
+        if (!trusted)
+            break;
+        auto size = std::filesystem::file_size(destination / path, ec);
+        trusted = !ec && size == file.size;
+    }
+    if (!trusted)
+    {
+        spdlog::info("No valid deploy manifest in {}, indexing its files", destination.string());
+        targetManifest = PackageManifest::scan(destination);
+    }
+
+    std::vector<std::string> changed;
+    for (const auto& [path, file] : sourceManifest.getFiles())
+    {
+        auto existing = targetManifest.getFiles().find(path);
+        if (existing != targetManifest.getFiles().end() && existing->second.size == file.size &&
+            existing->second.hash == file.hash)
+        {
+            result.filesUnchanged++;
+            continue;
+        }
+        changed.push_back(path);
+    }
+
+    // The manifest is rewritten at the end, until then it must not describe a half updated tree
+    for (const auto& [path, file] : sourceManifest.getFiles())
+    {
+        owned.insert(path);
+    }
+    if (!savePending(pendingPath, owned))
+    {
+        result.error = "Failed to write " + pendingPath.string();
+        return result;
+    }
+    std::filesystem::remove(manifestPath, ec);
+
+    DeployCounters counters;
+    std::atomic<size_t> failed{0};
+    parallelFor(changed.size(),
+                [&](size_t i)
+                {
+                    if (cancelled)
+                        return;
+                    const auto& path = changed[i];
+                    const auto& file = sourceManifest.getFiles().at(path);
+                    auto existing = targetManifest.getFiles().find(path);
+                    const PackageFile* previous =
+                        existing != targetManifest.getFiles().end() ? &existing->second : nullptr;
+                    if (!deployFile(source / path, destination / path, file, previous, counters, cancelled) &&
+                        !cancelled)
+                    {
+                        failed++;
+                        spdlog::warn("Failed to deploy {}", path);
+                    }
+                });
+
+    result.cancelled = cancelled;
+    result.filesFailed = failed;
+    result.filesUpdated = changed.size() - result.filesFailed;
+    result.bytesTransferred = counters.transferred;
+    result.bytesReused = counters.reused;
+
+    if (!result.cancelled)
+    {
+        // Deployed files that are no longer part of the package, and parts left by an interrupted deploy. Anything
+        // else in the destination is not ours and stays.
+        std::vector<std::filesystem::path> stale;
+        for (const auto& path : owned)
+        {
+            if (sourceManifest.getFiles().count(path) == 0 && std::filesystem::is_regular_file(destination / path, ec))
+                stale.push_back(destination / path);
+        }
+        std::filesystem::recursive_directory_iterator it(destination, ec), end;
+        for (; !ec && it != end; it.increment(ec))
+        {
+            if (it->is_regular_file(ec) && it->path().filename().string().ends_with(kPartSuffix))
+                stale.push_back(it->path());
+        }
+        for (const auto& path : stale)
+        {
+            if (std::filesystem::remove(path, ec))
+                result.filesRemoved++;
+        }
+    }
+
+    result.success = !result.cancelled && result.filesFailed == 0;
+    if (result.success)
+    {
+        if (sourceManifest.save(manifestPath))
+            std::filesystem::remove(pendingPath, ec);
+        else
+            spdlog::warn("Failed to write deploy manifest {}", manifestPath.string());
+    }
+
+    result.durationMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace unreal
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace unreal
+{
+
+struct DeployResult
+{
+    bool success = false;
+    bool cancelled = false;
+    size_t filesUpdated = 0;
+    size_t filesUnchanged = 0;
+    size_t filesRemoved = 0;
+    size_t filesFailed = 0;
+    // Bytes read from the source, and bytes taken from the previous version of a file at the destination
+    uint64_t bytesTransferred = 0;
+    uint64_t bytesReused = 0;
+    double durationMs = 0.0;
+    // Why nothing was deployed, e.g. a destination holding files of something else
+    std::string error;
+};
+
+// Mirrors an archived package into destination (a mounted share or a local test root). Both sides are split into
+// the content-defined chunks of PackageManifest, the destination keeps the manifest of what it holds, and a changed
+// file is rebuilt from the chunks it already had plus the ones that changed at the source. Files are written next to
+// their target, verified against the chunk hashes and renamed into place, so an interrupted deploy never leaves a
+// partial file behind. Only files of a previous deploy are ever removed: a destination that is not empty and holds
+// no deploy manifest is refused. sourceManifestPath, when given, holds the manifest of the source from the package
+// or the previous deploy: only the files whose size or mtime changed since are read, and it is updated afterwards.
+DeployResult deployPackage(const std::filesystem::path& source, const std::filesystem::path& destination,
+                           const std::atomic<bool>& cancelled, const std::filesystem::path& sourceManifestPath = {});
+
+} // namespace unreal
@@ -0,0 +1,222 @@
+#include "editor_startup.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+
+namespace unreal
+{
+
+namespace
+{
+// Startups vary with the disk cache and the machine's load, smaller changes are noise
+constexpr double kMinRegressionSeconds = 10.0;
+constexpr double kRegressionRatio = 1.25;
+constexpr size_t kBaselineStartups = 5;
+
+const char* kEngineInitializedMarkers[] = {"Engine is initialized.", "(Engine Initialization) Total time:"};
+// UE 5.0 reports the initial scan as "Asset discovery search completed", later versions as "AssetRegistryGather time"
+const char* kAssetsScannedMarkers[] = {"Asset discovery search completed", "AssetRegistryGather time"};
+
+bool containsAny(const std::string& line, const char* const (&markers)[2])
+{
+    return std::any_of(std::begin(markers), std::end(markers),
+                       [&line](const char* marker) { return line.find(marker) != std::string::npos; });
+}
+
+// Remaining count of a "Shaders left to compile 12" progress line, -1 for other lines
+long shadersLeft(const std::string& line)
+{
+    if (line.find("LogShaderCompilers") == std::string::npos)
+        return -1;
+    std::string lower = line;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    auto position = lower.find("left to compile");
+    if (position == std::string::npos)
+        return -1;
+
+    const char* digits = lower.c_str() + position + 15;
+    while (*digits == ' ' || *digits == ':')
+        digits++;
+    char* end = nullptr;
+    long left = std::strtol(digits, &end, 10);
+    return end == digits ? -1 : left;
+}
+
+double round2(double value)
+{
+    return std::round(value * 100.0) / 100.0;
+}
+} // namespace
+
+EditorStartupParser::EditorStartupParser()
+{
+    m_start = Clock::now();
+}
+
+StartupPhase EditorStartupParser::feed(const std::string& line)
+{
+    // The launcher's own command echo is not editor output
+    if (line.rfind("Executing: ", 0) == 0)
+        return StartupPhase::None;
+
+    double now = std::chrono::duration<double>(Clock::now() - m_start).count();
+    if (m_record.firstOutput < 0.0)
+    {
+        m_record.firstOutput = now;
+        return StartupPhase::FirstOutput;
+    }
+
+    if (m_record.shadersCompiled < 0.0)
+    {
+        long left = shadersLeft(line);
+        if (left >= 0)
+        {
+            m_lastShaderProgress = now;
+            if (left == 0)
+            {
+                m_record.shadersCompiled = now;
+                return StartupPhase::ShadersCompiled;
+            }
+            return StartupPhase::None;
+        }
+    }
+
+    if (m_record.engineInitialized < 0.0 && containsAny(line, kEngineInitializedMarkers))
+    {
+        m_record.engineInitialized = now;
+        if (m_assetsScanned < 0.0)
+            return StartupPhase::EngineInitialized;
+        // Small projects finish scanning their assets before the engine is done initializing
+        m_record.ready = now;
+        return StartupPhase::Ready;
+    }
+
+    if (m_assetsScanned < 0.0 && containsAny(line, kAssetsScannedMarkers))
+    {
+        m_assetsScanned = now;
+        if (m_record.engineInitialized >= 0.0)
+        {
+            m_record.ready = now;
+            return StartupPhase::Ready;
+        }
+    }
+    return StartupPhase::None;
+}
+
+EditorStartupRecord EditorStartupParser::finish()
+{
+    auto record = m_record;
+    // Compilation that never reported reaching zero ended with its last progress line
+    if (record.shadersCompiled < 0.0 && m_lastShaderProgress >= 0.0)
+        record.shadersCompiled = m_lastShaderProgress;
+    if (record.ready < 0.0)
+        record.ready = record.engineInitialized;
+    record.timestamp =
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    return record;
+}
+
+EditorStartupHistory& EditorStartupHistory::instance()
+{
+    static EditorStartupHistory instance;
+    return instance;
+}
+
+void EditorStartupHistory::append(const EditorStartupRecord& record)
+{
+    TRACE_SCOPE("Append editor startup", "io", record.project);
+
+    nlohmann::json json;
+    json["time"] = record.timestamp;
+    json["engine"] = record.engine;
+    json["prefetched"] = record.prefetched;
+    json["firstOutput"] = round2(record.firstOutput);
+    json["engineInit"] = round2(record.engineInitialized);
+    json["shaders"] = round2(record.shadersCompiled);
+    json["ready"] = round2(record.ready);
+
+    m_store.append(record.project, json.dump());
+}
+
+std::vector<EditorStartupRecord> EditorStartupHistory::load(const std::string& project,
+                                                            const std::string& engine) const
+{
+    TRACE_SCOPE("Load editor startups", "io", project);
+    std::vector<EditorStartupRecord> records;
+    m_store.load(project,
+                 [&](const std::string& line)
+                 {
+                     auto json = nlohmann::json::parse(line);
+                     if (json.value("engine", "") != engine)
+                         return;
+
+                     EditorStartupRecord record;
+                     record.project = project;
+                     record.engine = engine;
+                     record.timestamp = json.value("time", int64_t(0));
+                     record.prefetched = json.value("prefetched", false);
+                     record.firstOutput = json.value("firstOutput", -1.0);
+                     record.engineInitialized = json.value("engineInit", -1.0);
+                     record.shadersCompiled = json.value("shaders", -1.0);
+                     record.ready = json.value("ready", -1.0);
+                     records.push_back(std::move(record));
+                 });
+    return records;
+}
+
+std::vector<BuildRegression> EditorStartupHistory::findRegressions(const std::vector<EditorStartupRecord>& records)
+{
+    std::vector<BuildRegression> regressions;
+    if (records.size() < 2)
+        return regressions;
+
+    struct Phase
+    {
+        const char* subject;
+        double EditorStartupRecord::*seconds;
+    };
+    static const Phase phases[] = {{"Editor first output", &EditorStartupRecord::firstOutput},
+                                   {"Engine initialization", &EditorStartupRecord::engineInitialized},
+                                   {"Shader compilation", &EditorStartupRecord::shadersCompiled},
+                                   {"Editor ready", &EditorStartupRecord::ready}};
+
+    const auto& current = records.back();
+    for (const auto& phase : phases)
+    {
+        double after = current.*phase.seconds;
+        if (after < 0.0)
+            continue;
+
+        std::vector<double> previous;
+        int64_t since = 0;
+        for (size_t i = records.size() - 1; i-- > 0 && previous.size() < kBaselineStartups;)
+        {
+            double seconds = records[i].*phase.seconds;
+            if (seconds < 0.0)
+                continue;
+            previous.push_back(seconds);
+            if (since == 0)
+                since = records[i].timestamp;
+        }
+        if (previous.empty())
+            continue;
+
+        double baseline = median(previous);
+        if (after - baseline >= kMinRegressionSeconds && after >= kRegressionRatio * baseline)
+        {
+            BuildRegression regression;
+            regression.subject = phase.subject;
+            regression.before = baseline;
+            regression.after = after;
+            regression.since = since;
+            regressions.push_back(regression);
+        }
+    }
+    return regressions;
+}
+
+} // namespace unreal
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "build_history.h"
+#include "history_store.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+enum class StartupPhase
+{
+    None,
+    // First line the editor printed
+    FirstOutput,
+    // "LogInit: Display: Engine is initialized", or the "(Engine Initialization) Total time" that follows it
+    EngineInitialized,
+    // Shader compile progress reached "left to compile 0"
+    ShadersCompiled,
+    // Engine initialized and the asset registry's initial scan completed
+    Ready
+};
+
+// Seconds from the launch to each phase, negative when its marker never showed up
+struct EditorStartupRecord
+{
+    int64_t timestamp = 0;
+    std::string project;
+    std::string engine;
+    bool prefetched = false;
+    double firstOutput = -1.0;
+    double engineInitialized = -1.0;
+    double shadersCompiled = -1.0;
+    double ready = -1.0;
+};
+
+// Times the startup phases of an editor from its log as it streams in
+class EditorStartupParser
+{
+  public:
+    EditorStartupParser();
+
+    // Returns the phase the line completed, None for every other line
+    StartupPhase feed(const std::string& line);
+    // The editor counts as ready at engine initialization when the asset registry never reported its scan
+    EditorStartupRecord finish();
+
+    bool isEngineInitialized() const
+    {
+        return m_record.engineInitialized >= 0.0;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point m_start;
+    EditorStartupRecord m_record;
+    double m_lastShaderProgress = -1.0;
+    double m_assetsScanned = -1.0;
+};
+
+// Append-only JSON lines store of editor startups, one file per project in history/editor/
+class EditorStartupHistory
+{
+  public:
+    static EditorStartupHistory& instance();
+
+    void append(const EditorStartupRecord& record);
+    // Oldest first, only the startups with the given engine
+    std::vector<EditorStartupRecord> load(const std::string& project, const std::string& engine) const;
+
+    uint64_t getRevision() const
+    {
+        return m_store.getRevision();
+    }
+
+    // Compares each phase of the newest startup against the median of the ones before it
+    static std::vector<BuildRegression> findRegressions(const std::vector<EditorStartupRecord>& records);
+
+  private:
+    EditorStartupHistory() = default;
+
+    JsonLinesStore m_store{"editor"};
+};
+
+} // namespace unreal
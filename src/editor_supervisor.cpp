@@ -0,0 +1,589 @@
+#include "editor_supervisor.h"
+#include "cgroup.h"
+#include "config.h"
+#include "editor_startup.h"
+#include "prefetch.h"
+#include "system.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <optional>
+#include <spdlog/spdlog.h>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+constexpr size_t kLogTailLines = 500;
+constexpr auto kSampleInterval = std::chrono::seconds(1);
+constexpr auto kTailInterval = std::chrono::milliseconds(200);
+constexpr size_t kKeptLogFiles = 50;
+
+// Removes the oldest editor logs, a launch adds one
+void pruneLogs(const std::filesystem::path& directory)
+{
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> logs;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->path().extension() == ".log")
+            logs.emplace_back(it->last_write_time(ec), it->path());
+    }
+    if (logs.size() <= kKeptLogFiles)
+        return;
+    std::sort(logs.begin(), logs.end());
+    for (size_t i = 0; i + kKeptLogFiles < logs.size(); ++i)
+    {
+        std::filesystem::remove(logs[i].second, ec);
+    }
+}
+} // namespace
+
+EditorSupervisor& EditorSupervisor::instance()
+{
+    static EditorSupervisor instance;
+    return instance;
+}
+
+EditorSupervisor::~EditorSupervisor()
+{
+    shutdown();
+}
+
+void EditorSupervisor::setLogCallback(LogCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    m_logCallback = callback;
+}
+
+void EditorSupervisor::log(const std::string& message, bool isError)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        if (m_logCallback)
+        {
+            m_logCallback(message, isError);
+            return;
+        }
+    }
+    if (isError)
+        spdlog::error("{}", message);
+    else
+        spdlog::info("{}", message);
+}
+
+uint64_t EditorSupervisor::launch(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                                  const std::string& additionalArgs, const EditorLaunchOptions& options)
+{
+#ifdef _WIN32
+    auto editor = enginePath / "Engine" / "Binaries" / "Win64" / "UnrealEditor.exe";
+#elif __APPLE__
+    auto editor =
+        enginePath / "Engine" / "Binaries" / "Mac" / "UnrealEditor.app" / "Contents" / "MacOS" / "UnrealEditor";
+#else
+    auto editor = enginePath / "Engine" / "Binaries" / "Linux" / "UnrealEditor";
+#endif
+
+    std::string command = "\"" + editor.string() + "\" \"" + uprojectPath.string() + "\"";
+    if (!additionalArgs.empty())
+    {
+        command += " " + additionalArgs;
+    }
+
+    auto instance = std::make_unique<Instance>();
+    instance->project = uprojectPath.stem().string();
+    instance->uprojectPath = uprojectPath;
+    instance->enginePath = enginePath;
+    instance->options = options;
+    instance->start = std::chrono::steady_clock::now();
+
+    // The output goes to a file rather than a pipe so the editor does not depend on the launcher staying open
+    auto logDirectory = Config::instance().getEditorLogsDirectory();
+    std::error_code ec;
+    std::filesystem::create_directories(logDirectory, ec);
+    pruneLogs(logDirectory);
+    auto now = std::time(nullptr);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+    auto logName = instance->project;
+    if (!options.label.empty())
+        logName += "_" + options.label;
+    std::replace(logName.begin(), logName.end(), ' ', '_');
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_quit || (options.session != 0 && m_closedSessions.count(options.session)))
+        return 0;
+    instance->id = m_nextId++;
+    instance->logPath = logDirectory / (logName + "_" + stamp + "_" + std::to_string(instance->id) + ".log");
+#ifdef _WIN32
+    command += " > \"" + instance->logPath.string() + "\" 2>&1";
+#endif
+    auto& started = *instance;
+    started.thread = std::thread([this, &started, command]() { runInstance(started, command); });
+    m_instances.push_back(std::move(instance));
+    if (!m_sampler.joinable())
+    {
+        m_sampler = std::thread([this]() { samplerLoop(); });
+    }
+    return started.id;
+}
+
+uint64_t EditorSupervisor::launchSession(const std::filesystem::path& enginePath,
+                                         const std::filesystem::path& uprojectPath,
+                                         std::vector<MultiplayerInstance> instances, std::chrono::seconds stagger)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_quit)
+        return 0;
+    uint64_t session = m_nextSession++;
+    m_sessionThreads.emplace_back(
+        [this, enginePath, uprojectPath, instances = std::move(instances), stagger, session]()
+        {
+            Trace::setThreadName("Session " + std::to_string(session));
+            for (size_t i = 0; i < instances.size(); ++i)
+            {
+                EditorLaunchOptions options;
+                options.label = instances[i].label;
+                options.cpus = instances[i].cpus;
+                options.session = session;
+                options.closesSession = i == 0;
+                options.editor = false;
+                uint64_t id = launch(enginePath, uprojectPath, instances[i].arguments, options);
+                if (id == 0 || i + 1 == instances.size())
+                    break;
+
+                // Starting everything at once has every instance compile shaders and read the disk together
+                auto deadline = std::chrono::steady_clock::now() + stagger;
+                std::unique_lock<std::mutex> wait(m_mutex);
+                m_condition.wait_until(wait, deadline,
+                                       [&]()
+                                       {
+                                           if (m_quit || m_closedSessions.count(session))
+                                               return true;
+                                           auto it = std::find_if(m_instances.begin(), m_instances.end(),
+                                                                  [id](const auto& instance)
+                                                                  { return instance->id == id; });
+                                           return it == m_instances.end() || (*it)->initialized ||
+                                                  !(*it)->running;
+                                       });
+            }
+        });
+    return session;
+}
+
+void EditorSupervisor::closeSession(uint64_t session)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closedSessions.insert(session);
+        for (auto& instance : m_instances)
+        {
+            // Instances already closing get their time to quit, only kill() escalates
+            if (instance->options.session == session && instance->running && !instance->killRequested)
+                closeInstance(*instance);
+        }
+    }
+    m_condition.notify_all();
+}
+
+bool EditorSupervisor::isSessionRunning(uint64_t session) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (session == 0 || m_closedSessions.count(session))
+        return false;
+    // Still starting when none of its instances exists yet
+    bool any = false;
+    for (const auto& instance : m_instances)
+    {
+        if (instance->options.session != session)
+            continue;
+        any = true;
+        if (instance->running)
+            return true;
+    }
+    return !any && session < m_nextSession;
+}
+
+void EditorSupervisor::runInstance(Instance& instance, const std::string& command)
+{
+    const auto& options = instance.options;
+    auto name = options.label.empty() ? instance.project : instance.project + " " + options.label;
+    Trace::setThreadName("Editor " + name);
+    TRACE_SCOPE("Editor", "operations", name);
+    log("Launching " + name + "...");
+
+    auto& groups = ResourceGroups::instance();
+    auto placement = groups.place(JobClass::Editor, instance.project);
+    auto policy = placement.launch;
+    policy.cpus = options.cpus;
+    policy.outputFile = instance.logPath.string();
+
+    {
+        // Game instances are not editor startups, they only report when they are initialized
+        bool standalone = options.editor;
+        EditorStartupParser startup;
+        std::optional<EditorLaunchRecorder> recorder;
+        if (standalone)
+            recorder.emplace(instance.enginePath, [&instance]() { return instance.executor.getProcessGroup(); });
+        bool recorded = false;
+        auto onLine = [&](const std::string& line)
+        {
+            appendLog(instance, line);
+            auto phase = startup.feed(line);
+            if (phase == StartupPhase::EngineInitialized || phase == StartupPhase::Ready)
+            {
+                if (!instance.initialized.exchange(true))
+                    m_condition.notify_all();
+                auto summary = recorder ? recorder->onEngineInitialized() : std::string();
+                if (!summary.empty())
+                    log(name + ": " + summary);
+            }
+            if (phase == StartupPhase::Ready && standalone)
+            {
+                recordStartup(startup, instance, recorder->isPrefetched());
+                recorded = true;
+            }
+        };
+
+        // The executor's own messages ("Executing: ...") go to the tail only, the editor's come from its log file
+        instance.executor.setOutputCallback([&](const std::string& line, bool) { appendLog(instance, line); });
+        instance.executor.setLaunchPolicy(policy);
+        auto result = instance.executor.executeAsync(command);
+
+        std::ifstream file;
+        std::string partial;
+        auto tail = [&]()
+        {
+            if (!file.is_open())
+            {
+                file.open(instance.logPath, std::ios::binary);
+                if (!file.is_open())
+                    return;
+            }
+            char buffer[4096];
+            file.clear();
+            while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+            {
+                for (std::streamsize i = 0; i < file.gcount(); ++i)
+                {
+                    char c = buffer[i];
+                    if (c == '\n')
+                    {
+                        if (!partial.empty())
+                            onLine(partial);
+                        partial.clear();
+                    }
+                    else if (c != '\r')
+                    {
+                        partial += c;
+                    }
+                }
+            }
+        };
+        while (result.wait_for(kTailInterval) != std::future_status::ready)
+        {
+            tail();
+        }
+        tail();
+        if (!partial.empty())
+            onLine(partial);
+        instance.exitCode = result.get();
+        instance.executor.setOutputCallback(nullptr);
+
+        // Editors closed before the asset registry finished still count from their engine init
+        if (standalone && !recorded && !instance.detached && startup.isEngineInitialized())
+        {
+            recordStartup(startup, instance, recorder->isPrefetched());
+        }
+    }
+
+    if (auto oomKills = groups.release(placement))
+    {
+        log("[ERR] " + std::to_string(oomKills) + " process(es) killed for exceeding the memory.max of the " +
+                ResourceGroups::jobClassToString(JobClass::Editor) + " job class",
+            true);
+    }
+
+    if (instance.detached)
+    {
+        // Left running by the launcher quitting, nothing of it is recorded
+        spdlog::info("{} left running, its output goes to {}", name, instance.logPath.string());
+        instance.running = false;
+        return;
+    }
+
+    int exitCode = instance.exitCode;
+    instance.running = false;
+    m_condition.notify_all();
+    if (exitCode == 0 || instance.killRequested)
+        log(name + " closed");
+    else
+        log("[ERR] " + name + " exited with code " + std::to_string(exitCode), true);
+
+    if (options.onExit)
+    {
+        auto message = options.onExit(exitCode);
+        if (!message.empty())
+            log(message, message.rfind("[ERR]", 0) == 0);
+    }
+
+    if (options.closesSession)
+        closeSession(options.session);
+}
+
+void EditorSupervisor::appendLog(Instance& instance, const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    instance.log.push_back(line);
+    if (instance.log.size() > kLogTailLines)
+        instance.log.pop_front();
+}
+
+void EditorSupervisor::recordStartup(EditorStartupParser& startup, const Instance& instance, bool prefetched)
+{
+    auto record = startup.finish();
+    record.project = instance.project;
+    record.engine = instance.enginePath.string();
+    record.prefetched = prefetched;
+
+    auto& history = EditorStartupHistory::instance();
+    history.append(record);
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "Editor ready in %.1f s (first output %.1f s, engine initialized %.1f s",
+             record.ready, record.firstOutput, record.engineInitialized);
+    std::string message = summary;
+    if (record.shadersCompiled >= 0.0)
+    {
+        snprintf(summary, sizeof(summary), ", shaders compiled %.1f s", record.shadersCompiled);
+        message += summary;
+    }
+    log(instance.project + ": " + message + ")");
+
+    for (const auto& regression :
+         EditorStartupHistory::findRegressions(history.load(record.project, record.engine)))
+    {
+        log(instance.project + ": editor startup regression: " + regression.describe());
+    }
+}
+
+void EditorSupervisor::samplerLoop()
+{
+    Trace::setThreadName("Editor sampler");
+
+    struct Sample
+    {
+        uint64_t id = 0;
+        int group = 0;
+        int pid = 0;
+        ProcessGroupUsage usage;
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_condition.wait_for(lock, kSampleInterval, [this]() { return m_quit; }))
+    {
+        std::vector<Sample> samples;
+        for (const auto& instance : m_instances)
+        {
+            int group = instance->executor.getProcessGroup();
+            if (instance->running && group != 0)
+                samples.push_back({instance->id, group, instance->pid, {}});
+        }
+
+        // Scanning /proc takes a while with many processes, the views must not wait for it
+        lock.unlock();
+        for (auto& sample : samples)
+        {
+            if (sample.pid == 0)
+                sample.pid = findProcessInGroup(sample.group, {"UnrealEditor", "UE4Editor"});
+            sample.usage = readProcessGroupUsage(sample.group);
+        }
+        auto now = std::chrono::steady_clock::now();
+        lock.lock();
+
+        for (const auto& sample : samples)
+        {
+            auto it = std::find_if(m_instances.begin(), m_instances.end(),
+                                   [&sample](const auto& instance) { return instance->id == sample.id; });
+            if (it == m_instances.end() || !(*it)->running)
+                continue;
+
+            auto& instance = **it;
+            const auto& usage = sample.usage;
+            instance.pid = sample.pid;
+            if (instance.lastCpuSeconds >= 0.0)
+            {
+                double elapsed = std::chrono::duration<double>(now - instance.lastSample).count();
+                // Processes that exited since the last sample take their CPU time with them
+                double used = std::max(0.0, usage.cpuSeconds - instance.lastCpuSeconds);
+                instance.cpuPercent = elapsed > 0.0 ? 100.0 * used / elapsed : 0.0;
+            }
+            instance.lastCpuSeconds = usage.cpuSeconds;
+            instance.lastSample = now;
+            instance.residentBytes = usage.residentBytes;
+            instance.processes = usage.processes;
+        }
+    }
+}
+
+std::vector<EditorInstanceInfo> EditorSupervisor::getInstances() const
+{
+    std::vector<EditorInstanceInfo> instances;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& instance : m_instances)
+    {
+        EditorInstanceInfo info;
+        info.id = instance->id;
+        info.project = instance->project;
+        info.label = instance->options.label;
+        info.session = instance->options.session;
+        info.uprojectPath = instance->uprojectPath;
+        info.cpus = instance->options.cpus;
+        info.logPath = instance->logPath;
+        info.pid = instance->pid;
+        info.running = instance->running;
+        info.killRequested = instance->killRequested;
+        info.exitCode = instance->exitCode;
+        if (info.running)
+        {
+            info.uptimeSeconds = std::chrono::duration<double>(now - instance->start).count();
+            info.cpuPercent = instance->cpuPercent;
+            info.residentBytes = instance->residentBytes;
+            info.processes = instance->processes;
+        }
+        instances.push_back(std::move(info));
+    }
+    return instances;
+}
+
+std::vector<std::string> EditorSupervisor::getLogTail(uint64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& instance : m_instances)
+    {
+        if (instance->id == id)
+            return {instance->log.begin(), instance->log.end()};
+    }
+    return {};
+}
+
+size_t EditorSupervisor::getRunningCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::count_if(m_instances.begin(), m_instances.end(),
+                                             [](const auto& instance) { return instance->running.load(); }));
+}
+
+bool EditorSupervisor::focus(uint64_t id)
+{
+    int pid = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& instance : m_instances)
+        {
+            if (instance->id == id && instance->running)
+                pid = instance->pid;
+        }
+    }
+    if (pid == 0)
+        return false;
+
+#ifdef __linux__
+    CommandExecutor executor;
+    if (executor.execute({"xdotool", "search", "--pid", std::to_string(pid), "windowactivate"}) == 0)
+        return true;
+    log("[ERR] Could not focus the editor window, is xdotool installed?", true);
+#endif
+    return false;
+}
+
+void EditorSupervisor::kill(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& instance : m_instances)
+    {
+        if (instance->id == id && instance->running)
+            closeInstance(*instance);
+    }
+}
+
+void EditorSupervisor::closeInstance(Instance& instance)
+{
+    const auto& label = instance.options.label;
+    auto name = label.empty() ? instance.project : instance.project + " " + label;
+    if (!instance.killRequested.exchange(true))
+    {
+        log("Closing " + name + "...");
+        instance.executor.cancel();
+        return;
+    }
+#ifndef _WIN32
+    // The instance ignored the first request, usually because it is stuck
+    if (int group = instance.executor.getProcessGroup())
+    {
+        log("Killing " + name, true);
+        ::kill(-group, SIGKILL);
+    }
+#endif
+}
+
+void EditorSupervisor::dismiss(uint64_t id)
+{
+    std::unique_ptr<Instance> dismissed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_instances.begin(), m_instances.end(),
+                               [id](const auto& instance) { return instance->id == id && !instance->running; });
+        if (it == m_instances.end())
+            return;
+        dismissed = std::move(*it);
+        m_instances.erase(it);
+    }
+    if (dismissed->thread.joinable())
+    {
+        dismissed->thread.join();
+    }
+}
+
+void EditorSupervisor::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_quit)
+            return;
+        m_quit = true;
+        // Editors keep running on their own, their output already goes to a file
+        for (auto& instance : m_instances)
+        {
+            if (!instance->running)
+                continue;
+            instance->detached = true;
+            instance->executor.detach();
+        }
+    }
+    m_condition.notify_all();
+    if (m_sampler.joinable())
+    {
+        m_sampler.join();
+    }
+    for (auto& thread : m_sessionThreads)
+    {
+        thread.join();
+    }
+    for (auto& instance : m_instances)
+    {
+        if (instance->thread.joinable())
+            instance->thread.join();
+    }
+}
+
+} // namespace unreal
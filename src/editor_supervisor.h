@@ -0,0 +1,153 @@
+#pragma once
+
+#include "multiplayer.h"
+#include "utils.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+class EditorStartupParser;
+
+// How one supervised instance is started
+struct EditorLaunchOptions
+{
+    // Shown next to the project, "Server", "Client 1", ...
+    std::string label;
+    std::vector<int> cpus;
+    // Instances of a session are closed together, 0 for a standalone editor
+    uint64_t session = 0;
+    // Closing this instance closes the rest of its session
+    bool closesSession = false;
+    // Only editors (not -game instances) have their startup timed and their files learned for prefetching
+    bool editor = true;
+    // Called from the instance's thread once it exited, returns a line for the log ("[ERR] ..." for an error) or ""
+    std::function<std::string(int exitCode)> onExit;
+};
+
+// Snapshot of one supervised editor for the views
+struct EditorInstanceInfo
+{
+    uint64_t id = 0;
+    std::string project;
+    std::string label;
+    uint64_t session = 0;
+    std::filesystem::path uprojectPath;
+    std::vector<int> cpus;
+    // Everything the instance printed, it keeps writing there after the launcher quit
+    std::filesystem::path logPath;
+    // The editor process found in the launch's process group, 0 until it shows up or when unsupported
+    int pid = 0;
+    double uptimeSeconds = 0.0;
+    // Whole process group, shader workers included, sampled once per second
+    double cpuPercent = 0.0;
+    uint64_t residentBytes = 0;
+    size_t processes = 0;
+    bool running = false;
+    bool killRequested = false;
+    int exitCode = 0;
+};
+
+// Runs editors outside of ProjectOperations' shared executor: each one gets its own executor and thread, so builds
+// and packages stay available while editors are open. Each editor writes its output to its own log file, which is
+// tailed into memory, and the CPU and memory of its process group are sampled from /proc.
+class EditorSupervisor
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    static EditorSupervisor& instance();
+
+    void setLogCallback(LogCallback callback);
+
+    // Starts the editor and returns its instance id right away
+    uint64_t launch(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                    const std::string& additionalArgs = "", const EditorLaunchOptions& options = {});
+    // Starts the instances one after the other from a background thread, each once the previous one finished
+    // initializing or after stagger, and returns the session id right away. The first instance closes the session.
+    uint64_t launchSession(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                           std::vector<MultiplayerInstance> instances, std::chrono::seconds stagger);
+    // Closes every instance of the session and cancels the ones not started yet
+    void closeSession(uint64_t session);
+    bool isSessionRunning(uint64_t session) const;
+
+    std::vector<EditorInstanceInfo> getInstances() const;
+    std::vector<std::string> getLogTail(uint64_t id) const;
+    size_t getRunningCount() const;
+
+    // Raises the editor's window, Linux with xdotool only
+    bool focus(uint64_t id);
+    // Asks the editor to quit (SIGTERM to its process group), a second call kills the group
+    void kill(uint64_t id);
+    // Forgets an exited instance
+    void dismiss(uint64_t id);
+
+    // Stops supervising, running editors are left open and keep writing to their log file. Called once when the
+    // launcher quits.
+    void shutdown();
+
+  private:
+    struct Instance
+    {
+        uint64_t id = 0;
+        std::string project;
+        std::filesystem::path uprojectPath;
+        std::filesystem::path enginePath;
+        EditorLaunchOptions options;
+        std::filesystem::path logPath;
+        std::chrono::steady_clock::time_point start;
+        CommandExecutor executor;
+        std::thread thread;
+        std::deque<std::string> log;
+
+        std::atomic<bool> running{true};
+        std::atomic<bool> initialized{false};
+        std::atomic<bool> killRequested{false};
+        // The launcher quit while the instance was running
+        std::atomic<bool> detached{false};
+        std::atomic<int> exitCode{0};
+        int pid = 0;
+        double cpuPercent = 0.0;
+        double lastCpuSeconds = -1.0;
+        std::chrono::steady_clock::time_point lastSample;
+        uint64_t residentBytes = 0;
+        size_t processes = 0;
+    };
+
+    EditorSupervisor() = default;
+    ~EditorSupervisor();
+
+    void log(const std::string& message, bool isError = false);
+    void runInstance(Instance& instance, const std::string& command);
+    void appendLog(Instance& instance, const std::string& line);
+    void recordStartup(EditorStartupParser& startup, const Instance& instance, bool prefetched);
+    void samplerLoop();
+    // Requires m_mutex
+    void closeInstance(Instance& instance);
+
+    std::vector<std::unique_ptr<Instance>> m_instances;
+    uint64_t m_nextId = 1;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_sampler;
+    bool m_quit = false;
+    uint64_t m_nextSession = 1;
+    std::set<uint64_t> m_closedSessions;
+    std::vector<std::thread> m_sessionThreads;
+
+    std::mutex m_logMutex;
+    LogCallback m_logCallback;
+};
+
+} // namespace unreal
@@ -1,4 +1,6 @@
 #include "engine.h"
+#include "trace.h"
+#include "utils.h"
 #include <algorithm>
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -54,6 +56,7 @@ void EngineManager::addVersion(const std::string& name, const std::filesystem::p
         if (ver.name == name)
         {
             ver.path = enginePath;
+            markDirty();
             spdlog::info("Updated engine version: {} -> {}", name, enginePath.string());
             return;
         }
@@ -66,6 +69,7 @@ void EngineManager::addVersion(const std::string& name, const std::filesystem::p
     if (version.isValid())
     {
         m_versions.push_back(version);
+        markDirty();
         spdlog::info("Added engine version: {} at {}", name, enginePath.string());
     }
     else
@@ -89,6 +93,7 @@ void EngineManager::updateVersion(const std::string& oldName, const std::string&
             {
                 ver.name = newName;
                 ver.path = newPath;
+                markDirty();
                 spdlog::info("Updated engine version: {} -> {} at {}", oldName, newName, newPath.string());
             }
             else
@@ -108,6 +113,7 @@ void EngineManager::removeVersion(const std::string& name)
     if (it != m_versions.end())
     {
         m_versions.erase(it, m_versions.end());
+        markDirty();
         spdlog::info("Removed engine version: {}", name);
     }
 }
@@ -124,6 +130,7 @@ const EngineVersion* EngineManager::findVersion(const std::string& name) const
 
 bool EngineManager::load(const std::filesystem::path& configPath)
 {
+    TRACE_SCOPE("EngineManager::load", "engines");
     try
     {
         if (!std::filesystem::exists(configPath))
@@ -163,19 +170,23 @@ bool EngineManager::load(const std::filesystem::path& configPath)
 
 bool EngineManager::save(const std::filesystem::path& configPath) const
 {
+    return writeConfig(m_versions, configPath);
+}
+
+std::function<bool()> EngineManager::createSaveTask(const std::filesystem::path& configPath) const
+{
+    return [versions = m_versions, configPath]() { return writeConfig(versions, configPath); };
+}
+
+bool EngineManager::writeConfig(const std::vector<EngineVersion>& versions, const std::filesystem::path& configPath)
+{
+    TRACE_SCOPE("Save engines", "engines");
     try
     {
-        // Create parent directories if needed
-        auto parentPath = configPath.parent_path();
-        if (!parentPath.empty() && !std::filesystem::exists(parentPath))
-        {
-            std::filesystem::create_directories(parentPath);
-        }
-
         nlohmann::json json;
         json["engines"] = nlohmann::json::array();
 
-        for (const auto& ver : m_versions)
+        for (const auto& ver : versions)
         {
             nlohmann::json item;
             item["name"] = ver.name;
@@ -183,15 +194,13 @@ bool EngineManager::save(const std::filesystem::path& configPath) const
             json["engines"].push_back(item);
         }
 
-        std::ofstream file(configPath);
-        if (!file.is_open())
+        if (!writeFileAtomic(configPath, json.dump(4)))
         {
             spdlog::error("Failed to save engine config: {}", configPath.string());
             return false;
         }
 
-        file << json.dump(4);
-        spdlog::info("Saved {} engine versions to {}", m_versions.size(), configPath.string());
+        spdlog::info("Saved {} engine versions to {}", versions.size(), configPath.string());
         return true;
     }
     catch (const std::exception& e)
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -35,8 +37,24 @@ class EngineManager
     bool load(const std::filesystem::path& configPath);
     bool save(const std::filesystem::path& configPath) const;
 
+    // Returns a task writing a copy of the current state, safe to run on another thread
+    std::function<bool()> createSaveTask(const std::filesystem::path& configPath) const;
+
+    // Incremented on every change, used to detect unsaved changes
+    uint64_t getRevision() const
+    {
+        return m_revision;
+    }
+    void markDirty()
+    {
+        ++m_revision;
+    }
+
   private:
+    static bool writeConfig(const std::vector<EngineVersion>& versions, const std::filesystem::path& configPath);
+
     std::vector<EngineVersion> m_versions;
+    uint64_t m_revision = 0;
 };
 
 } // namespace unreal
@@ -0,0 +1,307 @@
+#include "fingerprint.h"
+#include "artifact_cache.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+constexpr int kCacheVersion = 1;
+// Files modified this close to the last save may have changed again within the same mtime tick
+constexpr int64_t kRacyWindowNs = 2'000'000'000;
+
+// Folders next to a .uplugin that never feed a build, the same names deeper in a plugin are sources
+const char* kSkippedPluginFolders[] = {"Binaries", "Intermediate", "Content", "Resources", "Saved"};
+
+// Guards the read-modify-write of every fingerprints.json, queue builds of one project run concurrently
+std::mutex g_cacheMutex;
+
+int64_t currentFileTime()
+{
+#ifdef _WIN32
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::filesystem::file_time_type::clock::now().time_since_epoch())
+        .count();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+bool statFile(const std::filesystem::path& path, uint64_t& size, int64_t& mtime, uint64_t& inode)
+{
+#ifdef _WIN32
+    std::error_code ec;
+    size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::filesystem::last_write_time(path, ec).time_since_epoch())
+                .count();
+    inode = 0;
+    return !ec;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    inode = static_cast<uint64_t>(st.st_ino);
+    return true;
+#endif
+}
+
+bool isPluginRoot(const std::filesystem::path& folder)
+{
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(folder, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->path().extension() == ".uplugin")
+            return true;
+    }
+    return false;
+}
+
+void collectFiles(const std::filesystem::path& root, const std::filesystem::path& base,
+                  std::vector<std::string>& files, bool skipPluginFolders)
+{
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(root, ec), end;
+    for (; !ec && it != end; it.increment(ec))
+    {
+        if (it->is_directory(ec))
+        {
+            if (skipPluginFolders)
+            {
+                auto name = it->path().filename().string();
+                if (std::find(std::begin(kSkippedPluginFolders), std::end(kSkippedPluginFolders), name) !=
+                        std::end(kSkippedPluginFolders) &&
+                    isPluginRoot(it->path().parent_path()))
+                    it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (it->is_regular_file(ec))
+            files.push_back(it->path().lexically_relative(base).generic_string());
+    }
+}
+
+uint64_t hashFileContents(const std::filesystem::path& path, uint64_t seed)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return seed;
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return hashBytes(contents.data(), contents.size(), seed);
+}
+} // namespace
+
+BuildFingerprints::BuildFingerprints(const std::filesystem::path& uprojectPath)
+    : m_uprojectPath(uprojectPath), m_projectDir(uprojectPath.parent_path())
+{
+    m_cachePath = m_projectDir / "Intermediate" / "ImUnrealLauncher" / "fingerprints.json";
+}
+
+std::string BuildFingerprints::makeKey(const std::string& target, const std::string& platform,
+                                       const std::string& config, const std::filesystem::path& enginePath)
+{
+    return target + "|" + platform + "|" + config + "|" + enginePath.generic_string();
+}
+
+void BuildFingerprints::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    try
+    {
+        std::ifstream file(m_cachePath);
+        if (!file.is_open())
+            return;
+
+        nlohmann::json json;
+        file >> json;
+        if (json.value("version", 0) != kCacheVersion)
+            return;
+
+        m_savedAt = json.value("savedAt", int64_t(0));
+        for (const auto& [path, item] : json["files"].items())
+        {
+            FileStamp stamp;
+            stamp.size = item[0].get<uint64_t>();
+            stamp.mtime = item[1].get<int64_t>();
+            stamp.inode = item[2].get<uint64_t>();
+            stamp.hash = item[3].get<uint64_t>();
+            m_files.emplace(path, stamp);
+        }
+        for (const auto& [key, value] : json["builds"].items())
+        {
+            m_builds[key] = value.get<uint64_t>();
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // A broken cache only costs a full rehash
+        spdlog::warn("Ignoring fingerprint cache {}: {}", m_cachePath.string(), e.what());
+        m_files.clear();
+        m_builds.clear();
+    }
+}
+
+void BuildFingerprints::save() const
+{
+    nlohmann::json json;
+    json["version"] = kCacheVersion;
+    json["savedAt"] = m_savedAt;
+
+    auto& files = json["files"] = nlohmann::json::object();
+    for (const auto& [path, stamp] : m_files)
+    {
+        files[path] = {stamp.size, stamp.mtime, stamp.inode, stamp.hash};
+    }
+    auto& builds = json["builds"] = nlohmann::json::object();
+    for (const auto& [key, value] : m_builds)
+    {
+        builds[key] = value;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_cachePath.parent_path(), ec);
+    if (!writeFileAtomic(m_cachePath, json.dump()))
+    {
+        spdlog::warn("Failed to write fingerprint cache {}", m_cachePath.string());
+    }
+}
+
+void BuildFingerprints::update(const std::function<void()>& change)
+{
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    m_loaded = false;
+    m_files.clear();
+    m_builds.clear();
+    load();
+    change();
+    save();
+}
+
+FingerprintResult BuildFingerprints::compute(const std::filesystem::path& enginePath)
+{
+    TRACE_SCOPE("Fingerprint", "operations", m_uprojectPath.string());
+    auto start = std::chrono::steady_clock::now();
+    load();
+
+    std::vector<std::string> files = {m_uprojectPath.filename().generic_string()};
+    collectFiles(m_projectDir / "Source", m_projectDir, files, false);
+    collectFiles(m_projectDir / "Config", m_projectDir, files, false);
+    collectFiles(m_projectDir / "Plugins", m_projectDir, files, true);
+    std::sort(files.begin(), files.end());
+
+    // Stat everything and rehash only what changed since the cached stamp
+    std::vector<FileStamp> stamps(files.size());
+    // Not vector<bool>, workers write neighbouring entries concurrently
+    std::vector<char> present(files.size(), 0);
+    std::atomic<size_t> rehashed{0};
+    int64_t racyLimit = m_savedAt - kRacyWindowNs;
+
+    parallelFor(files.size(),
+                [&](size_t i)
+                {
+                    auto path = m_projectDir / files[i];
+                    auto& stamp = stamps[i];
+                    if (!statFile(path, stamp.size, stamp.mtime, stamp.inode))
+                        return;
+                    present[i] = 1;
+
+                    auto cached = m_files.find(files[i]);
+                    if (cached != m_files.end() && cached->second.size == stamp.size &&
+                        cached->second.mtime == stamp.mtime && cached->second.inode == stamp.inode &&
+                        stamp.mtime < racyLimit)
+                    {
+                        stamp.hash = cached->second.hash;
+                        return;
+                    }
+
+                    MappedFile mapped;
+                    if (mapped.open(path))
+                        stamp.hash = hashBytes(mapped.data(), mapped.size());
+                    rehashed++;
+                },
+                16);
+
+    FingerprintResult result;
+    uint64_t fingerprint = 0;
+    std::unordered_map<std::string, FileStamp> current;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (!present[i])
+            continue;
+        fingerprint = hashBytes(files[i].data(), files[i].size(), fingerprint);
+        fingerprint = hashBytes(&stamps[i].hash, sizeof(stamps[i].hash), fingerprint);
+        current.emplace(files[i], stamps[i]);
+        result.files++;
+    }
+
+    // Engine identity: the version file, and the editor's module manifest whose BuildId changes on every
+    // engine rebuild
+#ifdef _WIN32
+    auto engineBinaries = enginePath / "Engine" / "Binaries" / "Win64";
+#elif __APPLE__
+    auto engineBinaries = enginePath / "Engine" / "Binaries" / "Mac";
+#else
+    auto engineBinaries = enginePath / "Engine" / "Binaries" / "Linux";
+#endif
+    fingerprint = hashFileContents(enginePath / "Engine" / "Build" / "Build.version", fingerprint);
+    fingerprint = hashFileContents(engineBinaries / "UnrealEditor.modules", fingerprint);
+
+    // Keeps the builds other jobs recorded since this one loaded the cache
+    update(
+        [&]()
+        {
+            m_files = std::move(current);
+            m_savedAt = currentFileTime();
+        });
+
+    result.value = fingerprint;
+    result.rehashed = rehashed;
+    result.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool BuildFingerprints::isUpToDate(const std::string& key, uint64_t fingerprint, const ArtifactTarget& target) const
+{
+    auto it = m_builds.find(key);
+    if (it == m_builds.end() || it->second != fingerprint)
+        return false;
+
+    // Outputs removed by a clean or by hand need a real build whatever the inputs say
+    auto outputs = collectOutputs(m_projectDir, target);
+    return !outputs.empty() && std::all_of(outputs.begin(), outputs.end(),
+                                           [this](const std::string& output)
+                                           {
+                                               std::error_code ec;
+                                               return std::filesystem::exists(m_projectDir / output, ec);
+                                           });
+}
+
+void BuildFingerprints::recordSuccess(const std::string& key, uint64_t fingerprint)
+{
+    update([&]() { m_builds[key] = fingerprint; });
+}
+
+} // namespace unreal
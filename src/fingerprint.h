@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace unreal
+{
+struct ArtifactTarget;
+
+struct FingerprintResult
+{
+    uint64_t value = 0;
+    size_t files = 0;
+    // Files whose content had to be read because their stat data changed
+    size_t rehashed = 0;
+    double durationMs = 0.0;
+};
+
+// Fingerprints the inputs of a project build: the .uproject, Source/, Config/, plugin descriptors and
+// sources, and the engine build version. File hashes are cached by size/mtime/inode in the project's
+// Intermediate folder, so an unchanged project only costs a stat per file.
+class BuildFingerprints
+{
+  public:
+    explicit BuildFingerprints(const std::filesystem::path& uprojectPath);
+
+    FingerprintResult compute(const std::filesystem::path& enginePath);
+
+    // True when the last successful build for key had this fingerprint and the target receipt and every build
+    // product it lists still exist
+    bool isUpToDate(const std::string& key, uint64_t fingerprint, const ArtifactTarget& target) const;
+    void recordSuccess(const std::string& key, uint64_t fingerprint);
+
+    static std::string makeKey(const std::string& target, const std::string& platform, const std::string& config,
+                               const std::filesystem::path& enginePath);
+
+  private:
+    struct FileStamp
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t inode = 0;
+        uint64_t hash = 0;
+    };
+
+    void load();
+    void save() const;
+    // Re-reads the cache, applies change and writes it back, serialized with every other BuildFingerprints of the
+    // process so concurrent builds of a project keep each other's records
+    void update(const std::function<void()>& change);
+
+    std::filesystem::path m_uprojectPath;
+    std::filesystem::path m_projectDir;
+    std::filesystem::path m_cachePath;
+    std::unordered_map<std::string, FileStamp> m_files;
+    std::map<std::string, uint64_t> m_builds;
+    int64_t m_savedAt = 0;
+    bool m_loaded = false;
+};
+
+} // namespace unreal
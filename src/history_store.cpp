@@ -0,0 +1,76 @@
+#include "history_store.h"
+#include "config.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+namespace unreal
+{
+
+std::string sanitizeFileName(const std::string& name)
+{
+    std::string result;
+    result.reserve(name.size());
+    for (char c : name)
+    {
+        result += std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' ? c : '_';
+    }
+    return result;
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+JsonLinesStore::JsonLinesStore(std::filesystem::path folder) : m_folder(std::move(folder))
+{
+}
+
+std::filesystem::path JsonLinesStore::getPath(const std::string& project) const
+{
+    return Config::instance().getHistoryDirectory() / m_folder / (sanitizeFileName(project) + ".jsonl");
+}
+
+bool JsonLinesStore::append(const std::string& project, const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto path = getPath(project);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::ofstream file(path, std::ios::app | std::ios::binary);
+    if (!file.is_open())
+    {
+        spdlog::warn("Failed to open history {}", path.string());
+        return false;
+    }
+    file << line + "\n";
+    file.flush();
+    m_revision++;
+    return true;
+}
+
+void JsonLinesStore::load(const std::string& project, const std::function<void(const std::string&)>& parse) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ifstream file(getPath(project));
+    std::string line;
+    while (std::getline(file, line))
+    {
+        try
+        {
+            parse(line);
+        }
+        catch (const std::exception&)
+        {
+            // Torn or hand-edited line
+        }
+    }
+}
+
+} // namespace unreal
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+// Letters, digits, '-' and '_' kept, anything else replaced by '_', so a project name is a file name everywhere
+std::string sanitizeFileName(const std::string& name);
+
+// Upper median, 0 without values
+double median(std::vector<double> values);
+
+// Append-only JSON lines files, one per project, in a folder of the history directory next to the executable.
+// Every record is appended in a single write, so a crash can at worst leave a torn last line that load skips.
+class JsonLinesStore
+{
+  public:
+    // Relative to the history directory, empty for the directory itself
+    explicit JsonLinesStore(std::filesystem::path folder);
+
+    bool append(const std::string& project, const std::string& line);
+    // Calls parse with every line of the project, oldest first; lines it throws on are skipped
+    void load(const std::string& project, const std::function<void(const std::string&)>& parse) const;
+
+    // Incremented on every append, lets views reload only when something changed
+    uint64_t getRevision() const
+    {
+        return m_revision;
+    }
+
+    std::filesystem::path getPath(const std::string& project) const;
+
+  private:
+    std::filesystem::path m_folder;
+    std::atomic<uint64_t> m_revision{0};
+    mutable std::mutex m_mutex;
+};
+
+} // namespace unreal
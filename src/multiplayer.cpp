@@ -0,0 +1,92 @@
+#include "multiplayer.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace unreal
+{
+
+std::vector<std::vector<int>> partitionCores(const std::vector<std::vector<int>>& cores, size_t count)
+{
+    std::vector<std::vector<int>> sets(count);
+    if (count == 0 || cores.empty())
+        return sets;
+
+    if (cores.size() < count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            sets[i] = cores[i % cores.size()];
+        }
+        return sets;
+    }
+
+    size_t share = cores.size() / count;
+    size_t leftover = cores.size() % count;
+    size_t next = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t take = share + (i == 0 ? leftover : 0);
+        for (size_t j = 0; j < take; ++j, ++next)
+        {
+            sets[i].insert(sets[i].end(), cores[next].begin(), cores[next].end());
+        }
+    }
+    return sets;
+}
+
+std::string readDefaultMap(const std::filesystem::path& uprojectPath)
+{
+    std::ifstream file(uprojectPath.parent_path() / "Config" / "DefaultEngine.ini");
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.rfind("GameDefaultMap=", 0) != 0)
+            continue;
+        // "/Game/Maps/Main.Main" -> "/Game/Maps/Main"
+        auto map = line.substr(15);
+        while (!map.empty() && (map.back() == '\r' || map.back() == ' '))
+            map.pop_back();
+        auto dot = map.find('.', map.rfind('/') == std::string::npos ? 0 : map.rfind('/'));
+        return dot == std::string::npos ? map : map.substr(0, dot);
+    }
+    return {};
+}
+
+std::vector<MultiplayerInstance> planMultiplayerLaunch(const MultiplayerProfile& profile, const std::string& project,
+                                                       const std::string& map,
+                                                       const std::vector<std::vector<int>>& cores)
+{
+    size_t count = profile.clients + 1;
+    auto cpuSets = profile.pinCpus ? partitionCores(cores, count) : std::vector<std::vector<int>>(count);
+    // Windows tiled in a grid about as wide as it is tall
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+
+    std::vector<MultiplayerInstance> instances;
+    for (size_t i = 0; i < count; ++i)
+    {
+        MultiplayerInstance instance;
+        instance.label = i == 0 ? "Server" : "Client " + std::to_string(i);
+        instance.cpus = std::move(cpuSets[i]);
+
+        std::string logName = project + "_" + (i == 0 ? "Server" : "Client" + std::to_string(i)) + ".log";
+        auto x = static_cast<int>(i % columns) * profile.windowWidth;
+        auto y = static_cast<int>(i / columns) * profile.windowHeight;
+
+        if (i == 0)
+            instance.arguments = "\"" + map + "?listen\" -game -port=" + std::to_string(profile.port);
+        else
+            instance.arguments = "127.0.0.1:" + std::to_string(profile.port) + " -game";
+        instance.arguments += " -log LOG=" + logName + " -windowed -ResX=" + std::to_string(profile.windowWidth) +
+                              " -ResY=" + std::to_string(profile.windowHeight) + " -WinX=" + std::to_string(x) +
+                              " -WinY=" + std::to_string(y);
+
+        const auto& extra = i == 0 ? profile.serverArgs : profile.clientArgs;
+        if (!extra.empty())
+            instance.arguments += " " + extra;
+        instances.push_back(std::move(instance));
+    }
+    return instances;
+}
+
+} // namespace unreal
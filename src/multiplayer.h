@@ -0,0 +1,48 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+// A listen server and its clients started as -game instances of the editor binary on this machine
+struct MultiplayerProfile
+{
+    unsigned clients = 2;
+    // Map the server hosts, empty for the project's GameDefaultMap
+    std::string map;
+    int port = 7777;
+    // Size of every game window, tiled from the top left of the screen
+    int windowWidth = 960;
+    int windowHeight = 540;
+    std::string serverArgs;
+    std::string clientArgs;
+    // An instance starts once the previous one finished initializing, or after this many seconds
+    unsigned staggerSeconds = 60;
+    // Pin every instance to its own physical cores
+    bool pinCpus = true;
+};
+
+struct MultiplayerInstance
+{
+    // "Server", "Client 1", ...
+    std::string label;
+    std::string arguments;
+    std::vector<int> cpus;
+};
+
+// Splits the physical cores into count disjoint sets, the first one gets the leftover cores. With fewer cores than
+// instances every instance gets a single core and some of them share it.
+std::vector<std::vector<int>> partitionCores(const std::vector<std::vector<int>>& cores, size_t count);
+
+// GameDefaultMap of Config/DefaultEngine.ini, empty when the project does not set one
+std::string readDefaultMap(const std::filesystem::path& uprojectPath);
+
+// Arguments and CPU sets of the server followed by the clients
+std::vector<MultiplayerInstance> planMultiplayerLaunch(const MultiplayerProfile& profile, const std::string& project,
+                                                       const std::string& map,
+                                                       const std::vector<std::vector<int>>& cores);
+
+} // namespace unreal
@@ -0,0 +1,331 @@
+#include "package_diff.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <unordered_set>
+
+namespace unreal
+{
+
+namespace
+{
+constexpr int kManifestVersion = 1;
+
+// FastCDC style gear hash: cut where the top 16 bits are zero, ~64 KB chunks between 16 KB and 256 KB
+constexpr size_t kMinChunk = 16 * 1024;
+constexpr size_t kMaxChunk = 256 * 1024;
+constexpr uint64_t kCutMask = 0xFFFFull << 48;
+// Big files are chunked in segments on several threads. Boundaries restart at each segment, which costs at most
+// a chunk or two of false changes per segment after an insertion.
+constexpr size_t kSegmentSize = 64ull << 20;
+
+const std::array<uint64_t, 256> kGear = []
+{
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x5A17C0DEu;
+    for (auto& value : table)
+    {
+        // splitmix64, fixed seed so manifests stay comparable across runs
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}();
+
+void chunkRange(const unsigned char* data, size_t size, std::vector<PackageChunk>& chunks)
+{
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t remaining = size - offset;
+        size_t length = std::min(remaining, kMaxChunk);
+        if (remaining > kMinChunk)
+        {
+            uint64_t hash = 0;
+            for (size_t i = kMinChunk; i < length; ++i)
+            {
+                hash = (hash << 1) + kGear[data[offset + i]];
+                if ((hash & kCutMask) == 0)
+                {
+                    length = i + 1;
+                    break;
+                }
+            }
+        }
+        chunks.push_back({hashBytes(data + offset, length), static_cast<uint32_t>(length)});
+        offset += length;
+    }
+}
+
+uint64_t hashChunks(const std::vector<PackageChunk>& chunks)
+{
+    std::vector<uint64_t> hashes;
+    hashes.reserve(chunks.size());
+    for (const auto& chunk : chunks)
+    {
+        hashes.push_back(chunk.hash);
+    }
+    return hashBytes(hashes.data(), hashes.size() * sizeof(uint64_t));
+}
+} // namespace
+
+PackageManifest PackageManifest::scan(const std::filesystem::path& root, const PackageManifest& previous)
+{
+    TRACE_SCOPE("Package manifest", "operations", root.string());
+    PackageManifest manifest;
+
+    std::vector<std::pair<std::string, uint64_t>> files;
+    std::vector<int64_t> mtimes;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(root, ec), end;
+    for (; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        auto path = it->path().lexically_relative(root).generic_string();
+        auto size = it->file_size(ec);
+        auto mtime = static_cast<int64_t>(it->last_write_time(ec).time_since_epoch().count());
+
+        auto known = previous.m_files.find(path);
+        if (known != previous.m_files.end() && known->second.mtime != 0 && known->second.mtime == mtime &&
+            known->second.size == size)
+        {
+            manifest.m_files.emplace(std::move(path), known->second);
+            continue;
+        }
+        files.emplace_back(std::move(path), size);
+        mtimes.push_back(mtime);
+    }
+
+    std::vector<PackageFile> entries(files.size());
+    std::vector<size_t> largeFiles;
+    std::vector<size_t> smallFiles;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        entries[i].mtime = mtimes[i];
+        (files[i].second > kSegmentSize ? largeFiles : smallFiles).push_back(i);
+    }
+
+    // Small files are spread over the workers whole, large ones are split in segments so a single 4 GB pak
+    // does not hash on one core
+    parallelFor(smallFiles.size(),
+                [&](size_t i)
+                {
+                    size_t index = smallFiles[i];
+                    auto& entry = entries[index];
+                    MappedFile file;
+                    if (file.open(root / files[index].first))
+                    {
+                        entry.size = file.size();
+                        chunkRange(file.data(), file.size(), entry.chunks);
+                    }
+                });
+
+    for (size_t index : largeFiles)
+    {
+        auto& entry = entries[index];
+        MappedFile file;
+        if (!file.open(root / files[index].first))
+            continue;
+
+        entry.size = file.size();
+        size_t segments = (file.size() + kSegmentSize - 1) / kSegmentSize;
+        std::vector<std::vector<PackageChunk>> segmentChunks(segments);
+        parallelFor(segments,
+                    [&](size_t segment)
+                    {
+                        size_t offset = segment * kSegmentSize;
+                        size_t length = std::min(kSegmentSize, file.size() - offset);
+                        chunkRange(file.data() + offset, length, segmentChunks[segment]);
+                    });
+        for (auto& chunks : segmentChunks)
+        {
+            entry.chunks.insert(entry.chunks.end(), chunks.begin(), chunks.end());
+        }
+    }
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        entries[i].hash = hashChunks(entries[i].chunks);
+        manifest.m_files.emplace(files[i].first, std::move(entries[i]));
+    }
+    return manifest;
+}
+
+bool PackageManifest::load(const std::filesystem::path& path)
+{
+    m_files.clear();
+    try
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+            return false;
+
+        nlohmann::json json;
+        file >> json;
+        if (json.value("version", 0) != kManifestVersion)
+            return false;
+
+        for (const auto& [name, item] : json["files"].items())
+        {
+            PackageFile entry;
+            entry.size = item["size"].get<uint64_t>();
+            entry.hash = item["hash"].get<uint64_t>();
+            entry.mtime = item.value("mtime", int64_t(0));
+            for (const auto& chunk : item["chunks"])
+            {
+                entry.chunks.push_back({chunk[0].get<uint64_t>(), chunk[1].get<uint32_t>()});
+            }
+            m_files.emplace(name, std::move(entry));
+        }
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        // Without a baseline the next package reports every file as added
+        spdlog::warn("Ignoring package manifest {}: {}", path.string(), e.what());
+        m_files.clear();
+        return false;
+    }
+}
+
+bool PackageManifest::save(const std::filesystem::path& path) const
+{
+    nlohmann::json json;
+    json["version"] = kManifestVersion;
+
+    auto& files = json["files"] = nlohmann::json::object();
+    for (const auto& [name, entry] : m_files)
+    {
+        auto chunks = nlohmann::json::array();
+        for (const auto& chunk : entry.chunks)
+        {
+            chunks.push_back({chunk.hash, chunk.size});
+        }
+        files[name] = {
+            {"size", entry.size}, {"mtime", entry.mtime}, {"hash", entry.hash}, {"chunks", std::move(chunks)}};
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    return writeFileAtomic(path, json.dump());
+}
+
+uint64_t PackageManifest::getTotalBytes() const
+{
+    uint64_t total = 0;
+    for (const auto& [name, entry] : m_files)
+    {
+        total += entry.size;
+    }
+    return total;
+}
+
+std::filesystem::path PackageManifest::getPath(const std::filesystem::path& uprojectPath,
+                                               const std::string& platform)
+{
+    return uprojectPath.parent_path() / "Intermediate" / "ImUnrealLauncher" / ("package-" + platform + ".json");
+}
+
+PackageDiff diffPackages(const PackageManifest& before, const PackageManifest& after)
+{
+    PackageDiff diff;
+
+    // Chunks are matched against the whole previous archive, content that moved between paks is not a change
+    std::unordered_set<uint64_t> known;
+    for (const auto& [name, entry] : before.getFiles())
+    {
+        for (const auto& chunk : entry.chunks)
+        {
+            known.insert(chunk.hash);
+        }
+    }
+
+    for (const auto& [name, entry] : after.getFiles())
+    {
+        diff.totalBytes += entry.size;
+
+        auto previous = before.getFiles().find(name);
+        bool existed = previous != before.getFiles().end();
+        if (existed && previous->second.size == entry.size && previous->second.hash == entry.hash)
+        {
+            diff.unchangedFiles++;
+            continue;
+        }
+
+        PackageFileDiff file;
+        file.path = name;
+        file.change = existed ? PackageChange::Modified : PackageChange::Added;
+        file.size = entry.size;
+        file.totalChunks = entry.chunks.size();
+        for (const auto& chunk : entry.chunks)
+        {
+            if (known.count(chunk.hash) == 0)
+            {
+                file.changedBytes += chunk.size;
+                file.changedChunks++;
+            }
+        }
+        diff.changedBytes += file.changedBytes;
+        diff.files.push_back(std::move(file));
+    }
+
+    for (const auto& [name, entry] : before.getFiles())
+    {
+        if (after.getFiles().count(name) == 0)
+        {
+            PackageFileDiff file;
+            file.path = name;
+            file.change = PackageChange::Removed;
+            file.size = entry.size;
+            file.totalChunks = entry.chunks.size();
+            diff.files.push_back(std::move(file));
+        }
+    }
+
+    std::sort(diff.files.begin(), diff.files.end(),
+              [](const PackageFileDiff& a, const PackageFileDiff& b)
+              {
+                  if (a.changedBytes != b.changedBytes)
+                      return a.changedBytes > b.changedBytes;
+                  return a.path < b.path;
+              });
+    return diff;
+}
+
+std::string PackageDiff::describe() const
+{
+    size_t added = 0;
+    size_t removed = 0;
+    for (const auto& file : files)
+    {
+        added += file.change == PackageChange::Added;
+        removed += file.change == PackageChange::Removed;
+    }
+    size_t modified = files.size() - added - removed;
+    return std::to_string(modified) + " modified, " + std::to_string(added) + " added, " + std::to_string(removed) +
+           " removed, " + std::to_string(unchangedFiles) + " unchanged; " + formatBytes(changedBytes) + " of " +
+           formatBytes(totalBytes) + " is new content";
+}
+
+std::string packageChangeToString(PackageChange change)
+{
+    switch (change)
+    {
+        case PackageChange::Added:
+            return "added";
+        case PackageChange::Modified:
+            return "modified";
+        case PackageChange::Removed:
+            return "removed";
+    }
+    return "modified";
+}
+
+} // namespace unreal
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+struct PackageChunk
+{
+    uint64_t hash = 0;
+    uint32_t size = 0;
+};
+
+struct PackageFile
+{
+    uint64_t size = 0;
+    // Last write time in ticks of the filesystem clock, 0 when unknown
+    int64_t mtime = 0;
+    // Hash of the chunk hashes, equal files compare without looking at their chunks
+    uint64_t hash = 0;
+    std::vector<PackageChunk> chunks;
+};
+
+// Content-defined chunks of every file of an archived package. Chunk boundaries follow the content, so an
+// edit inside a pak only changes the chunks around it instead of every offset after it.
+class PackageManifest
+{
+  public:
+    // Chunks every file under root, files are split into segments that are hashed in parallel. Files whose size and
+    // mtime match their entry in previous are taken from it without being read.
+    static PackageManifest scan(const std::filesystem::path& root, const PackageManifest& previous = {});
+
+    bool load(const std::filesystem::path& path);
+    bool save(const std::filesystem::path& path) const;
+
+    bool isEmpty() const
+    {
+        return m_files.empty();
+    }
+    const std::map<std::string, PackageFile>& getFiles() const
+    {
+        return m_files;
+    }
+    uint64_t getTotalBytes() const;
+
+    // Where the manifest of the last archive of a platform is kept
+    static std::filesystem::path getPath(const std::filesystem::path& uprojectPath, const std::string& platform);
+
+  private:
+    std::map<std::string, PackageFile> m_files;
+};
+
+enum class PackageChange
+{
+    Added,
+    Modified,
+    Removed
+};
+
+struct PackageFileDiff
+{
+    std::string path;
+    PackageChange change = PackageChange::Modified;
+    uint64_t size = 0;
+    // Bytes in chunks that the previous archive did not contain anywhere, what an upload would have to send
+    uint64_t changedBytes = 0;
+    size_t changedChunks = 0;
+    size_t totalChunks = 0;
+};
+
+struct PackageDiff
+{
+    // Largest change first
+    std::vector<PackageFileDiff> files;
+    size_t unchangedFiles = 0;
+    uint64_t totalBytes = 0;
+    uint64_t changedBytes = 0;
+
+    std::string describe() const;
+};
+
+PackageDiff diffPackages(const PackageManifest& before, const PackageManifest& after);
+std::string packageChangeToString(PackageChange change);
+
+} // namespace unreal
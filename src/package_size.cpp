@@ -0,0 +1,637 @@
+#include "package_size.h"
+#include "config.h"
+#include "history_store.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace unreal
+{
+
+namespace
+{
+constexpr uint32_t kPakMagic = 0x5A6F12E1;
+// Index split into an encoded entry blob, a path hash index and a full directory index (UE 4.26+)
+constexpr uint32_t kPakVersionPathHashIndex = 10;
+constexpr uint32_t kPakVersionIndexEncryption = 4;
+constexpr uint32_t kPakVersionCompressionEncryption = 3;
+// The footer is at most ~230 bytes, the rest of the tail covers versions that grow it
+constexpr size_t kFooterSearchSize = 512;
+constexpr size_t kMaxRetainedIndexes = 20;
+
+// Little endian reader over an in memory buffer, any read past the end marks it failed
+class ByteReader
+{
+  public:
+    ByteReader(const char* data, size_t size) : m_data(data), m_size(size)
+    {
+    }
+
+    template <typename T> T read()
+    {
+        T value{};
+        if (m_position + sizeof(T) > m_size)
+        {
+            m_ok = false;
+            return value;
+        }
+        memcpy(&value, m_data + m_position, sizeof(T));
+        m_position += sizeof(T);
+        return value;
+    }
+
+    void skip(size_t count)
+    {
+        if (m_position + count > m_size)
+            m_ok = false;
+        m_position = std::min(m_position + count, m_size);
+    }
+
+    // FString: int32 length including the terminator, negative for UTF-16
+    std::string readString()
+    {
+        auto length = read<int32_t>();
+        if (length == 0 || !m_ok)
+            return {};
+        if (length > 0)
+        {
+            size_t count = static_cast<size_t>(length);
+            if (m_position + count > m_size)
+            {
+                m_ok = false;
+                return {};
+            }
+            std::string value(m_data + m_position, count - 1);
+            m_position += count;
+            return value;
+        }
+
+        size_t count = static_cast<size_t>(-static_cast<int64_t>(length));
+        if (m_position + count * 2 > m_size)
+        {
+            m_ok = false;
+            return {};
+        }
+        std::string value;
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            uint16_t c;
+            memcpy(&c, m_data + m_position + i * 2, 2);
+            // Asset paths are ASCII in practice, anything else is kept as UTF-8 without surrogate pairs
+            if (c < 0x80)
+            {
+                value += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                value += static_cast<char>(0xC0 | (c >> 6));
+                value += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                value += static_cast<char>(0xE0 | (c >> 12));
+                value += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                value += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        m_position += count * 2;
+        return value;
+    }
+
+    bool ok() const
+    {
+        return m_ok;
+    }
+    const char* current() const
+    {
+        return m_data + m_position;
+    }
+
+  private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+    bool m_ok = true;
+};
+
+struct PakFooter
+{
+    uint32_t version = 0;
+    uint64_t indexOffset = 0;
+    uint64_t indexSize = 0;
+    bool encryptedIndex = false;
+};
+
+std::string getType(const std::string& path)
+{
+    auto slash = path.find_last_of('/');
+    auto dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return "(none)";
+    std::string type = path.substr(dot + 1);
+    std::transform(type.begin(), type.end(), type.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return type;
+}
+
+bool readAt(std::ifstream& file, uint64_t offset, uint64_t size, std::vector<char>& buffer)
+{
+    buffer.resize(static_cast<size_t>(size));
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(buffer.data(), static_cast<std::streamsize>(size));
+    return file.good();
+}
+
+bool readFooter(std::ifstream& file, uint64_t fileSize, PakFooter& footer)
+{
+    std::vector<char> tail;
+    uint64_t tailSize = std::min<uint64_t>(fileSize, kFooterSearchSize);
+    if (tailSize < 44 || !readAt(file, fileSize - tailSize, tailSize, tail))
+        return false;
+
+    // The magic is followed by the version, the index offset and size and the index hash. Encryption key guid,
+    // encrypted flag and compression method names around it depend on the version, so search from the end.
+    for (size_t position = tail.size() - 44 + 1; position-- > 0;)
+    {
+        ByteReader reader(tail.data() + position, tail.size() - position);
+        if (reader.read<uint32_t>() != kPakMagic)
+            continue;
+        footer.version = reader.read<uint32_t>();
+        footer.indexOffset = reader.read<uint64_t>();
+        footer.indexSize = reader.read<uint64_t>();
+        if (footer.version == 0 || footer.version > 32 || footer.indexSize == 0 ||
+            footer.indexOffset + footer.indexSize > fileSize)
+            continue;
+        footer.encryptedIndex = footer.version >= kPakVersionIndexEncryption && position > 0 && tail[position - 1];
+        return true;
+    }
+    return false;
+}
+
+// FPakEntry as serialized in the legacy index and the non-encodable entries of the path hash index
+bool readEntry(ByteReader& reader, uint32_t version, uint64_t& size, uint64_t& uncompressedSize)
+{
+    reader.read<int64_t>();
+    size = static_cast<uint64_t>(reader.read<int64_t>());
+    uncompressedSize = static_cast<uint64_t>(reader.read<int64_t>());
+    uint32_t method = reader.read<uint32_t>();
+    if (version <= 1)
+        reader.read<int64_t>();
+    reader.skip(20);
+    if (version >= kPakVersionCompressionEncryption)
+    {
+        if (method != 0)
+        {
+            auto blocks = reader.read<int32_t>();
+            reader.skip(static_cast<size_t>(std::max(blocks, 0)) * 16);
+        }
+        reader.read<uint8_t>();
+        reader.read<uint32_t>();
+    }
+    return reader.ok();
+}
+
+// Bit packed entry of the encoded entry blob, see FPakFile::DecodePakEntry
+bool decodeEntry(const char* data, size_t size, size_t offset, uint64_t& compressedSize, uint64_t& uncompressedSize)
+{
+    if (offset >= size)
+        return false;
+    ByteReader reader(data + offset, size - offset);
+    auto value = reader.read<uint32_t>();
+    if ((value & 0x3F) == 0x3F)
+        reader.read<uint32_t>();
+    // Offset, 32 bit when bit 31 is set
+    reader.skip(value & (1u << 31) ? 4 : 8);
+    uncompressedSize = value & (1u << 30) ? reader.read<uint32_t>() : reader.read<uint64_t>();
+    uint32_t method = (value >> 23) & 0x3F;
+    if (method != 0)
+        compressedSize = value & (1u << 29) ? reader.read<uint32_t>() : reader.read<uint64_t>();
+    else
+        compressedSize = uncompressedSize;
+    return reader.ok();
+}
+
+std::string stripMountPoint(std::string mount)
+{
+    while (mount.rfind("../", 0) == 0)
+        mount.erase(0, 3);
+    if (!mount.empty() && mount.front() == '/')
+        mount.erase(0, 1);
+    return mount;
+}
+
+bool readPakEntries(const std::filesystem::path& path, uint64_t fileSize, const std::string& prefix,
+                    std::vector<PackageSizeItem>& entries)
+{
+    std::ifstream file(path, std::ios::binary);
+    PakFooter footer;
+    if (!file.is_open() || !readFooter(file, fileSize, footer) || footer.encryptedIndex)
+        return false;
+
+    std::vector<char> index;
+    if (!readAt(file, footer.indexOffset, footer.indexSize, index))
+        return false;
+    ByteReader reader(index.data(), index.size());
+    auto mount = stripMountPoint(reader.readString());
+    auto count = reader.read<int32_t>();
+
+    auto add = [&](const std::string& name, uint64_t size, uint64_t uncompressedSize)
+    {
+        PackageSizeItem item;
+        item.path = prefix + "/" + mount + name;
+        item.type = getType(name);
+        item.size = size;
+        item.uncompressedSize = uncompressedSize;
+        entries.push_back(std::move(item));
+    };
+
+    if (footer.version < kPakVersionPathHashIndex)
+    {
+        for (int32_t i = 0; i < count && reader.ok(); ++i)
+        {
+            auto name = reader.readString();
+            uint64_t size = 0;
+            uint64_t uncompressedSize = 0;
+            if (readEntry(reader, footer.version, size, uncompressedSize))
+                add(name, size, uncompressedSize);
+        }
+        return reader.ok();
+    }
+
+    reader.read<uint64_t>();
+    uint64_t hashIndexOffset = 0;
+    uint64_t hashIndexSize = 0;
+    bool hasHashIndex = reader.read<uint32_t>() != 0;
+    if (hasHashIndex)
+    {
+        hashIndexOffset = reader.read<uint64_t>();
+        hashIndexSize = reader.read<uint64_t>();
+        reader.skip(20);
+    }
+    uint64_t directoryIndexOffset = 0;
+    uint64_t directoryIndexSize = 0;
+    bool hasDirectoryIndex = reader.read<uint32_t>() != 0;
+    if (hasDirectoryIndex)
+    {
+        directoryIndexOffset = reader.read<uint64_t>();
+        directoryIndexSize = reader.read<uint64_t>();
+        reader.skip(20);
+    }
+
+    auto encodedSize = static_cast<size_t>(std::max(reader.read<int32_t>(), 0));
+    const char* encoded = reader.current();
+    reader.skip(encodedSize);
+
+    std::vector<std::pair<uint64_t, uint64_t>> unencoded(static_cast<size_t>(std::max(reader.read<int32_t>(), 0)));
+    for (auto& [size, uncompressedSize] : unencoded)
+    {
+        if (!readEntry(reader, footer.version, size, uncompressedSize))
+            return false;
+    }
+    if (!reader.ok())
+        return false;
+
+    // Locations are offsets into the encoded blob, or -(index + 1) into the unencoded entries
+    auto lookup = [&](int32_t location, uint64_t& size, uint64_t& uncompressedSize)
+    {
+        if (location >= 0)
+            return decodeEntry(encoded, encodedSize, static_cast<size_t>(location), size, uncompressedSize);
+        size_t slot = static_cast<size_t>(-(static_cast<int64_t>(location) + 1));
+        if (slot >= unencoded.size())
+            return false;
+        size = unencoded[slot].first;
+        uncompressedSize = unencoded[slot].second;
+        return true;
+    };
+
+    std::vector<char> table;
+    uint64_t size = 0;
+    uint64_t uncompressedSize = 0;
+    if (hasDirectoryIndex && directoryIndexOffset + directoryIndexSize <= fileSize &&
+        readAt(file, directoryIndexOffset, directoryIndexSize, table))
+    {
+        ByteReader directories(table.data(), table.size());
+        auto directoryCount = directories.read<int32_t>();
+        for (int32_t i = 0; i < directoryCount && directories.ok(); ++i)
+        {
+            auto directory = directories.readString();
+            if (directory == "/")
+                directory.clear();
+            auto fileCount = directories.read<int32_t>();
+            for (int32_t j = 0; j < fileCount && directories.ok(); ++j)
+            {
+                auto name = directories.readString();
+                auto location = directories.read<int32_t>();
+                if (directories.ok() && lookup(location, size, uncompressedSize))
+                    add(directory + name, size, uncompressedSize);
+            }
+        }
+        return directories.ok();
+    }
+
+    // Pruned directory index, only path hashes are left
+    if (hasHashIndex && hashIndexOffset + hashIndexSize <= fileSize &&
+        readAt(file, hashIndexOffset, hashIndexSize, table))
+    {
+        ByteReader hashes(table.data(), table.size());
+        auto hashCount = hashes.read<int32_t>();
+        for (int32_t i = 0; i < hashCount && hashes.ok(); ++i)
+        {
+            auto hash = hashes.read<uint64_t>();
+            auto location = hashes.read<int32_t>();
+            char name[24];
+            snprintf(name, sizeof(name), "#%016llx", static_cast<unsigned long long>(hash));
+            if (hashes.ok() && lookup(location, size, uncompressedSize))
+                add(name, size, uncompressedSize);
+        }
+        return hashes.ok();
+    }
+    return false;
+}
+
+// Every asset of the package: pak entries, plus the files that are not a pak with a readable index
+std::unordered_map<std::string, uint64_t> collectAssets(const PackageSizeIndex& index)
+{
+    std::unordered_set<std::string> opaque(index.opaquePaks.begin(), index.opaquePaks.end());
+    std::unordered_map<std::string, uint64_t> assets;
+    for (const auto& file : index.files)
+    {
+        if (file.type != "pak" || opaque.count(file.path))
+            assets[file.path] = file.size;
+    }
+    for (const auto& entry : index.pakEntries)
+    {
+        assets[entry.path] = entry.size;
+    }
+    return assets;
+}
+
+// Saved indexes of a platform, newest first
+std::vector<std::pair<int64_t, std::filesystem::path>> listIndexes(const std::filesystem::path& directory)
+{
+    std::vector<std::pair<int64_t, std::filesystem::path>> saved;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        auto stem = entry.path().stem().string();
+        if (entry.path().extension() == ".json" && !stem.empty() &&
+            std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isdigit(c); }))
+            saved.emplace_back(std::stoll(stem), entry.path());
+    }
+    std::sort(saved.begin(), saved.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    return saved;
+}
+
+} // namespace
+
+PackageSizeIndex indexPackageSizes(const std::filesystem::path& archiveDir)
+{
+    TRACE_SCOPE("Index package sizes", "operations", archiveDir.string());
+    PackageSizeIndex index;
+    index.timestamp =
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(archiveDir, ec), end;
+    for (; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        PackageSizeItem item;
+        item.path = it->path().lexically_relative(archiveDir).generic_string();
+        item.type = getType(item.path);
+        item.size = it->file_size(ec);
+        item.uncompressedSize = item.size;
+        index.files.push_back(std::move(item));
+    }
+    std::sort(index.files.begin(), index.files.end(),
+              [](const PackageSizeItem& a, const PackageSizeItem& b) { return a.path < b.path; });
+
+    // Pak indexes are read in parallel, each into its own list
+    std::vector<std::vector<PackageSizeItem>> entries(index.files.size());
+    std::vector<char> parsed(index.files.size(), 0);
+    parallelFor(index.files.size(),
+                [&](size_t i)
+                {
+                    const auto& file = index.files[i];
+                    if (file.type == "pak")
+                        parsed[i] = readPakEntries(archiveDir / file.path, file.size, file.path, entries[i]);
+                });
+
+    for (size_t i = 0; i < index.files.size(); ++i)
+    {
+        const auto& file = index.files[i];
+        index.totalBytes += file.size;
+        if (file.type == "pak" && !parsed[i])
+            index.opaquePaks.push_back(file.path);
+        if (file.type != "pak" || !parsed[i])
+            index.typeTotals[file.type] += file.size;
+        for (auto& entry : entries[i])
+        {
+            index.typeTotals[entry.type] += entry.size;
+            index.pakEntries.push_back(std::move(entry));
+        }
+    }
+    return index;
+}
+
+PackageSizeReport comparePackageSizes(const PackageSizeIndex* previous, const PackageSizeIndex& current,
+                                      const PackageBudget& budget, size_t maxGrowers)
+{
+    PackageSizeReport report;
+    report.hasPrevious = previous != nullptr;
+    report.totalBefore = previous ? previous->totalBytes : 0;
+    report.totalAfter = current.totalBytes;
+
+    auto after = collectAssets(current);
+    std::unordered_map<std::string, uint64_t> before;
+    if (previous)
+        before = collectAssets(*previous);
+    for (const auto& [path, size] : after)
+    {
+        auto old = before.find(path);
+        uint64_t oldSize = old != before.end() ? old->second : 0;
+        if (size > oldSize)
+            report.growers.push_back({path, oldSize, size});
+    }
+    std::sort(report.growers.begin(), report.growers.end(),
+              [](const PackageSizeChange& a, const PackageSizeChange& b)
+              {
+                  if (a.getDelta() != b.getDelta())
+                      return a.getDelta() > b.getDelta();
+                  return a.subject < b.subject;
+              });
+    if (report.growers.size() > maxGrowers)
+        report.growers.resize(maxGrowers);
+
+    std::map<std::string, PackageSizeChange> types;
+    for (const auto& [type, size] : current.typeTotals)
+    {
+        types[type].after = size;
+    }
+    if (previous)
+    {
+        for (const auto& [type, size] : previous->typeTotals)
+        {
+            types[type].before = size;
+        }
+    }
+    for (auto& [type, change] : types)
+    {
+        change.subject = type;
+        report.types.push_back(change);
+    }
+    std::sort(report.types.begin(), report.types.end(),
+              [](const PackageSizeChange& a, const PackageSizeChange& b) { return a.after > b.after; });
+
+    if (budget.maxTotalBytes > 0 && current.totalBytes > budget.maxTotalBytes)
+    {
+        report.violations.push_back("Package size " + formatBytes(current.totalBytes) + " exceeds the budget of " +
+                                    formatBytes(budget.maxTotalBytes));
+    }
+    if (budget.maxGrowthBytes > 0 && previous && current.totalBytes > previous->totalBytes + budget.maxGrowthBytes)
+    {
+        report.violations.push_back("Package grew by " + formatBytes(current.totalBytes - previous->totalBytes) +
+                                    ", more than the allowed " + formatBytes(budget.maxGrowthBytes));
+    }
+    for (const auto& [type, limit] : budget.maxTypeBytes)
+    {
+        auto total = current.typeTotals.find(type);
+        if (limit > 0 && total != current.typeTotals.end() && total->second > limit)
+        {
+            report.violations.push_back("." + type + " files take " + formatBytes(total->second) +
+                                        ", over the budget of " + formatBytes(limit));
+        }
+    }
+    return report;
+}
+
+PackageSizeHistory& PackageSizeHistory::instance()
+{
+    static PackageSizeHistory instance;
+    return instance;
+}
+
+std::filesystem::path PackageSizeHistory::getDirectory(const std::string& project, const std::string& platform) const
+{
+    return Config::instance().getHistoryDirectory() / "packages" / sanitizeFileName(project) /
+           sanitizeFileName(platform);
+}
+
+void PackageSizeHistory::save(const std::string& project, const PackageSizeIndex& index)
+{
+    TRACE_SCOPE("Save package size index", "io", project);
+
+    nlohmann::json json;
+    json["time"] = index.timestamp;
+    json["platform"] = index.platform;
+    json["total"] = index.totalBytes;
+    auto& files = json["files"] = nlohmann::json::array();
+    for (const auto& file : index.files)
+    {
+        files.push_back({file.path, file.size});
+    }
+    auto& entries = json["pakEntries"] = nlohmann::json::array();
+    for (const auto& entry : index.pakEntries)
+    {
+        entries.push_back({entry.path, entry.size, entry.uncompressedSize});
+    }
+    json["opaquePaks"] = index.opaquePaks;
+    json["types"] = index.typeTotals;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto directory = getDirectory(project, index.platform);
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (!writeFileAtomic(directory / (std::to_string(index.timestamp) + ".json"), json.dump()))
+    {
+        spdlog::warn("Failed to write package size index to {}", directory.string());
+        return;
+    }
+
+    // Keep the newest indexes only, they can be large for projects with many assets
+    auto saved = listIndexes(directory);
+    for (size_t i = kMaxRetainedIndexes; i < saved.size(); ++i)
+    {
+        std::filesystem::remove(saved[i].second, ec);
+    }
+    m_revision++;
+}
+
+std::vector<std::string> PackageSizeHistory::getPlatforms(const std::string& project) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> platforms;
+    std::error_code ec;
+    auto root = Config::instance().getHistoryDirectory() / "packages" / sanitizeFileName(project);
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec))
+    {
+        if (entry.is_directory(ec))
+            platforms.push_back(entry.path().filename().string());
+    }
+    std::sort(platforms.begin(), platforms.end());
+    return platforms;
+}
+
+std::vector<PackageSizeIndex> PackageSizeHistory::load(const std::string& project, const std::string& platform,
+                                                       size_t count) const
+{
+    TRACE_SCOPE("Load package size indexes", "io", project);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<PackageSizeIndex> indexes;
+    for (const auto& [timestamp, path] : listIndexes(getDirectory(project, platform)))
+    {
+        if (indexes.size() >= count)
+            break;
+        try
+        {
+            std::ifstream file(path);
+            nlohmann::json json;
+            file >> json;
+
+            PackageSizeIndex index;
+            index.timestamp = json.value("time", timestamp);
+            index.platform = json.value("platform", platform);
+            index.totalBytes = json.value("total", uint64_t(0));
+            for (const auto& item : json["files"])
+            {
+                PackageSizeItem file;
+                file.path = item[0].get<std::string>();
+                file.type = getType(file.path);
+                file.size = item[1].get<uint64_t>();
+                file.uncompressedSize = file.size;
+                index.files.push_back(std::move(file));
+            }
+            for (const auto& item : json["pakEntries"])
+            {
+                PackageSizeItem entry;
+                entry.path = item[0].get<std::string>();
+                entry.type = getType(entry.path);
+                entry.size = item[1].get<uint64_t>();
+                entry.uncompressedSize = item[2].get<uint64_t>();
+                index.pakEntries.push_back(std::move(entry));
+            }
+            index.opaquePaks = json.value("opaquePaks", std::vector<std::string>{});
+            index.typeTotals = json.value("types", std::map<std::string, uint64_t>{});
+            indexes.push_back(std::move(index));
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::warn("Skipping package size index {}: {}", path.string(), e.what());
+        }
+    }
+    return indexes;
+}
+
+} // namespace unreal
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "config.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+struct PackageSizeItem
+{
+    // Archive relative path, pak entries are listed as "<pak path>/<entry path>"
+    std::string path;
+    // Lower case extension, "pak" entries count under the type of the asset
+    std::string type;
+    // Bytes on disk, compressed size for pak entries
+    uint64_t size = 0;
+    uint64_t uncompressedSize = 0;
+};
+
+// Sizes of one archived package: every file, the entry table of every .pak and totals per asset type
+struct PackageSizeIndex
+{
+    int64_t timestamp = 0;
+    // "<Platform>-<Configuration>", packages are only compared with the same key
+    std::string platform;
+    uint64_t totalBytes = 0;
+    std::vector<PackageSizeItem> files;
+    std::vector<PackageSizeItem> pakEntries;
+    // Paks whose index could not be read (encrypted or unknown version), counted as a whole
+    std::vector<std::string> opaquePaks;
+    std::map<std::string, uint64_t> typeTotals;
+};
+
+// Reads the archive folder on all cores, parsing the footer and index of each .pak
+PackageSizeIndex indexPackageSizes(const std::filesystem::path& archiveDir);
+
+struct PackageSizeChange
+{
+    std::string subject;
+    uint64_t before = 0;
+    uint64_t after = 0;
+
+    int64_t getDelta() const
+    {
+        return static_cast<int64_t>(after) - static_cast<int64_t>(before);
+    }
+};
+
+struct PackageSizeReport
+{
+    bool hasPrevious = false;
+    uint64_t totalBefore = 0;
+    uint64_t totalAfter = 0;
+    // Assets (pak entries and loose files) that grew the most, largest growth first
+    std::vector<PackageSizeChange> growers;
+    std::vector<PackageSizeChange> types;
+    // Human readable budget violations, the package fails when there is any
+    std::vector<std::string> violations;
+};
+
+PackageSizeReport comparePackageSizes(const PackageSizeIndex* previous, const PackageSizeIndex& current,
+                                      const PackageBudget& budget, size_t maxGrowers = 20);
+
+// Size indexes of past packages, history/packages/<Project>/<Platform>-<Configuration>/<timestamp>.json next to the
+// executable
+class PackageSizeHistory
+{
+  public:
+    static PackageSizeHistory& instance();
+
+    void save(const std::string& project, const PackageSizeIndex& index);
+    // Platform keys that have indexes, "<Platform>-<Configuration>"
+    std::vector<std::string> getPlatforms(const std::string& project) const;
+    // Newest index first, at most count
+    std::vector<PackageSizeIndex> load(const std::string& project, const std::string& platform,
+                                       size_t count = 2) const;
+
+    uint64_t getRevision() const
+    {
+        return m_revision;
+    }
+
+  private:
+    PackageSizeHistory() = default;
+    std::filesystem::path getDirectory(const std::string& project, const std::string& platform) const;
+
+    std::atomic<uint64_t> m_revision{0};
+    mutable std::mutex m_mutex;
+};
+
+} // namespace unreal
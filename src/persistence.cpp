@@ -0,0 +1,161 @@
+#include "persistence.h"
+#include "trace.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace unreal
+{
+
+ConfigPersistence::ConfigPersistence(std::chrono::milliseconds debounce) : m_debounce(debounce)
+{
+    m_thread = std::thread([this]() { writerLoop(); });
+}
+
+ConfigPersistence::~ConfigPersistence()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void ConfigPersistence::track(const std::string& name, RevisionGetter revision, SaveTaskFactory createTask)
+{
+    Source source;
+    source.name = name;
+    source.revision = revision;
+    source.createTask = createTask;
+    source.savedRevision = revision();
+    source.submittedRevision = source.savedRevision;
+    source.seenRevision = source.savedRevision;
+    m_sources.push_back(source);
+}
+
+void ConfigPersistence::applyResults()
+{
+    std::vector<WriteResult> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        results.swap(m_results);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& result : results)
+    {
+        for (auto& source : m_sources)
+        {
+            if (source.name != result.name)
+                continue;
+            if (result.success)
+            {
+                source.savedRevision = result.revision;
+            }
+            else if (source.submittedRevision == result.revision)
+            {
+                // Nothing newer is queued, submit this revision again later
+                source.submittedRevision = source.savedRevision;
+                source.retryAt = now + kRetryDelay;
+            }
+        }
+    }
+}
+
+void ConfigPersistence::update()
+{
+    applyResults();
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto& source : m_sources)
+    {
+        uint64_t revision = source.revision();
+        if (revision != source.seenRevision)
+        {
+            source.seenRevision = revision;
+            source.lastChange = now;
+        }
+        else if (revision != source.submittedRevision && now - source.lastChange >= m_debounce &&
+                 now >= source.retryAt)
+        {
+            submit(source);
+        }
+    }
+}
+
+void ConfigPersistence::flush()
+{
+    applyResults();
+    for (auto& source : m_sources)
+    {
+        source.seenRevision = source.revision();
+        if (source.seenRevision != source.savedRevision)
+        {
+            submit(source);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_queue.empty() && !m_writing; });
+}
+
+void ConfigPersistence::submit(Source& source)
+{
+    Write write{source.name, source.seenRevision, source.createTask()};
+    source.submittedRevision = source.seenRevision;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // A newer snapshot supersedes one that has not been written yet
+        auto pending = std::find_if(m_queue.begin(), m_queue.end(),
+                                    [&source](const Write& queued) { return queued.name == source.name; });
+        if (pending != m_queue.end())
+        {
+            *pending = std::move(write);
+        }
+        else
+        {
+            m_queue.push_back(std::move(write));
+        }
+    }
+    m_condition.notify_all();
+}
+
+void ConfigPersistence::writerLoop()
+{
+    Trace::setThreadName("Config writer");
+
+    while (true)
+    {
+        Write item;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_writing = true;
+        }
+
+        bool success = item.task();
+        if (!success)
+        {
+            spdlog::error("Failed to save {} configuration", item.name);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back({item.name, item.revision, success});
+            m_writing = false;
+        }
+        m_idleCondition.notify_all();
+    }
+}
+
+} // namespace unreal
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+
+// Saves configuration sources on a background thread once their changes have settled.
+// Sources are polled from the UI thread; a burst of edits results in a single write.
+class ConfigPersistence
+{
+  public:
+    using SaveTask = std::function<bool()>;
+    using RevisionGetter = std::function<uint64_t()>;
+    using SaveTaskFactory = std::function<SaveTask()>;
+
+    explicit ConfigPersistence(std::chrono::milliseconds debounce = std::chrono::milliseconds(750));
+    ~ConfigPersistence();
+
+    // The current revision of the source is considered saved
+    void track(const std::string& name, RevisionGetter revision, SaveTaskFactory createTask);
+
+    // Called once per frame, only snapshots sources whose changes have settled. A revision counts as saved once
+    // its task succeeded, a failed write is retried after kRetryDelay.
+    void update();
+
+    // Queues every dirty source immediately and waits until everything is written
+    void flush();
+
+  private:
+    static constexpr std::chrono::seconds kRetryDelay{5};
+
+    struct Source
+    {
+        std::string name;
+        RevisionGetter revision;
+        SaveTaskFactory createTask;
+        // Written to disk, handed to the writer, and last seen
+        uint64_t savedRevision = 0;
+        uint64_t submittedRevision = 0;
+        uint64_t seenRevision = 0;
+        std::chrono::steady_clock::time_point lastChange;
+        std::chrono::steady_clock::time_point retryAt;
+    };
+
+    struct Write
+    {
+        std::string name;
+        uint64_t revision = 0;
+        SaveTask task;
+    };
+
+    struct WriteResult
+    {
+        std::string name;
+        uint64_t revision = 0;
+        bool success = false;
+    };
+
+    void submit(Source& source);
+    void applyResults();
+    void writerLoop();
+
+    std::vector<Source> m_sources;
+    std::chrono::milliseconds m_debounce;
+
+    std::deque<Write> m_queue;
+    // Outcomes of the writes, applied to the sources on the UI thread
+    std::vector<WriteResult> m_results;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_idleCondition;
+    std::thread m_thread;
+    bool m_writing = false;
+    bool m_quit = false;
+};
+
+} // namespace unreal
@@ -0,0 +1,455 @@
+#include "prefetch.h"
+#include "config.h"
+#include "system.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+constexpr int kPrefetchVersion = 1;
+constexpr size_t kMaxLaunches = 50;
+// readahead blocks until its reads are queued, a few files in flight keep the disk queue full
+constexpr size_t kPrefetchWorkers = 4;
+constexpr auto kSampleInterval = std::chrono::seconds(2);
+// Plugins and the editor UI keep mapping files for a while after engine initialization
+constexpr auto kSettleTime = std::chrono::seconds(10);
+constexpr auto kMaxSampling = std::chrono::minutes(5);
+
+nlohmann::json loadJson(const std::filesystem::path& path)
+{
+    try
+    {
+        std::ifstream file(path);
+        if (file.is_open())
+        {
+            nlohmann::json json;
+            file >> json;
+            if (json.value("version", 0) == kPrefetchVersion)
+                return json;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Failed to read {}: {}", path.string(), e.what());
+    }
+    return {{"version", kPrefetchVersion}};
+}
+
+// Sorted, without overlaps, so a range is read once however many samples saw it
+void mergeRanges(std::vector<MappedRange>& ranges)
+{
+    std::sort(ranges.begin(), ranges.end(),
+              [](const MappedRange& a, const MappedRange& b) { return a.offset < b.offset; });
+    std::vector<MappedRange> merged;
+    for (const auto& range : ranges)
+    {
+        if (!merged.empty() && range.offset <= merged.back().offset + merged.back().length)
+        {
+            auto end = std::max(merged.back().offset + merged.back().length, range.offset + range.length);
+            merged.back().length = end - merged.back().offset;
+        }
+        else
+        {
+            merged.push_back(range);
+        }
+    }
+    ranges = std::move(merged);
+}
+
+EditorLaunchStats computeStats(const nlohmann::json& launches)
+{
+    EditorLaunchStats stats;
+    for (const auto& launch : launches)
+    {
+        if (!launch.value("first", false))
+            continue;
+        double seconds = launch.value("seconds", 0.0);
+        if (launch.value("prefetched", false))
+        {
+            stats.prefetchedAverage += seconds;
+            stats.prefetchedLaunches++;
+        }
+        else
+        {
+            stats.coldAverage += seconds;
+            stats.coldLaunches++;
+        }
+    }
+    if (stats.coldLaunches > 0)
+        stats.coldAverage /= static_cast<double>(stats.coldLaunches);
+    if (stats.prefetchedLaunches > 0)
+        stats.prefetchedAverage /= static_cast<double>(stats.prefetchedLaunches);
+    return stats;
+}
+
+#ifdef __linux__
+// Adds the file backed mappings of the process, false once it is gone
+bool readMappings(int pid, std::map<std::string, std::vector<MappedRange>>& files)
+{
+    std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+    if (!maps.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        unsigned long long start = 0;
+        unsigned long long end = 0;
+        unsigned long long offset = 0;
+        unsigned long long inode = 0;
+        int pathStart = 0;
+        if (sscanf(line.c_str(), "%llx-%llx %*s %llx %*s %llu %n", &start, &end, &offset, &inode, &pathStart) < 4 ||
+            inode == 0 || pathStart <= 0 || static_cast<size_t>(pathStart) >= line.size())
+            continue;
+
+        std::string path = line.substr(pathStart);
+        if (path[0] != '/' || path.rfind("/dev/", 0) == 0 ||
+            (path.size() > 10 && path.compare(path.size() - 10, 10, " (deleted)") == 0))
+            continue;
+        files[path].push_back({offset, end - start});
+    }
+    for (auto& [path, ranges] : files)
+    {
+        mergeRanges(ranges);
+    }
+    return true;
+}
+
+// Queues the reads of the ranges, clamped to the current size of the file, returns the bytes requested
+uint64_t readAheadFile(const std::string& path, const std::vector<MappedRange>& ranges)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+
+    uint64_t requested = 0;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        auto size = static_cast<uint64_t>(info.st_size);
+        for (const auto& range : ranges)
+        {
+            if (range.offset >= size)
+                break;
+            auto length = std::min(range.length, size - range.offset);
+            if (readahead(fd, static_cast<off64_t>(range.offset), static_cast<size_t>(length)) != 0)
+                posix_fadvise(fd, static_cast<off_t>(range.offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+            requested += length;
+        }
+    }
+    ::close(fd);
+    return requested;
+}
+#endif
+} // namespace
+
+EditorPrefetcher& EditorPrefetcher::instance()
+{
+    static EditorPrefetcher instance;
+    return instance;
+}
+
+EditorPrefetcher::~EditorPrefetcher()
+{
+    cancel();
+}
+
+void EditorPrefetcher::setLogCallback(LogCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    m_logCallback = callback;
+}
+
+void EditorPrefetcher::log(const std::string& message, bool isError)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        if (m_logCallback)
+        {
+            m_logCallback(message, isError);
+            return;
+        }
+    }
+    if (isError)
+        spdlog::error("{}", message);
+    else
+        spdlog::info("{}", message);
+}
+
+std::filesystem::path EditorPrefetcher::getPath(const std::filesystem::path& enginePath) const
+{
+    auto key = enginePath.lexically_normal().string();
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.json",
+             static_cast<unsigned long long>(hashBytes(key.data(), key.size())));
+    return Config::instance().getHistoryDirectory() / "prefetch" / name;
+}
+
+void EditorPrefetcher::prefetch(const std::filesystem::path& enginePath)
+{
+#ifdef __linux__
+    auto key = enginePath.lexically_normal().string();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_prefetched.count(key))
+            return;
+    }
+    std::erase_if(m_cancelledTasks,
+                  [](const auto& task) { return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+    if (m_task.valid() && m_taskEngine == key &&
+        m_task.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    // The replaced task stops at its next file, the UI thread does not wait for it
+    if (m_task.valid())
+    {
+        *m_taskCancelled = true;
+        m_cancelledTasks.push_back(std::move(m_task));
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_taskCancelled = cancelled;
+    m_taskEngine = key;
+    m_task = std::async(std::launch::async,
+                        [this, key, enginePath, cancelled]()
+                        {
+                            TRACE_SCOPE("Prefetch editor", "io", key);
+                            if (!Config::instance().isEditorPrefetchEnabled())
+                                return;
+
+                            std::vector<std::pair<std::string, std::vector<MappedRange>>> files;
+                            try
+                            {
+                                std::lock_guard<std::mutex> lock(m_mutex);
+                                auto json = loadJson(getPath(enginePath));
+                                for (const auto& file : json.value("files", nlohmann::json::array()))
+                                {
+                                    std::vector<MappedRange> ranges;
+                                    for (const auto& range : file["ranges"])
+                                    {
+                                        ranges.push_back({range[0].get<uint64_t>(), range[1].get<uint64_t>()});
+                                    }
+                                    files.emplace_back(file["path"].get<std::string>(), std::move(ranges));
+                                }
+                            }
+                            catch (const std::exception& e)
+                            {
+                                spdlog::warn("Failed to read the learned editor files: {}", e.what());
+                                return;
+                            }
+                            if (files.empty() || *cancelled)
+                                return;
+
+                            auto start = std::chrono::steady_clock::now();
+                            std::atomic<uint64_t> bytes{0};
+                            parallelFor(
+                                files.size(),
+                                [&](size_t index)
+                                {
+                                    if (!*cancelled)
+                                        bytes += readAheadFile(files[index].first, files[index].second);
+                                },
+                                kPrefetchWorkers);
+                            if (*cancelled)
+                                return;
+
+                            {
+                                std::lock_guard<std::mutex> lock(m_mutex);
+                                m_prefetched.insert(key);
+                            }
+                            double seconds =
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                            char duration[32];
+                            snprintf(duration, sizeof(duration), "%.1f s", seconds);
+                            log("Prefetched " + formatBytes(bytes) + " of editor files from " +
+                                std::to_string(files.size()) + " file(s) in " + duration);
+                        });
+#else
+    (void)enginePath;
+#endif
+}
+
+void EditorPrefetcher::cancel()
+{
+    if (m_task.valid())
+    {
+        *m_taskCancelled = true;
+        m_task.wait();
+        m_task = {};
+    }
+    for (auto& task : m_cancelledTasks)
+    {
+        task.wait();
+    }
+    m_cancelledTasks.clear();
+}
+
+bool EditorPrefetcher::isPrefetched(const std::filesystem::path& enginePath) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_prefetched.count(enginePath.lexically_normal().string()) > 0;
+}
+
+bool EditorPrefetcher::claimFirstLaunch(const std::filesystem::path& enginePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_launched.insert(enginePath.lexically_normal().string()).second;
+}
+
+void EditorPrefetcher::learn(const std::filesystem::path& enginePath,
+                             std::map<std::string, std::vector<MappedRange>> files)
+{
+    TRACE_SCOPE("Learn editor files", "io", enginePath.string());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto path = getPath(enginePath);
+    auto json = loadJson(path);
+    json["engine"] = enginePath.lexically_normal().string();
+
+    auto& list = json["files"] = nlohmann::json::array();
+    for (auto& [file, ranges] : files)
+    {
+        mergeRanges(ranges);
+        auto& entry = list.emplace_back(nlohmann::json{{"path", file}, {"ranges", nlohmann::json::array()}});
+        for (const auto& range : ranges)
+        {
+            entry["ranges"].push_back({range.offset, range.length});
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    writeFileAtomic(path, json.dump());
+}
+
+EditorLaunchStats EditorPrefetcher::recordLaunch(const std::filesystem::path& enginePath, double seconds,
+                                                 bool prefetched, bool firstLaunch)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto path = getPath(enginePath);
+    auto json = loadJson(path);
+    json["engine"] = enginePath.lexically_normal().string();
+
+    auto& launches = json["launches"];
+    if (!launches.is_array())
+        launches = nlohmann::json::array();
+    auto time = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+    launches.push_back({{"time", time}, {"seconds", seconds}, {"prefetched", prefetched}, {"first", firstLaunch}});
+    if (launches.size() > kMaxLaunches)
+        launches.erase(launches.begin(), launches.begin() + static_cast<long>(launches.size() - kMaxLaunches));
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    writeFileAtomic(path, json.dump());
+    return computeStats(launches);
+}
+
+EditorLaunchStats EditorPrefetcher::getLaunchStats(const std::filesystem::path& enginePath) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return computeStats(loadJson(getPath(enginePath)).value("launches", nlohmann::json::array()));
+}
+
+EditorLaunchRecorder::EditorLaunchRecorder(const std::filesystem::path& enginePath, std::function<int()> processGroup)
+    : m_enginePath(enginePath), m_processGroup(std::move(processGroup)), m_start(std::chrono::steady_clock::now())
+{
+    auto& prefetcher = EditorPrefetcher::instance();
+    m_prefetched = prefetcher.isPrefetched(enginePath);
+    m_firstLaunch = prefetcher.claimFirstLaunch(enginePath);
+#ifdef __linux__
+    m_thread = std::thread([this]() { sampleLoop(); });
+#endif
+}
+
+EditorLaunchRecorder::~EditorLaunchRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    // A launch that never finished initializing may have stopped before most modules were loaded
+    if (m_ready && !m_files.empty())
+    {
+        EditorPrefetcher::instance().learn(m_enginePath, std::move(m_files));
+    }
+}
+
+void EditorLaunchRecorder::sampleLoop()
+{
+#ifdef __linux__
+    int pid = 0;
+    std::chrono::steady_clock::time_point readyTime;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_condition.wait_for(lock, kSampleInterval, [this]() { return m_stop.load(); }))
+                break;
+        }
+
+        if (pid == 0)
+            pid = findProcessInGroup(m_processGroup(), {"UnrealEditor", "UE4Editor"});
+        if (pid != 0 && !readMappings(pid, m_files))
+            pid = 0;
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_ready && readyTime == std::chrono::steady_clock::time_point{})
+            readyTime = now;
+        if ((m_ready && now - readyTime >= kSettleTime) || now - m_start >= kMaxSampling)
+            break;
+    }
+#endif
+}
+
+std::string EditorLaunchRecorder::onEngineInitialized()
+{
+    if (m_ready)
+        return {};
+    m_ready = true;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    auto stats = EditorPrefetcher::instance().recordLaunch(m_enginePath, seconds, m_prefetched, m_firstLaunch);
+
+    char summary[256];
+    snprintf(summary, sizeof(summary), "Editor initialized in %.1f s (%s, %s)", seconds,
+             m_prefetched ? "prefetched" : "not prefetched", m_firstLaunch ? "first launch" : "warm launch");
+    std::string message = summary;
+    // Averages of the first launches only, later ones find the files cached whether they were prefetched or not
+    if (stats.coldLaunches > 0)
+    {
+        snprintf(summary, sizeof(summary), ", first launches %.1f s without prefetch (%zu)", stats.coldAverage,
+                 stats.coldLaunches);
+        message += summary;
+    }
+    if (stats.prefetchedLaunches > 0)
+    {
+        snprintf(summary, sizeof(summary), "%s%.1f s with prefetch (%zu)",
+                 stats.coldLaunches > 0 ? " vs " : ", first launches ", stats.prefetchedAverage,
+                 stats.prefetchedLaunches);
+        message += summary;
+    }
+    return message;
+}
+
+} // namespace unreal
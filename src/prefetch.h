@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+
+// File ranges the editor of one engine mapped during its last complete launch
+struct MappedRange
+{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+struct EditorLaunchStats
+{
+    // First launch of the engine since the launcher started, with and without a completed prefetch before it.
+    // Later launches find the files cached anyway and are left out.
+    size_t coldLaunches = 0;
+    double coldAverage = 0.0;
+    size_t prefetchedLaunches = 0;
+    double prefetchedAverage = 0.0;
+};
+
+// Learns which files the editor of an engine maps while it starts (from /proc/<pid>/maps) and reads them into the
+// page cache in the background before the next launch. Linux only, the other platforms never learn any file.
+// Stored in history/prefetch/<engine hash>.json next to the executable, "editorPrefetch": false in config.json
+// turns the prefetch off.
+class EditorPrefetcher
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    static EditorPrefetcher& instance();
+
+    void setLogCallback(LogCallback callback);
+
+    // Starts reading the learned files of the engine, replaces a prefetch of another engine. Never blocks, the
+    // learned files are parsed by the background task and a replaced prefetch finishes on its own.
+    void prefetch(const std::filesystem::path& enginePath);
+    // Stops every prefetch and waits for them, for shutdown
+    void cancel();
+    bool isPrefetched(const std::filesystem::path& enginePath) const;
+
+    // Replaces the learned files of the engine
+    void learn(const std::filesystem::path& enginePath, std::map<std::string, std::vector<MappedRange>> files);
+    // Stores the time a launch took to reach the end of engine initialization
+    EditorLaunchStats recordLaunch(const std::filesystem::path& enginePath, double seconds, bool prefetched,
+                                   bool firstLaunch);
+    EditorLaunchStats getLaunchStats(const std::filesystem::path& enginePath) const;
+    // True only for the first call per engine
+    bool claimFirstLaunch(const std::filesystem::path& enginePath);
+
+  private:
+    EditorPrefetcher() = default;
+    ~EditorPrefetcher();
+
+    void log(const std::string& message, bool isError = false);
+    std::filesystem::path getPath(const std::filesystem::path& enginePath) const;
+
+    std::future<void> m_task;
+    std::string m_taskEngine;
+    std::shared_ptr<std::atomic<bool>> m_taskCancelled;
+    // Replaced prefetches still winding down, destroying their futures would wait for them
+    std::vector<std::future<void>> m_cancelledTasks;
+    // Engines whose prefetch completed, and engines already launched in this session
+    std::set<std::string> m_prefetched;
+    std::set<std::string> m_launched;
+    mutable std::mutex m_mutex;
+    std::mutex m_logMutex;
+    LogCallback m_logCallback;
+};
+
+// Follows one editor launch: samples the mappings of the editor in the process group until a while after the engine
+// is initialized, and times the launch up to that point
+class EditorLaunchRecorder
+{
+  public:
+    EditorLaunchRecorder(const std::filesystem::path& enginePath, std::function<int()> processGroup);
+    // Stops sampling and learns the mapped files when the editor got initialized
+    ~EditorLaunchRecorder();
+    EditorLaunchRecorder(const EditorLaunchRecorder&) = delete;
+    EditorLaunchRecorder& operator=(const EditorLaunchRecorder&) = delete;
+
+    // Records the launch time and returns its summary, once per launch
+    std::string onEngineInitialized();
+
+    bool isPrefetched() const
+    {
+        return m_prefetched;
+    }
+
+  private:
+    void sampleLoop();
+
+    std::filesystem::path m_enginePath;
+    std::function<int()> m_processGroup;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_prefetched = false;
+    bool m_firstLaunch = false;
+
+    std::map<std::string, std::vector<MappedRange>> m_files;
+    std::atomic<bool> m_ready{false};
+    std::atomic<bool> m_stop{false};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+};
+
+} // namespace unreal
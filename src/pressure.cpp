@@ -0,0 +1,328 @@
+#include "pressure.h"
+#include "cgroup.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+constexpr int kDeprioritizedNice = 10;
+// A deprioritized leaf keeps a tenth of its class weight
+constexpr unsigned kDeprioritizedWeightDivisor = 10;
+
+PressureStats readPressureFile(const char* path)
+{
+    PressureStats stats;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        char kind[8] = {};
+        float avg10 = 0.0f;
+        float avg60 = 0.0f;
+        if (std::sscanf(line.c_str(), "%7s avg10=%f avg60=%f", kind, &avg10, &avg60) != 3)
+            continue;
+
+        stats.available = true;
+        if (std::string(kind) == "some")
+        {
+            stats.someAvg10 = avg10;
+            stats.someAvg60 = avg60;
+        }
+        else if (std::string(kind) == "full")
+        {
+            stats.fullAvg10 = avg10;
+            stats.fullAvg60 = avg60;
+        }
+    }
+    return stats;
+}
+
+std::string formatPercent(float value)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%.1f%%", value);
+    return buffer;
+}
+} // namespace
+
+SystemPressure readSystemPressure()
+{
+    SystemPressure pressure;
+#ifdef __linux__
+    pressure.cpu = readPressureFile("/proc/pressure/cpu");
+    pressure.memory = readPressureFile("/proc/pressure/memory");
+#endif
+    return pressure;
+}
+
+PressureMonitor::PressureMonitor(TargetProvider provider, LogCallback callback)
+    : m_provider(provider), m_logCallback(callback)
+{
+    m_thread = std::thread([this]() { monitorLoop(); });
+}
+
+PressureMonitor::~PressureMonitor()
+{
+    stop();
+}
+
+void PressureMonitor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+SystemPressure PressureMonitor::getPressure() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pressure;
+}
+
+std::string PressureMonitor::getThrottleReason(uint64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_throttled.find(id);
+    return it != m_throttled.end() ? it->second.reason : std::string();
+}
+
+bool PressureMonitor::isThrottling() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::any_of(m_throttled.begin(), m_throttled.end(),
+                       [](const auto& item) { return item.second.kind == Throttle::Paused; });
+}
+
+ThrottleSettings PressureMonitor::getSettings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_settings;
+}
+
+void PressureMonitor::setSettings(const ThrottleSettings& settings)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_settings = settings;
+    }
+    m_condition.notify_all();
+}
+
+void PressureMonitor::monitorLoop()
+{
+    Trace::setThreadName("Pressure monitor");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_quit)
+    {
+        m_condition.wait_for(lock, std::chrono::seconds(2));
+        if (m_quit)
+            break;
+
+        // The provider takes the owner's lock, never call it while holding ours
+        lock.unlock();
+        auto pressure = readSystemPressure();
+        auto targets = m_provider();
+        lock.lock();
+
+        m_pressure = pressure;
+        if (!m_settings.enabled || !pressure.memory.available)
+        {
+            releaseAll();
+            continue;
+        }
+
+        TRACE_SCOPE("Evaluate pressure", "pressure");
+        evaluate(pressure, std::move(targets));
+    }
+
+    releaseAll();
+}
+
+void PressureMonitor::evaluate(const SystemPressure& pressure, std::vector<Target> targets)
+{
+    // Forget jobs that finished or moved on to another command, a new process starts unthrottled
+    for (auto it = m_throttled.begin(); it != m_throttled.end();)
+    {
+        auto target = std::find_if(targets.begin(), targets.end(), [&](const Target& t) { return t.id == it->first; });
+        if (target == targets.end() || target->processGroup != it->second.processGroup)
+            it = m_throttled.erase(it);
+        else
+            ++it;
+    }
+
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [](const Target& t) { return t.processGroup <= 0; }),
+                  targets.end());
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastAction < m_settings.cooldown)
+        return;
+
+    // Most expendable first: lowest priority, then the most recently submitted
+    std::sort(targets.begin(), targets.end(),
+              [](const Target& a, const Target& b)
+              { return a.priority != b.priority ? a.priority < b.priority : a.id > b.id; });
+
+    auto isThrottled = [this](const Target& t, Throttle kind)
+    {
+        auto it = m_throttled.find(t.id);
+        return it != m_throttled.end() && it->second.kind == kind;
+    };
+
+    size_t active = std::count_if(targets.begin(), targets.end(),
+                                  [&](const Target& t) { return !isThrottled(t, Throttle::Paused); });
+
+    auto memory = formatPercent(pressure.memory.fullAvg10);
+    auto cpu = formatPercent(pressure.cpu.someAvg10);
+
+    // Memory: pause one job at a time, always leaving one running so the queue keeps draining
+    if (pressure.memory.fullAvg10 >= m_settings.memoryPause && active > 1)
+    {
+        for (const auto& target : targets)
+        {
+            if (isThrottled(target, Throttle::Paused))
+                continue;
+#ifndef _WIN32
+            if (kill(-target.processGroup, SIGSTOP) != 0)
+                continue;
+#endif
+            Throttled throttled;
+            throttled.kind = Throttle::Paused;
+            throttled.processGroup = target.processGroup;
+            throttled.name = target.name;
+            throttled.reason = "Paused: memory pressure " + memory;
+            m_throttled[target.id] = throttled;
+            m_lastAction = now;
+            m_logCallback("[" + target.name + "] Paused, memory pressure at " + memory, true);
+            return;
+        }
+    }
+
+    if (pressure.memory.fullAvg10 <= m_settings.memoryResume)
+    {
+        for (auto it = targets.rbegin(); it != targets.rend(); ++it)
+        {
+            auto throttled = m_throttled.find(it->id);
+            if (throttled == m_throttled.end() || throttled->second.kind != Throttle::Paused)
+                continue;
+
+            release(throttled->second);
+            m_throttled.erase(throttled);
+            m_lastAction = now;
+            m_logCallback("[" + it->name + "] Resumed, memory pressure down to " + memory, false);
+            return;
+        }
+    }
+
+    if (!pressure.cpu.available)
+        return;
+
+    // CPU: lower the priority of the most expendable job so the others get the cores first
+    if (pressure.cpu.someAvg10 >= m_settings.cpuDeprioritize && targets.size() > 1)
+    {
+        for (const auto& target : targets)
+        {
+            if (m_throttled.count(target.id))
+                continue;
+
+            Throttled throttled;
+            throttled.cgroup = target.cgroup;
+            throttled.nice = target.nice;
+            if (!target.cgroup.empty())
+            {
+                throttled.cpuWeight = ResourceGroups::getCpuWeight(target.cgroup);
+                if (throttled.cpuWeight <= 1 ||
+                    !ResourceGroups::setCpuWeight(target.cgroup,
+                                                  std::max(1u, throttled.cpuWeight / kDeprioritizedWeightDivisor)))
+                    continue;
+            }
+            else
+            {
+                // Never raise the priority of a class that already runs below the throttled one
+                if (target.nice >= kDeprioritizedNice)
+                    continue;
+#ifndef _WIN32
+                if (setpriority(PRIO_PGRP, static_cast<id_t>(target.processGroup), kDeprioritizedNice) != 0)
+                    continue;
+#endif
+            }
+            throttled.kind = Throttle::Deprioritized;
+            throttled.processGroup = target.processGroup;
+            throttled.name = target.name;
+            throttled.reason = "Lower priority: CPU pressure " + cpu;
+            m_throttled[target.id] = throttled;
+            m_lastAction = now;
+            m_logCallback("[" + target.name + "] Lowered priority, CPU pressure at " + cpu, false);
+            return;
+        }
+    }
+
+    if (pressure.cpu.someAvg10 <= m_settings.cpuRestore)
+    {
+        for (auto it = targets.rbegin(); it != targets.rend(); ++it)
+        {
+            auto throttled = m_throttled.find(it->id);
+            if (throttled == m_throttled.end() || throttled->second.kind != Throttle::Deprioritized)
+                continue;
+
+            bool restored = release(throttled->second);
+            m_throttled.erase(throttled);
+            m_lastAction = now;
+            if (!restored)
+            {
+                // Raising a nice value back needs CAP_SYS_NICE or a RLIMIT_NICE allowance
+                m_logCallback("[" + it->name + "] Keeps its lower priority until it exits: " +
+                                  std::string(std::strerror(errno)),
+                              false);
+                return;
+            }
+            m_logCallback("[" + it->name + "] Restored priority, CPU pressure down to " + cpu, false);
+            return;
+        }
+    }
+}
+
+bool PressureMonitor::release(const Throttled& throttled)
+{
+    if (throttled.kind == Throttle::Deprioritized && !throttled.cgroup.empty())
+        return ResourceGroups::setCpuWeight(throttled.cgroup, throttled.cpuWeight);
+#ifndef _WIN32
+    if (throttled.kind == Throttle::Paused)
+        return kill(-throttled.processGroup, SIGCONT) == 0;
+    // Back to the class priority the job was launched with
+    return setpriority(PRIO_PGRP, static_cast<id_t>(throttled.processGroup), throttled.nice) == 0;
+#else
+    return true;
+#endif
+}
+
+void PressureMonitor::releaseAll()
+{
+    for (const auto& [id, throttled] : m_throttled)
+    {
+        release(throttled);
+        if (throttled.kind == Throttle::Paused)
+            m_logCallback("[" + throttled.name + "] Resumed", false);
+    }
+    m_throttled.clear();
+}
+
+} // namespace unreal
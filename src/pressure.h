@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+
+// One resource from /proc/pressure, percentages of wall time spent stalled
+struct PressureStats
+{
+    bool available = false;
+    float someAvg10 = 0.0f;
+    float someAvg60 = 0.0f;
+    float fullAvg10 = 0.0f;
+    float fullAvg60 = 0.0f;
+};
+
+struct SystemPressure
+{
+    PressureStats cpu;
+    PressureStats memory;
+};
+
+// Reads Linux pressure-stall information, every stat is unavailable on other platforms or old kernels
+SystemPressure readSystemPressure();
+
+struct ThrottleSettings
+{
+    bool enabled = true;
+    // memory "full" avg10: every task stalled on memory, the machine is thrashing
+    float memoryPause = 10.0f;
+    float memoryResume = 2.0f;
+    // cpu "some" avg10: runnable tasks waiting for a core
+    float cpuDeprioritize = 80.0f;
+    float cpuRestore = 40.0f;
+    // Minimum delay between two actions, pressure averages need time to react
+    std::chrono::seconds cooldown{10};
+};
+
+// Samples system pressure and pauses (SIGSTOP) or deprioritizes the lowest-priority jobs while it stays high, then
+// resumes them once it falls back. A job with a cgroup leaf is deprioritized through its cpu.weight, which the
+// launcher can raise back without privileges, any other job through the nice value of its process group.
+class PressureMonitor
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    struct Target
+    {
+        uint64_t id = 0;
+        int processGroup = 0;
+        int priority = 0;
+        std::string name;
+        // Leaf the job runs in, empty when it only got the fallback nice value
+        std::filesystem::path cgroup;
+        int nice = 0;
+    };
+    // Called from the monitor thread, must return the jobs currently running
+    using TargetProvider = std::function<std::vector<Target>()>;
+
+    PressureMonitor(TargetProvider provider, LogCallback callback);
+    ~PressureMonitor();
+
+    // Stops sampling and resumes every paused job, the provider is not called anymore once it returns
+    void stop();
+
+    SystemPressure getPressure() const;
+    // Empty when the job is running normally
+    std::string getThrottleReason(uint64_t id) const;
+    // True while any job is paused, new work should not be started then
+    bool isThrottling() const;
+
+    ThrottleSettings getSettings() const;
+    void setSettings(const ThrottleSettings& settings);
+
+  private:
+    enum class Throttle
+    {
+        Paused,
+        Deprioritized
+    };
+
+    struct Throttled
+    {
+        Throttle kind = Throttle::Paused;
+        int processGroup = 0;
+        std::string name;
+        std::string reason;
+        // What a deprioritized job is restored to
+        std::filesystem::path cgroup;
+        unsigned cpuWeight = 0;
+        int nice = 0;
+    };
+
+    void monitorLoop();
+    void evaluate(const SystemPressure& pressure, std::vector<Target> targets);
+    // Resumes or restores the priority of a job, false when that failed
+    bool release(const Throttled& throttled);
+    void releaseAll();
+
+    TargetProvider m_provider;
+    LogCallback m_logCallback;
+    ThrottleSettings m_settings;
+    SystemPressure m_pressure;
+    std::map<uint64_t, Throttled> m_throttled;
+    std::chrono::steady_clock::time_point m_lastAction;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_quit = false;
+};
+
+} // namespace unreal
@@ -0,0 +1,284 @@
+#include "profiling.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace unreal
+{
+
+namespace
+{
+// A hitch is a frame at least twice the median and slower than 30 FPS
+constexpr double kHitchRatio = 2.0;
+constexpr double kMinHitchMilliseconds = 33.3;
+const char kExclusivePrefix[] = "Exclusive/";
+
+double round2(double value)
+{
+    return std::round(value * 100.0) / 100.0;
+}
+
+// Value at the given fraction of the sorted frame times
+double percentile(const std::vector<float>& sorted, double fraction)
+{
+    auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+} // namespace
+
+bool CsvProfileParser::parseFile(const std::filesystem::path& path)
+{
+    TRACE_SCOPE("Parse CSV profile", "io", path.filename().string());
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    beginCapture();
+    std::string line;
+    while (std::getline(file, line) && !m_done)
+    {
+        feed(line);
+    }
+    return true;
+}
+
+void CsvProfileParser::beginCapture()
+{
+    m_columnStats.clear();
+    m_header = true;
+    m_done = false;
+    m_frameColumn = -1;
+}
+
+void CsvProfileParser::feed(const std::string& line)
+{
+    if (m_done || line.empty())
+        return;
+
+    if (m_header)
+    {
+        m_header = false;
+        size_t start = 0;
+        while (start <= line.size())
+        {
+            auto end = line.find(',', start);
+            if (end == std::string::npos)
+                end = line.size();
+            auto name = line.substr(start, end - start);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' '))
+                name.pop_back();
+
+            if (name.empty() || name == "EVENTS")
+            {
+                m_columnStats.push_back(-1);
+            }
+            else
+            {
+                auto [it, inserted] = m_stats.emplace(name, m_names.size());
+                if (inserted)
+                {
+                    m_names.push_back(name);
+                    m_columns.emplace_back();
+                }
+                if (name == "FrameTime")
+                    m_frameColumn = static_cast<int>(m_columnStats.size());
+                m_columnStats.push_back(static_cast<int>(it->second));
+            }
+            start = end + 1;
+        }
+        return;
+    }
+
+    // "[HasHeaderRowAtEnd],1,[platform],..." metadata ends the frames
+    if (line[0] == '[')
+    {
+        m_done = true;
+        return;
+    }
+
+    const char* cursor = line.c_str();
+    for (size_t column = 0; column < m_columnStats.size(); ++column)
+    {
+        int stat = m_columnStats[column];
+        if (stat >= 0)
+        {
+            char* end = nullptr;
+            double value = std::strtod(cursor, &end);
+            if (end != cursor && (*end == ',' || *end == '\0' || *end == '\r'))
+            {
+                auto& sample = m_columns[stat];
+                sample.sum += value;
+                sample.peak = std::max(sample.peak, value);
+                sample.count++;
+                if (static_cast<int>(column) == m_frameColumn)
+                    m_frameTimes.push_back(static_cast<float>(value));
+            }
+        }
+
+        cursor = std::strchr(cursor, ',');
+        if (!cursor)
+            break;
+        cursor++;
+    }
+}
+
+ProfileSummary CsvProfileParser::finish(size_t topStats) const
+{
+    ProfileSummary summary;
+    summary.frames = m_frameTimes.size();
+    if (!m_frameTimes.empty())
+    {
+        auto sorted = m_frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (float frame : sorted)
+            total += frame;
+        summary.averageFrame = total / static_cast<double>(sorted.size());
+        summary.p50 = percentile(sorted, 0.5);
+        summary.p90 = percentile(sorted, 0.9);
+        summary.p99 = percentile(sorted, 0.99);
+        summary.maxFrame = sorted.back();
+
+        double threshold = std::max(kHitchRatio * summary.p50, kMinHitchMilliseconds);
+        summary.hitches = static_cast<size_t>(
+            sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), static_cast<float>(threshold)));
+    }
+
+    auto average = [this](const char* name)
+    {
+        auto it = m_stats.find(name);
+        if (it == m_stats.end() || m_columns[it->second].count == 0)
+            return -1.0;
+        const auto& column = m_columns[it->second];
+        return column.sum / static_cast<double>(column.count);
+    };
+    summary.gameThread = average("GameThreadTime");
+    summary.renderThread = average("RenderThreadTime");
+    summary.gpu = average("GPUTime");
+
+    for (size_t i = 0; i < m_names.size(); ++i)
+    {
+        const auto& column = m_columns[i];
+        if (column.count == 0 || m_names[i].rfind(kExclusivePrefix, 0) != 0)
+            continue;
+        ProfileStat stat;
+        stat.name = m_names[i].substr(sizeof(kExclusivePrefix) - 1);
+        stat.average = column.sum / static_cast<double>(column.count);
+        stat.peak = column.peak;
+        summary.topStats.push_back(std::move(stat));
+    }
+    std::sort(summary.topStats.begin(), summary.topStats.end(),
+              [](const ProfileStat& a, const ProfileStat& b) { return a.average > b.average; });
+    if (summary.topStats.size() > topStats)
+        summary.topStats.resize(topStats);
+    return summary;
+}
+
+void collectProfilingFiles(const std::filesystem::path& projectDir, std::filesystem::file_time_type since,
+                           std::vector<std::string>& csvFiles, std::vector<std::string>& traceFiles)
+{
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(projectDir / "Saved" / "Profiling",
+                                                     std::filesystem::directory_options::skip_permission_denied, ec);
+    for (std::filesystem::recursive_directory_iterator end; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        auto extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension != ".csv" && extension != ".utrace")
+            continue;
+        auto written = it->last_write_time(ec);
+        if (ec || written < since)
+            continue;
+        (extension == ".csv" ? csvFiles : traceFiles).push_back(it->path().string());
+    }
+    std::sort(csvFiles.begin(), csvFiles.end());
+    std::sort(traceFiles.begin(), traceFiles.end());
+}
+
+ProfilingHistory& ProfilingHistory::instance()
+{
+    static ProfilingHistory instance;
+    return instance;
+}
+
+void ProfilingHistory::append(const ProfileSession& session)
+{
+    TRACE_SCOPE("Append profile session", "io", session.project);
+
+    const auto& summary = session.summary;
+    nlohmann::json top = nlohmann::json::array();
+    for (const auto& stat : summary.topStats)
+    {
+        top.push_back({stat.name, round2(stat.average), round2(stat.peak)});
+    }
+
+    nlohmann::json json;
+    json["time"] = session.timestamp;
+    json["engine"] = session.engine;
+    json["duration"] = round2(session.durationSeconds);
+    json["args"] = session.arguments;
+    json["csv"] = session.csvFiles;
+    json["traces"] = session.traceFiles;
+    json["frames"] = summary.frames;
+    json["avg"] = round2(summary.averageFrame);
+    json["p50"] = round2(summary.p50);
+    json["p90"] = round2(summary.p90);
+    json["p99"] = round2(summary.p99);
+    json["max"] = round2(summary.maxFrame);
+    json["hitches"] = summary.hitches;
+    json["gameThread"] = round2(summary.gameThread);
+    json["renderThread"] = round2(summary.renderThread);
+    json["gpu"] = round2(summary.gpu);
+    json["top"] = top;
+
+    m_store.append(session.project, json.dump());
+}
+
+std::vector<ProfileSession> ProfilingHistory::load(const std::string& project) const
+{
+    TRACE_SCOPE("Load profile sessions", "io", project);
+    std::vector<ProfileSession> sessions;
+    m_store.load(project,
+                 [&](const std::string& line)
+                 {
+                     auto json = nlohmann::json::parse(line);
+                     ProfileSession session;
+                     session.project = project;
+                     session.timestamp = json.value("time", int64_t(0));
+                     session.engine = json.value("engine", "");
+                     session.durationSeconds = json.value("duration", 0.0);
+                     session.arguments = json.value("args", "");
+                     session.csvFiles = json.value("csv", std::vector<std::string>());
+                     session.traceFiles = json.value("traces", std::vector<std::string>());
+
+                     auto& summary = session.summary;
+                     summary.frames = json.value("frames", size_t(0));
+                     summary.averageFrame = json.value("avg", 0.0);
+                     summary.p50 = json.value("p50", 0.0);
+                     summary.p90 = json.value("p90", 0.0);
+                     summary.p99 = json.value("p99", 0.0);
+                     summary.maxFrame = json.value("max", 0.0);
+                     summary.hitches = json.value("hitches", size_t(0));
+                     summary.gameThread = json.value("gameThread", -1.0);
+                     summary.renderThread = json.value("renderThread", -1.0);
+                     summary.gpu = json.value("gpu", -1.0);
+                     for (const auto& entry : json.value("top", nlohmann::json::array()))
+                     {
+                         ProfileStat stat;
+                         stat.name = entry.at(0).get<std::string>();
+                         stat.average = entry.at(1).get<double>();
+                         stat.peak = entry.at(2).get<double>();
+                         summary.topStats.push_back(std::move(stat));
+                     }
+                     sessions.push_back(std::move(session));
+                 });
+    return sessions;
+}
+
+} // namespace unreal
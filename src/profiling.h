@@ -0,0 +1,119 @@
+#pragma once
+
+#include "history_store.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unreal
+{
+
+// What a Profile launch records into Saved/Profiling
+struct ProfileOptions
+{
+    // CSV profiler capture from the first frame, -csvCapture
+    bool csv = true;
+    // Unreal Insights trace of the cpu, frame and gpu channels
+    bool insights = true;
+    // Profile the game (-game) rather than the editor
+    bool game = true;
+};
+
+struct ProfileStat
+{
+    // CSV column without its "Exclusive/" prefix, e.g. "GameThread/Slate"
+    std::string name;
+    // Milliseconds per frame
+    double average = 0.0;
+    double peak = 0.0;
+};
+
+// Frame times in milliseconds over every CSV capture of a session, negative thread times when the column is missing
+struct ProfileSummary
+{
+    size_t frames = 0;
+    double averageFrame = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double maxFrame = 0.0;
+    size_t hitches = 0;
+    double gameThread = -1.0;
+    double renderThread = -1.0;
+    double gpu = -1.0;
+    // Most expensive exclusive timing stats, highest average first
+    std::vector<ProfileStat> topStats;
+};
+
+struct ProfileSession
+{
+    int64_t timestamp = 0;
+    std::string project;
+    std::string engine;
+    double durationSeconds = 0.0;
+    std::string arguments;
+    std::vector<std::string> csvFiles;
+    std::vector<std::string> traceFiles;
+    ProfileSummary summary;
+};
+
+// Reads CSV profiler captures line by line, only the frame times and the per column sums are kept in memory
+class CsvProfileParser
+{
+  public:
+    // Adds one capture file, false when it could not be opened
+    bool parseFile(const std::filesystem::path& path);
+    // Starts a new capture, the next line fed is its header row
+    void beginCapture();
+    void feed(const std::string& line);
+    ProfileSummary finish(size_t topStats = 10) const;
+
+  private:
+    struct Column
+    {
+        double sum = 0.0;
+        double peak = 0.0;
+        size_t count = 0;
+    };
+
+    // Stat of each column of the current capture, -1 for the columns that are not numbers
+    std::vector<int> m_columnStats;
+    bool m_header = true;
+    // The metadata row closes a capture, the repeated header row after it is ignored
+    bool m_done = false;
+    int m_frameColumn = -1;
+
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, size_t> m_stats;
+    std::vector<Column> m_columns;
+    std::vector<float> m_frameTimes;
+};
+
+// .csv and .utrace files written under <Project>/Saved/Profiling since the given time
+void collectProfilingFiles(const std::filesystem::path& projectDir, std::filesystem::file_time_type since,
+                           std::vector<std::string>& csvFiles, std::vector<std::string>& traceFiles);
+
+// Append-only JSON lines store of profile sessions, one file per project in history/profiling/
+class ProfilingHistory
+{
+  public:
+    static ProfilingHistory& instance();
+
+    void append(const ProfileSession& session);
+    // Oldest first
+    std::vector<ProfileSession> load(const std::string& project) const;
+
+    uint64_t getRevision() const
+    {
+        return m_store.getRevision();
+    }
+
+  private:
+    ProfilingHistory() = default;
+
+    JsonLinesStore m_store{"profiling"};
+};
+
+} // namespace unreal
@@ -1,8 +1,12 @@
 #include "project.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "utils.h"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <regex>
 #include <spdlog/spdlog.h>
+#include <unordered_map>
 
 namespace unreal
 {
@@ -77,10 +81,12 @@ std::optional<std::filesystem::path> ProjectManager::findUProjectFile(const std:
 
 std::optional<std::filesystem::path> ProjectManager::findProjectIcon(const std::filesystem::path& uprojectPath)
 {
+    // Called from parallelFor workers, a broken path or a permission error must not throw out of them
+    std::error_code ec;
     auto iconPath = uprojectPath;
     iconPath.replace_extension(".png");
 
-    if (std::filesystem::exists(iconPath))
+    if (std::filesystem::exists(iconPath, ec))
     {
         return iconPath;
     }
@@ -90,7 +96,7 @@ std::optional<std::filesystem::path> ProjectManager::findProjectIcon(const std::
     auto projectName = uprojectPath.stem().string();
     auto altIconPath = projectDir / (projectName + ".png");
 
-    if (std::filesystem::exists(altIconPath))
+    if (std::filesystem::exists(altIconPath, ec))
     {
         return altIconPath;
     }
@@ -126,12 +132,15 @@ bool ProjectManager::addProject(const std::filesystem::path& projectPath)
     project.iconPath = findProjectIcon(*uprojectFile);
 
     m_projects.push_back(project);
+    markDirty();
+    ++m_generation;
     log("Added project: " + projectName);
     return true;
 }
 
 bool ProjectManager::addProjectsFromFolder(const std::filesystem::path& folderPath)
 {
+    TRACE_SCOPE("Scan folder", "projects", folderPath.string());
     if (!std::filesystem::exists(folderPath) || !std::filesystem::is_directory(folderPath))
     {
         log("Invalid folder path: " + folderPath.string(), true);
@@ -172,6 +181,8 @@ void ProjectManager::removeProject(const std::string& name)
     if (it != m_projects.end())
     {
         m_projects.erase(it, m_projects.end());
+        markDirty();
+        ++m_generation;
         log("Removed project: " + name);
     }
 }
@@ -186,56 +197,181 @@ Project* ProjectManager::findProject(const std::string& name)
     return nullptr;
 }
 
-bool ProjectManager::load(const std::filesystem::path& configPath)
+std::vector<Project> ProjectManager::readConfig(const std::filesystem::path& configPath)
 {
-    try
+    TRACE_SCOPE("Parse projects.json", "projects");
+    std::ifstream file(configPath);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("cannot open " + configPath.string());
+    }
+
+    nlohmann::json json;
+    file >> json;
+
+    std::vector<Project> projects;
+    projects.reserve(json["projects"].size());
+    for (const auto& item : json["projects"])
     {
-        if (!std::filesystem::exists(configPath))
+        Project proj;
+        proj.name = item["name"].get<std::string>();
+        proj.path = item["path"].get<std::string>();
+        proj.uprojectPath = item["uprojectPath"].get<std::string>();
+        proj.engineVersion = item["engineVersion"].get<std::string>();
+
+        if (item.contains("iconPath") && !item["iconPath"].is_null())
         {
-            log("Project config file does not exist: " + configPath.string());
-            return false;
+            proj.iconPath = item["iconPath"].get<std::string>();
         }
 
-        std::ifstream file(configPath);
-        if (!file.is_open())
+        if (item.contains("commandLineArgs"))
         {
-            log("Failed to open project config: " + configPath.string(), true);
-            return false;
+            proj.commandLineArgs = item["commandLineArgs"].get<std::string>();
         }
 
-        nlohmann::json json;
-        file >> json;
+        projects.push_back(proj);
+    }
+    return projects;
+}
+
+void ProjectManager::setProjects(std::vector<Project> projects)
+{
+    // Existence is verified later by startChecks, stat calls can be slow on network drives
+    m_projects = std::move(projects);
+    ++m_generation;
+}
+
+void ProjectManager::startChecks()
+{
+    m_checks = std::async(std::launch::async, [projects = m_projects]() { return checkProjects(projects); });
+}
+
+std::vector<ProjectManager::ProjectCheck> ProjectManager::checkProjects(const std::vector<Project>& projects)
+{
+    TRACE_SCOPE("Check projects", "projects", std::to_string(projects.size()) + " projects");
+    std::vector<ProjectCheck> checks(projects.size());
 
-        m_projects.clear();
-        for (const auto& item : json["projects"])
+    // Stats are mostly latency bound on network shares, run many in flight
+    parallelFor(
+        projects.size(),
+        [&](size_t i)
         {
-            Project proj;
-            proj.name = item["name"].get<std::string>();
-            proj.path = item["path"].get<std::string>();
-            proj.uprojectPath = item["uprojectPath"].get<std::string>();
-            proj.engineVersion = item["engineVersion"].get<std::string>();
+            const auto& proj = projects[i];
+            auto& check = checks[i];
+            check.name = proj.name;
 
-            if (item.contains("iconPath") && !item["iconPath"].is_null())
+            std::error_code ec;
+            check.missing = !std::filesystem::exists(proj.uprojectPath, ec);
+            if (!check.missing)
             {
-                proj.iconPath = item["iconPath"].get<std::string>();
+                check.iconPath = findProjectIcon(proj.uprojectPath);
+                if (proj.engineVersion.empty())
+                {
+                    check.engineVersion = proj.getEngineVersionFromFile();
+                }
             }
+        },
+        16);
+    return checks;
+}
 
-            if (item.contains("commandLineArgs"))
-            {
-                proj.commandLineArgs = item["commandLineArgs"].get<std::string>();
-            }
+void ProjectManager::applyChecks(const std::vector<ProjectCheck>& checks)
+{
+    std::unordered_map<std::string, Project*> byName;
+    for (auto& proj : m_projects)
+    {
+        byName[proj.name] = &proj;
+    }
 
-            // Verify the project still exists
-            if (std::filesystem::exists(proj.uprojectPath))
-            {
-                m_projects.push_back(proj);
-            }
-            else
+    size_t missingCount = 0;
+    bool changed = false;
+    for (const auto& check : checks)
+    {
+        auto it = byName.find(check.name);
+        if (it == byName.end())
+            continue;
+
+        auto& proj = *it->second;
+        proj.missing = check.missing;
+        if (check.missing)
+        {
+            log("Project not found: " + proj.name + " (" + proj.uprojectPath.string() + ")", true);
+            ++missingCount;
+            continue;
+        }
+
+        if (check.iconPath != proj.iconPath)
+        {
+            proj.iconPath = check.iconPath;
+            changed = true;
+        }
+        if (!check.engineVersion.empty() && proj.engineVersion.empty())
+        {
+            proj.engineVersion = check.engineVersion;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        markDirty();
+    }
+    if (missingCount > 0)
+    {
+        log(std::to_string(missingCount) + " project(s) could not be found", true);
+    }
+}
+
+bool ProjectManager::load(const std::filesystem::path& configPath)
+{
+    TRACE_SCOPE("ProjectManager::load", "projects");
+    try
+    {
+        auto jsonStamp = SourceStamp::fromFile(configPath);
+        if (!jsonStamp)
+        {
+            log("Project config file does not exist: " + configPath.string());
+            return false;
+        }
+
+        auto snapshotPath = ProjectSnapshot::pathFor(configPath);
+        SourceStamp snapshotStamp;
+        if (auto projects = ProjectSnapshot::read(snapshotPath, &snapshotStamp))
+        {
+            setProjects(std::move(*projects));
+            if (snapshotStamp == *jsonStamp)
             {
-                log("Project no longer exists, skipping: " + proj.name, true);
+                log("Loaded " + std::to_string(m_projects.size()) + " projects from " + snapshotPath.string());
+                return true;
             }
+
+            // projects.json was edited since the snapshot was written, it stays the source of truth
+            log("Loaded " + std::to_string(m_projects.size()) + " projects from snapshot, reconciling with " +
+                configPath.string());
+            m_reconcileRevision = m_revision;
+            m_reconcile = std::async(std::launch::async,
+                                     [configPath, snapshotPath, stamp = *jsonStamp]()
+                                         -> std::optional<std::vector<Project>>
+                                     {
+                                         try
+                                         {
+                                             auto parsed = readConfig(configPath);
+                                             ProjectSnapshot::write(parsed, snapshotPath, stamp);
+                                             return parsed;
+                                         }
+                                         catch (const std::exception& e)
+                                         {
+                                             spdlog::error("Failed to reconcile project config: {}", e.what());
+                                             return std::nullopt;
+                                         }
+                                     });
+            return true;
         }
 
+        auto projects = readConfig(configPath);
+        ProjectSnapshot::write(projects, snapshotPath, *jsonStamp);
+        setProjects(std::move(projects));
+
         log("Loaded " + std::to_string(m_projects.size()) + " projects from " + configPath.string());
         return true;
     }
@@ -246,41 +382,73 @@ bool ProjectManager::load(const std::filesystem::path& configPath)
     }
 }
 
+void ProjectManager::update()
+{
+    if (m_checks.valid() && m_checks.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        applyChecks(m_checks.get());
+    }
+
+    if (!m_reconcile.valid() || m_reconcile.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    auto projects = m_reconcile.get();
+    if (!projects)
+        return;
+
+    if (m_revision != m_reconcileRevision)
+    {
+        log("Project list changed while reconciling, keeping local changes");
+        return;
+    }
+
+    setProjects(std::move(*projects));
+    startChecks();
+    log("Reconciled project list with projects.json: " + std::to_string(m_projects.size()) + " projects");
+}
+
 bool ProjectManager::save(const std::filesystem::path& configPath) const
 {
+    return writeConfig(m_projects, configPath);
+}
+
+std::function<bool()> ProjectManager::createSaveTask(const std::filesystem::path& configPath) const
+{
+    return [projects = m_projects, configPath]() { return writeConfig(projects, configPath); };
+}
+
+bool ProjectManager::writeConfig(const std::vector<Project>& projects, const std::filesystem::path& configPath)
+{
+    TRACE_SCOPE("Save projects", "projects");
     try
     {
-        // Create parent directories if needed
-        auto parentPath = configPath.parent_path();
-        if (!parentPath.empty() && !std::filesystem::exists(parentPath))
-        {
-            std::filesystem::create_directories(parentPath);
-        }
-
         nlohmann::json json;
         json["projects"] = nlohmann::json::array();
 
-        for (const auto& proj : m_projects)
+        for (const auto& proj : projects)
         {
             nlohmann::json item;
             item["name"] = proj.name;
             item["path"] = proj.path.string();
             item["uprojectPath"] = proj.uprojectPath.string();
             item["engineVersion"] = proj.engineVersion;
-            item["iconPath"] = proj.iconPath ? proj.iconPath->string() : nullptr;
+            item["iconPath"] = proj.iconPath ? nlohmann::json(proj.iconPath->string()) : nlohmann::json(nullptr);
             item["commandLineArgs"] = proj.commandLineArgs;
             json["projects"].push_back(item);
         }
 
-        std::ofstream file(configPath);
-        if (!file.is_open())
+        if (!writeFileAtomic(configPath, json.dump(4)))
         {
             spdlog::error("Failed to save project config: {}", configPath.string());
             return false;
         }
 
-        file << json.dump(4);
-        spdlog::info("Saved {} projects to {}", m_projects.size(), configPath.string());
+        if (auto stamp = SourceStamp::fromFile(configPath))
+        {
+            ProjectSnapshot::write(projects, ProjectSnapshot::pathFor(configPath), *stamp);
+        }
+
+        spdlog::info("Saved {} projects to {}", projects.size(), configPath.string());
         return true;
     }
     catch (const std::exception& e)
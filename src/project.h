@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <future>
 #include <optional>
 #include <string>
 #include <vector>
@@ -18,6 +20,9 @@ struct Project
     std::optional<std::filesystem::path> iconPath;
     std::string commandLineArgs;
 
+    // Set asynchronously after loading when the .uproject file cannot be found, not persisted
+    bool missing = false;
+
     bool isValid() const;
     std::string getEngineVersionFromFile() const;
 };
@@ -47,14 +52,64 @@ class ProjectManager
     bool load(const std::filesystem::path& configPath);
     bool save(const std::filesystem::path& configPath) const;
 
+    // Applies the result of background work started by load, called once per frame
+    void update();
+
+    // Parses a projects.json file, throws on malformed content
+    static std::vector<Project> readConfig(const std::filesystem::path& configPath);
+
+    // Checks that projects still exist and refreshes their metadata in the background,
+    // results are applied by update()
+    void startChecks();
+
+    // Returns a task writing a copy of the current state, safe to run on another thread
+    std::function<bool()> createSaveTask(const std::filesystem::path& configPath) const;
+
+    // Incremented on every change, used to detect unsaved changes
+    uint64_t getRevision() const
+    {
+        return m_revision;
+    }
+    void markDirty()
+    {
+        ++m_revision;
+    }
+
+    // Incremented whenever the project list is reallocated, invalidating Project pointers
+    uint64_t getGeneration() const
+    {
+        return m_generation;
+    }
+
     static std::optional<std::filesystem::path> findUProjectFile(const std::filesystem::path& directory);
     static std::optional<std::filesystem::path> findProjectIcon(const std::filesystem::path& uprojectPath);
 
   private:
+    struct ProjectCheck
+    {
+        std::string name;
+        bool missing = false;
+        std::optional<std::filesystem::path> iconPath;
+        std::string engineVersion;
+    };
+
+    static std::vector<ProjectCheck> checkProjects(const std::vector<Project>& projects);
+    void applyChecks(const std::vector<ProjectCheck>& checks);
+
     void log(const std::string& message, bool isError = false);
+    static bool writeConfig(const std::vector<Project>& projects, const std::filesystem::path& configPath);
+    void setProjects(std::vector<Project> projects);
 
     std::vector<Project> m_projects;
     LogCallback m_logCallback;
+    uint64_t m_revision = 0;
+    uint64_t m_generation = 0;
+
+    // JSON parsed in the background when the snapshot was older than projects.json
+    std::future<std::optional<std::vector<Project>>> m_reconcile;
+    uint64_t m_reconcileRevision = 0;
+
+    std::future<std::vector<ProjectCheck>> m_checks;
 };
 
 } // namespace unreal
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace unreal
+{
+
+// Incremental SHA-256 (FIPS 180-4), for checksums other tools must be able to verify (sha256sum)
+class Sha256
+{
+  public:
+    Sha256();
+
+    void update(const void* data, size_t size);
+    // Lowercase hex digest, the hasher must not be updated afterwards
+    std::string finishHex();
+
+  private:
+    void compress(const uint8_t* block);
+
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_buffer;
+    size_t m_buffered = 0;
+    uint64_t m_length = 0;
+};
+
+} // namespace unreal
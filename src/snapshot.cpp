@@ -0,0 +1,212 @@
+#include "snapshot.h"
+#include "trace.h"
+#include "utils.h"
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <unordered_map>
+
+namespace unreal
+{
+
+namespace
+{
+constexpr uint32_t kNoString = 0xFFFFFFFF;
+constexpr size_t kFieldsPerProject = 6;
+
+// magic, version, checksum, source size, source mtime, string count, project count, string data size, reserved
+constexpr size_t kHeaderSize = 4 + 4 + 8 + 8 + 8 + 4 + 4 + 4 + 4;
+
+void put32(std::vector<unsigned char>& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+void put64(std::vector<unsigned char>& out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+uint32_t get32(const unsigned char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    return value;
+}
+
+uint64_t get64(const unsigned char* data)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    return value;
+}
+} // namespace
+
+std::optional<SourceStamp> SourceStamp::fromFile(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return std::nullopt;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    SourceStamp stamp;
+    stamp.size = size;
+    stamp.mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return stamp;
+}
+
+std::filesystem::path ProjectSnapshot::pathFor(const std::filesystem::path& configPath)
+{
+    auto path = configPath;
+    path.replace_extension(".bin");
+    return path;
+}
+
+bool ProjectSnapshot::write(const std::vector<Project>& projects, const std::filesystem::path& path,
+                            const SourceStamp& source)
+{
+    TRACE_SCOPE("Write snapshot", "projects");
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> interned;
+    auto intern = [&](const std::string& value)
+    {
+        auto [it, inserted] = interned.emplace(value, static_cast<uint32_t>(strings.size()));
+        if (inserted)
+            strings.push_back(value);
+        return it->second;
+    };
+
+    std::vector<uint32_t> records;
+    records.reserve(projects.size() * kFieldsPerProject);
+    for (const auto& proj : projects)
+    {
+        records.push_back(intern(proj.name));
+        records.push_back(intern(proj.path.string()));
+        records.push_back(intern(proj.uprojectPath.string()));
+        records.push_back(intern(proj.engineVersion));
+        records.push_back(proj.iconPath ? intern(proj.iconPath->string()) : kNoString);
+        records.push_back(intern(proj.commandLineArgs));
+    }
+
+    std::vector<unsigned char> body;
+    uint32_t stringDataSize = 0;
+    for (const auto& str : strings)
+    {
+        put32(body, stringDataSize);
+        put32(body, static_cast<uint32_t>(str.size()));
+        stringDataSize += static_cast<uint32_t>(str.size());
+    }
+    for (const auto& str : strings)
+    {
+        body.insert(body.end(), str.begin(), str.end());
+    }
+    for (uint32_t index : records)
+    {
+        put32(body, index);
+    }
+
+    std::vector<unsigned char> header;
+    put32(header, kMagic);
+    put32(header, kVersion);
+    put64(header, hashBytes(body.data(), body.size()));
+    put64(header, source.size);
+    put64(header, static_cast<uint64_t>(source.mtime));
+    put32(header, static_cast<uint32_t>(strings.size()));
+    put32(header, static_cast<uint32_t>(projects.size()));
+    put32(header, stringDataSize);
+    put32(header, 0);
+
+    std::string contents(header.begin(), header.end());
+    contents.append(body.begin(), body.end());
+    return writeFileAtomic(path, contents);
+}
+
+std::optional<std::vector<Project>> ProjectSnapshot::read(const std::filesystem::path& path, SourceStamp* source)
+{
+    TRACE_SCOPE("Read snapshot", "projects");
+    MappedFile file;
+    if (!file.open(path) || file.size() < kHeaderSize)
+        return std::nullopt;
+
+    const unsigned char* data = file.data();
+    if (get32(data) != kMagic || get32(data + 4) != kVersion)
+    {
+        spdlog::info("Ignoring project snapshot with unknown format: {}", path.string());
+        return std::nullopt;
+    }
+
+    uint64_t checksum = get64(data + 8);
+    uint64_t stringCount = get32(data + 32);
+    uint64_t projectCount = get32(data + 36);
+    uint64_t stringDataSize = get32(data + 40);
+
+    const unsigned char* body = data + kHeaderSize;
+    size_t bodySize = file.size() - kHeaderSize;
+    uint64_t expectedSize = stringCount * 8 + stringDataSize + projectCount * kFieldsPerProject * 4;
+    if (bodySize != expectedSize || hashBytes(body, bodySize) != checksum)
+    {
+        spdlog::warn("Project snapshot is corrupted, ignoring it: {}", path.string());
+        return std::nullopt;
+    }
+
+    const unsigned char* table = body;
+    const char* stringData = reinterpret_cast<const char*>(body + stringCount * 8);
+    const unsigned char* records = body + stringCount * 8 + stringDataSize;
+
+    std::vector<std::string_view> strings;
+    strings.reserve(stringCount);
+    for (uint64_t i = 0; i < stringCount; ++i)
+    {
+        uint64_t offset = get32(table + i * 8);
+        uint64_t length = get32(table + i * 8 + 4);
+        if (offset + length > stringDataSize)
+            return std::nullopt;
+        strings.emplace_back(stringData + offset, length);
+    }
+
+    bool valid = true;
+    auto field = [&](const unsigned char* record, size_t index)
+    {
+        uint32_t value = get32(record + index * 4);
+        if (value >= strings.size())
+        {
+            valid = false;
+            return std::string_view();
+        }
+        return strings[value];
+    };
+
+    std::vector<Project> projects(projectCount);
+    for (uint64_t i = 0; i < projectCount; ++i)
+    {
+        const unsigned char* record = records + i * kFieldsPerProject * 4;
+        auto& proj = projects[i];
+        proj.name = field(record, 0);
+        proj.path = field(record, 1);
+        proj.uprojectPath = field(record, 2);
+        proj.engineVersion = field(record, 3);
+        if (get32(record + 16) != kNoString)
+        {
+            proj.iconPath = std::filesystem::path(field(record, 4));
+        }
+        proj.commandLineArgs = field(record, 5);
+    }
+
+    if (!valid)
+        return std::nullopt;
+
+    if (source)
+    {
+        source->size = get64(data + 16);
+        source->mtime = static_cast<int64_t>(get64(data + 24));
+    }
+    return projects;
+}
+
+} // namespace unreal
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "project.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace unreal
+{
+
+// Size and modification time of the JSON file a snapshot was built from
+struct SourceStamp
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+
+    bool operator==(const SourceStamp& other) const
+    {
+        return size == other.size && mtime == other.mtime;
+    }
+
+    static std::optional<SourceStamp> fromFile(const std::filesystem::path& path);
+};
+
+// Compact binary copy of projects.json, memory mapped at startup so the project list can be shown
+// without parsing JSON. Layout (little endian):
+//   header | string table (offset, length) | string data | project records (string indices)
+// Strings are interned, the body is covered by a checksum and the version is bumped on any change.
+class ProjectSnapshot
+{
+  public:
+    static constexpr uint32_t kMagic = 0x534C5549; // "IULS"
+    static constexpr uint32_t kVersion = 1;
+
+    static std::filesystem::path pathFor(const std::filesystem::path& configPath);
+
+    static bool write(const std::vector<Project>& projects, const std::filesystem::path& path,
+                      const SourceStamp& source);
+    static std::optional<std::vector<Project>> read(const std::filesystem::path& path, SourceStamp* source = nullptr);
+};
+
+} // namespace unreal
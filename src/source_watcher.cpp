@@ -0,0 +1,260 @@
+#include "source_watcher.h"
+#include "trace.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+// IDEs save several files, then sometimes the same ones again, within a few hundred milliseconds
+constexpr std::chrono::milliseconds kSettleDelay{750};
+constexpr std::chrono::milliseconds kPollInterval{250};
+#ifndef __linux__
+constexpr std::chrono::milliseconds kRescanInterval{2000};
+#endif
+
+int64_t currentTime()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+SourceWatcher::SourceWatcher(BuildQueue& queue, BuildJob build, LogCallback callback)
+    : m_queue(queue), m_build(std::move(build)), m_logCallback(callback)
+{
+    m_build.kind = JobKind::Build;
+    m_build.replaceKey = "watch:" + m_build.uprojectPath.generic_string();
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        spdlog::warn("inotify unavailable, cannot watch {}", m_build.uprojectPath.string());
+    }
+#endif
+    for (const auto& root : getRoots())
+    {
+        addWatches(root);
+    }
+    m_thread = std::thread([this]() { watchLoop(); });
+}
+
+SourceWatcher::~SourceWatcher()
+{
+    m_quit = true;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if (m_jobId)
+    {
+        m_queue.cancel(m_jobId);
+    }
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+        close(m_inotify);
+    }
+#endif
+}
+
+WatchState SourceWatcher::getState() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state;
+}
+
+std::vector<std::filesystem::path> SourceWatcher::getRoots() const
+{
+    auto projectDir = m_build.uprojectPath.parent_path();
+    std::vector<std::filesystem::path> roots = {projectDir / "Source"};
+    std::error_code ec;
+    for (const auto& plugin : std::filesystem::directory_iterator(projectDir / "Plugins", ec))
+    {
+        if (plugin.is_directory(ec) && std::filesystem::is_directory(plugin.path() / "Source", ec))
+            roots.push_back(plugin.path() / "Source");
+    }
+    return roots;
+}
+
+bool SourceWatcher::isSourceFile(const std::string& name)
+{
+    // Editors' temporary and backup files end differently and are skipped
+    static const char* extensions[] = {".h", ".hpp", ".inl", ".cpp", ".c", ".cs"};
+    auto dot = name.rfind('.');
+    if (dot == std::string::npos)
+        return false;
+    auto extension = name.substr(dot);
+    return std::find_if(std::begin(extensions), std::end(extensions),
+                        [&extension](const char* candidate) { return extension == candidate; }) !=
+           std::end(extensions);
+}
+
+void SourceWatcher::addWatches(const std::filesystem::path& directory)
+{
+#ifdef __linux__
+    if (m_inotify < 0)
+        return;
+
+    // inotify is not recursive, every folder gets its own watch
+    std::error_code ec;
+    auto add = [this](const std::filesystem::path& path)
+    {
+        int wd = inotify_add_watch(m_inotify, path.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE |
+                                       IN_ONLYDIR);
+        if (wd >= 0)
+            m_watches[wd] = path;
+    };
+    if (!std::filesystem::is_directory(directory, ec))
+        return;
+    add(directory);
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (it->is_directory(ec))
+            add(it->path());
+    }
+#else
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (isSourceFile(it->path().filename().string()))
+            m_latestWrite = std::max(m_latestWrite, it->last_write_time(ec));
+    }
+#endif
+}
+
+bool SourceWatcher::waitForChanges(std::chrono::milliseconds timeout)
+{
+#ifdef __linux__
+    if (m_inotify < 0)
+    {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+
+    pollfd fd = {m_inotify, POLLIN, 0};
+    if (poll(&fd, 1, static_cast<int>(timeout.count())) <= 0)
+        return false;
+
+    bool changed = false;
+    alignas(inotify_event) char buffer[16384];
+    ssize_t length;
+    while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < length;)
+        {
+            auto* event = reinterpret_cast<inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED)
+            {
+                m_watches.erase(event->wd);
+                continue;
+            }
+            if (event->len == 0)
+                continue;
+
+            std::string name = event->name;
+            auto watch = m_watches.find(event->wd);
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && watch != m_watches.end())
+            {
+                // New module or folder, files created in it before the watch existed count as a change
+                addWatches(watch->second / name);
+                changed = true;
+            }
+            else if (!(event->mask & IN_ISDIR) && isSourceFile(name) && !(event->mask & IN_CREATE))
+            {
+                // Creation alone is followed by IN_CLOSE_WRITE once the file is written
+                changed = true;
+            }
+        }
+    }
+    return changed;
+#else
+    // Rescanning the tree is not free, poll less often than inotify would wake up
+    std::this_thread::sleep_for(std::max(timeout, kRescanInterval));
+    auto previous = m_latestWrite;
+    for (const auto& root : getRoots())
+    {
+        addWatches(root);
+    }
+    return m_latestWrite != previous;
+#endif
+}
+
+void SourceWatcher::watchLoop()
+{
+    auto lastChange = std::chrono::steady_clock::now();
+    bool pending = false;
+    bool cancelledStale = false;
+
+    while (!m_quit)
+    {
+        bool changed = waitForChanges(kPollInterval);
+        auto now = std::chrono::steady_clock::now();
+
+        if (changed)
+        {
+            lastChange = now;
+            pending = true;
+            if (m_jobId && !cancelledStale)
+            {
+                // The queued or running build compiles sources that no longer match, start over once edits settle
+                m_logCallback("Sources of " + m_build.projectName + " changed, cancelling stale build", false);
+                m_queue.cancel(m_jobId);
+                cancelledStale = true;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_jobId)
+                m_state.status = WatchStatus::Pending;
+        }
+
+        if (m_jobId)
+        {
+            auto state = m_queue.getJobState(m_jobId);
+            if (!state || (*state != JobState::Queued && *state != JobState::Running))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (cancelledStale)
+                {
+                    m_state.status = WatchStatus::Pending;
+                }
+                else if (state == JobState::Succeeded || state == JobState::Failed)
+                {
+                    m_state.status = state == JobState::Succeeded ? WatchStatus::Succeeded : WatchStatus::Failed;
+                    m_state.finishedAt = currentTime();
+                }
+                else
+                {
+                    // Cancelled or cleared in the queue
+                    m_state.status = pending ? WatchStatus::Pending : WatchStatus::Watching;
+                }
+                m_jobId = 0;
+                cancelledStale = false;
+            }
+        }
+
+        if (pending && !m_jobId && !m_paused && now - lastChange >= kSettleDelay)
+        {
+            TRACE_SCOPE("Watch build", "operations", m_build.uprojectPath.string());
+            pending = false;
+            m_logCallback("Queueing a build of " + m_build.projectName + " after source changes", false);
+            m_jobId = m_queue.enqueue(m_build);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_state.status = WatchStatus::Building;
+        }
+    }
+}
+
+} // namespace unreal
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "build_queue.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace unreal
+{
+
+enum class WatchStatus
+{
+    Watching,
+    // Sources changed, waiting for the edits to settle
+    Pending,
+    // Queued or running in the BuildQueue
+    Building,
+    Succeeded,
+    Failed
+};
+
+struct WatchState
+{
+    WatchStatus status = WatchStatus::Watching;
+    // Wall clock time of the last finished build, 0 before the first one
+    int64_t finishedAt = 0;
+};
+
+// Watches a project's Source/ and Plugins/*/Source folders and queues an incremental editor build once a
+// burst of saves has settled. The builds go through the BuildQueue, one at a time per project: a build made
+// stale by further edits is cancelled and queued again. Uses inotify on Linux and polls modification times
+// elsewhere.
+class SourceWatcher
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    // build names the project, engine and configuration of the queued builds, the queue must outlive the watcher
+    SourceWatcher(BuildQueue& queue, BuildJob build, LogCallback callback);
+    // Cancels the watch build, joining the watch thread can take up to a rescan of the sources
+    ~SourceWatcher();
+
+    SourceWatcher(const SourceWatcher&) = delete;
+    SourceWatcher& operator=(const SourceWatcher&) = delete;
+
+    WatchState getState() const;
+    // While paused changes are only collected, for manual operations on the project
+    void setPaused(bool paused)
+    {
+        m_paused = paused;
+    }
+
+  private:
+    void watchLoop();
+    // Blocks for up to timeout, true when a relevant source file changed
+    bool waitForChanges(std::chrono::milliseconds timeout);
+    void addWatches(const std::filesystem::path& directory);
+    std::vector<std::filesystem::path> getRoots() const;
+    static bool isSourceFile(const std::string& name);
+
+    BuildQueue& m_queue;
+    BuildJob m_build;
+    LogCallback m_logCallback;
+    // Queued or running watch build, 0 when none. Only touched by the watch thread.
+    uint64_t m_jobId = 0;
+    std::atomic<bool> m_paused{false};
+
+    mutable std::mutex m_mutex;
+    WatchState m_state;
+
+#ifdef __linux__
+    int m_inotify = -1;
+    std::unordered_map<int, std::filesystem::path> m_watches;
+#else
+    std::filesystem::file_time_type m_latestWrite;
+#endif
+
+    std::thread m_thread;
+    std::atomic<bool> m_quit{false};
+};
+
+} // namespace unreal
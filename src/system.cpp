@@ -0,0 +1,184 @@
+#include "system.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+#ifdef __linux__
+namespace
+{
+struct ProcessStat
+{
+    int pid = 0;
+    std::string comm;
+    int group = 0;
+    unsigned long long userTicks = 0;
+    unsigned long long systemTicks = 0;
+    long long residentPages = 0;
+};
+
+// Calls visit for every process of the group
+template <typename Visitor> void forEachInGroup(int processGroup, Visitor visit)
+{
+    if (processGroup <= 0)
+        return;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc", ec))
+    {
+        auto name = entry.path().filename().string();
+        if (name.empty() || !std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            continue;
+
+        std::ifstream file(entry.path() / "stat");
+        std::string line;
+        if (!std::getline(file, line))
+            continue;
+
+        // "<pid> (<comm>) <state> <ppid> <pgrp> ...", comm may contain spaces and parentheses
+        auto open = line.find('(');
+        auto close = line.rfind(')');
+        if (open == std::string::npos || close == std::string::npos || close < open)
+            continue;
+
+        ProcessStat stat;
+        stat.pid = std::stoi(name);
+        stat.comm = line.substr(open + 1, close - open - 1);
+        // Fields 3 to 24 of proc_pid_stat(5), utime and stime are 14 and 15, rss is 24
+        if (sscanf(line.c_str() + close + 1,
+                   " %*c %*d %d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %*u %*u %lld",
+                   &stat.group, &stat.userTicks, &stat.systemTicks, &stat.residentPages) != 4 ||
+            stat.group != processGroup)
+            continue;
+        visit(stat);
+    }
+}
+} // namespace
+#endif
+
+MachineCapacity readMachineCapacity()
+{
+    MachineCapacity capacity;
+    capacity.cores = std::max(1u, std::thread::hardware_concurrency());
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        capacity.cores = std::max(1, CPU_COUNT(&set));
+    }
+
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line))
+    {
+        std::istringstream stream(line);
+        std::string key;
+        uint64_t valueKb = 0;
+        stream >> key >> valueKb;
+        if (key == "MemTotal:")
+            capacity.memoryTotal = valueKb * 1024;
+        else if (key == "MemAvailable:")
+            capacity.memoryAvailable = valueKb * 1024;
+    }
+#endif
+
+    return capacity;
+}
+
+std::vector<std::vector<int>> readPhysicalCores()
+{
+    std::vector<std::vector<int>> cores;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        // Siblings share the same thread_siblings_list, e.g. "0,8" or "0-1"
+        std::vector<std::string> keys;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &set))
+                continue;
+
+            std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+            std::string key;
+            if (!std::getline(file, key))
+                key = std::to_string(cpu);
+
+            auto it = std::find(keys.begin(), keys.end(), key);
+            if (it == keys.end())
+            {
+                keys.push_back(key);
+                cores.push_back({cpu});
+            }
+            else
+            {
+                cores[static_cast<size_t>(it - keys.begin())].push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cores.empty())
+    {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+        {
+            cores.push_back({static_cast<int>(cpu)});
+        }
+    }
+    return cores;
+}
+
+ProcessGroupUsage readProcessGroupUsage(int processGroup)
+{
+    ProcessGroupUsage usage;
+#ifdef __linux__
+    static const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    forEachInGroup(processGroup,
+                   [&usage](const ProcessStat& stat)
+                   {
+                       usage.processes++;
+                       usage.cpuSeconds += static_cast<double>(stat.userTicks + stat.systemTicks) / ticksPerSecond;
+                       usage.residentBytes += static_cast<uint64_t>(std::max(0ll, stat.residentPages)) * pageSize;
+                   });
+#else
+    (void)processGroup;
+#endif
+    return usage;
+}
+
+int findProcessInGroup(int processGroup, std::initializer_list<const char*> names)
+{
+    int pid = 0;
+#ifdef __linux__
+    forEachInGroup(processGroup,
+                   [&](const ProcessStat& stat)
+                   {
+                       for (const char* name : names)
+                       {
+                           if (pid == 0 && stat.comm.compare(0, strlen(name), name) == 0)
+                               pid = stat.pid;
+                       }
+                   });
+#else
+    (void)processGroup;
+    (void)names;
+#endif
+    return pid;
+}
+
+} // namespace unreal
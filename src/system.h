@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace unreal
+{
+
+// Resources the launcher may hand out to child processes
+struct MachineCapacity
+{
+    unsigned cores = 1;
+    // 0 when the platform does not report it
+    uint64_t memoryTotal = 0;
+    uint64_t memoryAvailable = 0;
+};
+
+// Cores usable by this process (affinity aware) and memory from /proc/meminfo on Linux
+MachineCapacity readMachineCapacity();
+
+// Logical CPUs this process may run on, grouped by physical core (SMT siblings together), in CPU order.
+// One group per hardware thread where the topology is not available.
+std::vector<std::vector<int>> readPhysicalCores();
+
+// Summed over the live members of a process group
+struct ProcessGroupUsage
+{
+    size_t processes = 0;
+    // User and system time, in seconds
+    double cpuSeconds = 0.0;
+    uint64_t residentBytes = 0;
+};
+
+// From /proc/<pid>/stat on Linux, empty elsewhere
+ProcessGroupUsage readProcessGroupUsage(int processGroup);
+// First member of the group whose command name starts with one of the prefixes, 0 when there is none
+int findProcessInGroup(int processGroup, std::initializer_list<const char*> names);
+
+} // namespace unreal
@@ -0,0 +1,231 @@
+#include "targets.h"
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <regex>
+#include <spdlog/spdlog.h>
+
+namespace unreal
+{
+
+namespace
+{
+bool parseTargetType(const std::string& value, TargetType& type)
+{
+    static const std::pair<const char*, TargetType> types[] = {{"Game", TargetType::Game},
+                                                                 {"Editor", TargetType::Editor},
+                                                                 {"Client", TargetType::Client},
+                                                                 {"Server", TargetType::Server},
+                                                                 {"Program", TargetType::Program}};
+    for (const auto& [name, candidate] : types)
+    {
+        if (value == name)
+        {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+TargetDiscovery& TargetDiscovery::instance()
+{
+    static TargetDiscovery instance;
+    return instance;
+}
+
+std::string TargetDiscovery::targetTypeToString(TargetType type)
+{
+    switch (type)
+    {
+        case TargetType::Game:
+            return "Game";
+        case TargetType::Editor:
+            return "Editor";
+        case TargetType::Client:
+            return "Client";
+        case TargetType::Server:
+            return "Server";
+        case TargetType::Program:
+            return "Program";
+    }
+    return "Game";
+}
+
+std::vector<BuildTarget> TargetDiscovery::getTargets(const std::filesystem::path& uprojectPath)
+{
+    auto sourceDir = uprojectPath.parent_path() / "Source";
+    std::error_code ec;
+    auto sourceTime = std::filesystem::last_write_time(sourceDir, ec);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_cache[uprojectPath.string()];
+
+    // Adding or removing a target file touches the folder, editing one touches the file
+    if (!ec && entry.sourceTime == sourceTime && !entry.targets.empty() && isCurrent(entry.files))
+        return entry.targets;
+
+    TRACE_SCOPE("Discover targets", "io", uprojectPath.string());
+    entry = {};
+    if (!ec)
+    {
+        entry.sourceTime = sourceTime;
+        for (const auto& item : std::filesystem::directory_iterator(sourceDir, ec))
+        {
+            auto name = item.path().filename().string();
+            if (name.size() > 10 && name.compare(name.size() - 10, 10, ".Target.cs") == 0)
+                entry.files.emplace_back(item.path(), item.last_write_time(ec));
+        }
+        std::sort(entry.files.begin(), entry.files.end());
+    }
+
+    entry.targets = parseTargets(entry);
+    if (entry.targets.empty())
+    {
+        // Blueprint-only project, or the sources are not there yet
+        entry.targets.push_back({uprojectPath.stem().string() + "Editor", TargetType::Editor});
+    }
+    return entry.targets;
+}
+
+bool TargetDiscovery::isCurrent(const FileTimes& files)
+{
+    std::error_code ec;
+    for (const auto& [path, time] : files)
+    {
+        if (std::filesystem::last_write_time(path, ec) != time || ec)
+            return false;
+    }
+    return true;
+}
+
+std::vector<ProjectModule> TargetDiscovery::getModules(const std::filesystem::path& uprojectPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_moduleCache[uprojectPath.string()];
+    if (entry.files.empty() || !isCurrent(entry.files))
+        entry = scanModules(uprojectPath);
+    return entry.modules;
+}
+
+TargetDiscovery::ModuleCacheEntry TargetDiscovery::scanModules(const std::filesystem::path& uprojectPath)
+{
+    TRACE_SCOPE("Discover modules", "io", uprojectPath.string());
+    ModuleCacheEntry entry;
+    std::error_code ec;
+    auto sourceDir = uprojectPath.parent_path() / "Source";
+
+    entry.files.emplace_back(uprojectPath, std::filesystem::last_write_time(uprojectPath, ec));
+    try
+    {
+        std::ifstream file(uprojectPath);
+        nlohmann::json json;
+        file >> json;
+        for (const auto& item : json.value("Modules", nlohmann::json::array()))
+        {
+            ProjectModule module;
+            module.name = item.value("Name", "");
+            module.type = item.value("Type", "");
+            module.directory = sourceDir / module.name;
+            if (!module.name.empty())
+                entry.modules.push_back(std::move(module));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::warn("Failed to read modules from {}: {}", uprojectPath.string(), e.what());
+    }
+
+    // Modules without a .uproject entry still build when something depends on them
+    auto sourceTime = std::filesystem::last_write_time(sourceDir, ec);
+    if (!ec)
+    {
+        entry.files.emplace_back(sourceDir, sourceTime);
+        for (const auto& folder : std::filesystem::directory_iterator(sourceDir, ec))
+        {
+            if (!folder.is_directory(ec))
+                continue;
+
+            auto name = folder.path().filename().string();
+            entry.files.emplace_back(folder.path(), folder.last_write_time(ec));
+            auto buildFile = folder.path() / (name + ".Build.cs");
+            auto buildTime = std::filesystem::last_write_time(buildFile, ec);
+            if (ec)
+                continue;
+            entry.files.emplace_back(buildFile, buildTime);
+
+            auto known = std::find_if(entry.modules.begin(), entry.modules.end(),
+                                      [&name](const ProjectModule& module) { return module.name == name; });
+            if (known == entry.modules.end())
+                entry.modules.push_back({name, "", folder.path()});
+        }
+    }
+
+    std::sort(entry.modules.begin(), entry.modules.end(),
+              [](const ProjectModule& a, const ProjectModule& b) { return a.name < b.name; });
+    return entry;
+}
+
+std::vector<std::filesystem::path> TargetDiscovery::listSourceFiles(const ProjectModule& module)
+{
+    TRACE_SCOPE("List module sources", "io", module.name);
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(module.directory, ec), end;
+    for (; !ec && it != end; it.increment(ec))
+    {
+        auto extension = it->path().extension();
+        if ((extension == ".cpp" || extension == ".c") && it->is_regular_file(ec))
+            files.push_back(it->path().lexically_relative(module.directory));
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<BuildTarget> TargetDiscovery::parseTargets(const CacheEntry& entry)
+{
+    // public class FooEditorTarget : TargetRules ... Type = TargetType.Editor;
+    static const std::regex classPattern(R"(class\s+(\w+?)Target\s*:\s*TargetRules)");
+    static const std::regex typePattern(R"(\bType\s*=\s*TargetType\.(\w+))");
+
+    std::vector<BuildTarget> targets;
+    for (const auto& [path, time] : entry.files)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+            continue;
+
+        // Strip line comments so commented-out alternatives don't win
+        std::string contents;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            auto comment = line.find("//");
+            contents += (comment == std::string::npos ? line : line.substr(0, comment)) + "\n";
+        }
+
+        BuildTarget target;
+        std::smatch match;
+        if (std::regex_search(contents, match, classPattern))
+        {
+            target.name = match[1].str();
+        }
+        else
+        {
+            // Foo.Target.cs
+            auto name = path.filename().string();
+            target.name = name.substr(0, name.size() - 10);
+        }
+
+        if (std::regex_search(contents, match, typePattern) && !parseTargetType(match[1].str(), target.type))
+        {
+            spdlog::warn("Unknown target type {} in {}", match[1].str(), path.string());
+        }
+        targets.push_back(std::move(target));
+    }
+    return targets;
+}
+
+} // namespace unreal
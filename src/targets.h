@@ -0,0 +1,79 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unreal
+{
+
+enum class TargetType
+{
+    Game,
+    Editor,
+    Client,
+    Server,
+    Program
+};
+
+struct BuildTarget
+{
+    std::string name;
+    TargetType type = TargetType::Game;
+};
+
+struct ProjectModule
+{
+    std::string name;
+    // Runtime, Editor, ... from the .uproject, empty for modules only other modules depend on
+    std::string type;
+    std::filesystem::path directory;
+};
+
+// Discovers a project's UBT targets from Source/*.Target.cs and its modules from the .uproject and
+// Source/*/*.Build.cs. Results are cached per project and reused while the files they were read from keep
+// their modification times.
+class TargetDiscovery
+{
+  public:
+    static TargetDiscovery& instance();
+
+    // Falls back to the <Project>Editor target when the project has no target files
+    std::vector<BuildTarget> getTargets(const std::filesystem::path& uprojectPath);
+    std::vector<ProjectModule> getModules(const std::filesystem::path& uprojectPath);
+
+    // C++ sources of a module, relative to its directory
+    static std::vector<std::filesystem::path> listSourceFiles(const ProjectModule& module);
+
+    static std::string targetTypeToString(TargetType type);
+
+  private:
+    using FileTimes = std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>>;
+
+    struct CacheEntry
+    {
+        std::filesystem::file_time_type sourceTime;
+        FileTimes files;
+        std::vector<BuildTarget> targets;
+    };
+
+    struct ModuleCacheEntry
+    {
+        // The .uproject, the Source folder and every module folder and Build.cs
+        FileTimes files;
+        std::vector<ProjectModule> modules;
+    };
+
+    TargetDiscovery() = default;
+    static std::vector<BuildTarget> parseTargets(const CacheEntry& entry);
+    static bool isCurrent(const FileTimes& files);
+    static ModuleCacheEntry scanModules(const std::filesystem::path& uprojectPath);
+
+    std::unordered_map<std::string, CacheEntry> m_cache;
+    std::unordered_map<std::string, ModuleCacheEntry> m_moduleCache;
+    std::mutex m_mutex;
+};
+
+} // namespace unreal
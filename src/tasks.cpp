@@ -0,0 +1,95 @@
+#include "tasks.h"
+#include "trace.h"
+#include <spdlog/spdlog.h>
+
+namespace unreal
+{
+
+TaskGraph::~TaskGraph()
+{
+    waitAll();
+}
+
+TaskGraph::TaskId TaskGraph::add(const std::string& name, std::function<void()> work,
+                                 const std::vector<TaskId>& dependencies)
+{
+    Task task;
+    task.name = name;
+    task.work = work;
+    for (TaskId dep : dependencies)
+    {
+        if (dep < m_tasks.size())
+        {
+            task.dependencies.push_back(dep);
+        }
+        else
+        {
+            spdlog::error("Task '{}' depends on unknown task {}", name, dep);
+        }
+    }
+    m_tasks.push_back(task);
+    return m_tasks.size() - 1;
+}
+
+void TaskGraph::start()
+{
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        m_tasks[id].done = std::async(std::launch::async,
+                                      [this, id]()
+                                      {
+                                          auto& task = m_tasks[id];
+                                          for (TaskId dep : task.dependencies)
+                                          {
+                                              m_tasks[dep].done.wait();
+                                          }
+
+                                          auto start = std::chrono::steady_clock::now();
+                                          try
+                                          {
+                                              TraceScope scope(task.name.c_str(), "startup");
+                                              task.work();
+                                          }
+                                          catch (const std::exception& e)
+                                          {
+                                              spdlog::error("Startup task '{}' failed: {}", task.name, e.what());
+                                          }
+                                          task.durationMs = std::chrono::duration<double, std::milli>(
+                                                                std::chrono::steady_clock::now() - start)
+                                                                .count();
+                                          spdlog::debug("Task '{}' finished in {:.1f} ms", task.name,
+                                                        task.durationMs);
+                                      })
+                               .share();
+    }
+}
+
+void TaskGraph::wait(TaskId id)
+{
+    if (id < m_tasks.size() && m_tasks[id].done.valid())
+    {
+        m_tasks[id].done.wait();
+    }
+}
+
+void TaskGraph::waitAll()
+{
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        wait(id);
+    }
+}
+
+bool TaskGraph::isDone(TaskId id) const
+{
+    if (id >= m_tasks.size() || !m_tasks[id].done.valid())
+        return false;
+    return m_tasks[id].done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+double TaskGraph::getDurationMs(TaskId id) const
+{
+    return id < m_tasks.size() ? m_tasks[id].durationMs : 0.0;
+}
+
+} // namespace unreal
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace unreal
+{
+
+// Minimal dependency graph of background tasks. Each task starts as soon as the tasks it depends on
+// have finished, the caller keeps the current thread for work that must stay on it (window creation).
+class TaskGraph
+{
+  public:
+    using TaskId = size_t;
+
+    ~TaskGraph();
+
+    // Dependencies must refer to tasks added before this one, all tasks are added before start()
+    TaskId add(const std::string& name, std::function<void()> work, const std::vector<TaskId>& dependencies = {});
+
+    void start();
+    void wait(TaskId id);
+    void waitAll();
+    bool isDone(TaskId id) const;
+
+    // Time spent running the task itself, excluding the wait for its dependencies
+    double getDurationMs(TaskId id) const;
+
+  private:
+    struct Task
+    {
+        std::string name;
+        std::function<void()> work;
+        std::vector<TaskId> dependencies;
+        std::shared_future<void> done;
+        double durationMs = 0.0;
+    };
+
+    std::vector<Task> m_tasks;
+};
+
+} // namespace unreal
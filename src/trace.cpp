@@ -0,0 +1,204 @@
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+namespace unreal
+{
+
+namespace
+{
+const auto kEpoch = std::chrono::steady_clock::now();
+std::atomic<uint32_t> g_nextThreadId{1};
+
+uint32_t currentThreadId()
+{
+    thread_local uint32_t id = g_nextThreadId++;
+    return id;
+}
+
+void copyString(char* destination, size_t size, const char* source)
+{
+    size_t length = std::min(strlen(source), size - 1);
+    memcpy(destination, source, length);
+    destination[length] = '\0';
+}
+} // namespace
+
+// Gives the buffer back to the pool when its thread exits, events stay readable until it is reused or freed
+struct ThreadBufferHolder
+{
+    Trace::ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferHolder()
+    {
+        if (buffer)
+            Trace::instance().releaseBuffer(buffer);
+    }
+};
+
+Trace& Trace::instance()
+{
+    static Trace instance;
+    return instance;
+}
+
+uint64_t Trace::now()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kEpoch).count());
+}
+
+void Trace::setThreadName(const std::string& name)
+{
+    auto& trace = instance();
+    std::lock_guard<std::mutex> lock(trace.m_mutex);
+    trace.m_threadNames[currentThreadId()] = name;
+}
+
+Trace::ThreadBuffer* Trace::acquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& buffer : m_buffers)
+    {
+        bool expected = false;
+        if (buffer->inUse.compare_exchange_strong(expected, true))
+            return buffer.get();
+    }
+
+    m_buffers.push_back(std::make_unique<ThreadBuffer>());
+    m_buffers.back()->inUse = true;
+    return m_buffers.back().get();
+}
+
+void Trace::releaseBuffer(ThreadBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->inUse = false;
+
+    // A burst of short-lived threads would otherwise keep one buffer per thread forever
+    auto lastEvent = [](const ThreadBuffer& idle)
+    {
+        uint64_t count = idle.count.load(std::memory_order_acquire);
+        return count > 0 ? idle.events[(count - 1) % ThreadBuffer::kCapacity].start : 0;
+    };
+    size_t idle = 0;
+    auto stalest = m_buffers.end();
+    for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it)
+    {
+        if ((*it)->inUse)
+            continue;
+        idle++;
+        if (stalest == m_buffers.end() || lastEvent(**it) < lastEvent(**stalest))
+            stalest = it;
+    }
+    if (idle > kMaxIdleBuffers)
+        m_buffers.erase(stalest);
+}
+
+void Trace::record(const char* name, const char* category, uint64_t start, uint64_t end, const std::string& args)
+{
+    thread_local ThreadBufferHolder holder;
+    if (!holder.buffer)
+    {
+        holder.buffer = acquireBuffer();
+    }
+
+    auto* buffer = holder.buffer;
+    uint64_t index = buffer->count.load(std::memory_order_relaxed);
+    // Keeps the slot writes below from becoming visible before the previous count store, which the torn-slot
+    // check in dump relies on
+    std::atomic_thread_fence(std::memory_order_release);
+    auto& event = buffer->events[index % ThreadBuffer::kCapacity];
+    event.start = start;
+    event.duration = end > start ? end - start : 0;
+    event.threadId = currentThreadId();
+    copyString(event.name, sizeof(event.name), name);
+    copyString(event.category, sizeof(event.category), category);
+    copyString(event.args, sizeof(event.args), args.c_str());
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const std::filesystem::path& path)
+{
+    nlohmann::json events = nlohmann::json::array();
+
+    // Copied under the lock so a buffer cannot be freed while it is read, writers never take it
+    std::vector<TraceEvent> copy;
+    std::unordered_map<uint32_t, std::string> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& buffer : m_buffers)
+        {
+            uint64_t end = buffer->count.load(std::memory_order_acquire);
+            uint64_t begin = end > ThreadBuffer::kCapacity ? end - ThreadBuffer::kCapacity : 0;
+            size_t copied = copy.size();
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                copy.push_back(buffer->events[i % ThreadBuffer::kCapacity]);
+            }
+
+            // Drop the oldest events if the owner wrapped around while they were being copied. Event `after` may
+            // be half written, and it lives in the slot of event after - kCapacity. The fence keeps the plain slot
+            // reads above from moving after the count load, as in a seqlock reader.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = buffer->count.load(std::memory_order_relaxed);
+            uint64_t firstValid = after + 1 > ThreadBuffer::kCapacity ? after + 1 - ThreadBuffer::kCapacity : 0;
+            if (firstValid > begin)
+            {
+                auto stale = static_cast<std::ptrdiff_t>(std::min(firstValid, end) - begin);
+                copy.erase(copy.begin() + static_cast<std::ptrdiff_t>(copied),
+                           copy.begin() + static_cast<std::ptrdiff_t>(copied) + stale);
+            }
+        }
+        threadNames = m_threadNames;
+    }
+
+    size_t eventCount = 0;
+    for (const auto& event : copy)
+    {
+        nlohmann::json item;
+        item["name"] = event.name;
+        item["cat"] = event.category;
+        item["ph"] = "X";
+        item["ts"] = static_cast<double>(event.start) / 1000.0;
+        item["dur"] = static_cast<double>(event.duration) / 1000.0;
+        item["pid"] = 1;
+        item["tid"] = event.threadId;
+        if (event.args[0] != '\0')
+        {
+            item["args"]["detail"] = event.args;
+        }
+        events.push_back(item);
+        ++eventCount;
+    }
+
+    for (const auto& [id, name] : threadNames)
+    {
+        nlohmann::json item;
+        item["name"] = "thread_name";
+        item["ph"] = "M";
+        item["pid"] = 1;
+        item["tid"] = id;
+        item["args"]["name"] = name;
+        events.push_back(item);
+    }
+
+    nlohmann::json json;
+    json["traceEvents"] = events;
+    json["displayTimeUnit"] = "ms";
+
+    if (!writeFileAtomic(path, json.dump()))
+    {
+        spdlog::error("Failed to write trace: {}", path.string());
+        return false;
+    }
+
+    spdlog::info("Wrote {} trace events to {}", eventCount, path.string());
+    return true;
+}
+
+} // namespace unreal
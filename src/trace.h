@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unreal
+{
+
+struct TraceEvent
+{
+    uint64_t start = 0;    // ns since the trace epoch
+    uint64_t duration = 0; // ns
+    uint32_t threadId = 0;
+    char name[48] = {};
+    char category[16] = {};
+    char args[112] = {};
+};
+
+// Records spans into per-thread ring buffers and exports them as Chrome trace JSON (Perfetto, chrome://tracing).
+// Writers never lock: each thread owns its buffer and publishes events with a release store of the count.
+class Trace
+{
+  public:
+    static Trace& instance();
+
+    static uint64_t now();
+    static void setThreadName(const std::string& name);
+
+    void record(const char* name, const char* category, uint64_t start, uint64_t end, const std::string& args = "");
+
+    // Writes the events currently held by all buffers, returns false if the file cannot be written
+    bool dump(const std::filesystem::path& path);
+
+  private:
+    struct ThreadBuffer
+    {
+        static constexpr size_t kCapacity = 4096;
+        TraceEvent events[kCapacity];
+        std::atomic<uint64_t> count{0};
+        std::atomic<bool> inUse{false};
+    };
+
+    // Buffers of exited threads kept for their events, beyond this the stalest one is freed
+    static constexpr size_t kMaxIdleBuffers = 16;
+
+    Trace() = default;
+    ThreadBuffer* acquireBuffer();
+    void releaseBuffer(ThreadBuffer* buffer);
+
+    friend struct ThreadBufferHolder;
+
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::unordered_map<uint32_t, std::string> m_threadNames;
+    std::mutex m_mutex;
+};
+
+// Records a span covering the lifetime of the object
+class TraceScope
+{
+  public:
+    TraceScope(const char* name, const char* category = "launcher", std::string args = "")
+        : m_name(name), m_category(category), m_args(std::move(args)), m_start(Trace::now())
+    {
+    }
+    ~TraceScope()
+    {
+        Trace::instance().record(m_name, m_category, m_start, Trace::now(), m_args);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    const char* m_name;
+    const char* m_category;
+    std::string m_args;
+    uint64_t m_start;
+};
+
+} // namespace unreal
+
+// Records a span until the end of the enclosing block: TRACE_SCOPE("name"[, "category"[, args]])
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(...) ::unreal::TraceScope TRACE_CONCAT(traceScope_, __LINE__)(__VA_ARGS__)
@@ -0,0 +1,486 @@
+#include "trash.h"
+#include "config.h"
+#include "trace.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace unreal
+{
+
+namespace
+{
+const char* kTrashDirName = ".ImUnrealLauncher-Trash";
+
+#ifndef _WIN32
+// $XDG_DATA_HOME/ImUnrealLauncher/Trash, the fallback when no ancestor of a folder is writable. Never inside the
+// project, where the trash would show up in source control and project scans until it is drained.
+std::filesystem::path getUserTrashRoot()
+{
+    std::filesystem::path data;
+    if (const char* xdg = getenv("XDG_DATA_HOME"); xdg && *xdg)
+        data = xdg;
+    else if (const char* home = getenv("HOME"); home && *home)
+        data = std::filesystem::path(home) / ".local" / "share";
+    else
+        return {};
+    return data / "ImUnrealLauncher" / "Trash";
+}
+
+// Nearest existing ancestor of path is on the given device
+bool isOnDevice(std::filesystem::path path, dev_t device)
+{
+    struct stat st;
+    while (stat(path.c_str(), &st) != 0)
+    {
+        if (!path.has_parent_path() || path.parent_path() == path)
+            return false;
+        path = path.parent_path();
+    }
+    return st.st_dev == device;
+}
+
+void lowerThreadPriority()
+{
+#ifdef __linux__
+    // Both calls only affect the calling thread on Linux
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, tid, 19);
+
+    constexpr int ioprioWhoProcess = 1;
+    constexpr int ioprioClassIdle = 3;
+    constexpr int ioprioClassShift = 13;
+    syscall(SYS_ioprio_set, ioprioWhoProcess, static_cast<int>(tid), ioprioClassIdle << ioprioClassShift);
+#endif
+}
+#endif
+} // namespace
+
+TrashDeleter& TrashDeleter::instance()
+{
+    static TrashDeleter instance;
+    return instance;
+}
+
+TrashDeleter::TrashDeleter()
+{
+    m_thread = std::thread([this]() { deleterLoop(); });
+}
+
+TrashDeleter::~TrashDeleter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_cancelled = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void TrashDeleter::setLogCallback(LogCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    m_logCallback = callback;
+}
+
+void TrashDeleter::log(const std::string& message, bool isError)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        if (m_logCallback)
+        {
+            m_logCallback(message, isError);
+        }
+    }
+    if (isError)
+    {
+        spdlog::error("{}", message);
+    }
+    else
+    {
+        spdlog::info("{}", message);
+    }
+}
+
+std::filesystem::path TrashDeleter::getTrashRoot(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    auto current = std::filesystem::absolute(path, ec).parent_path();
+
+#ifdef _WIN32
+    return current.root_path() / kTrashDirName;
+#else
+    struct stat st;
+    if (stat(current.c_str(), &st) != 0)
+    {
+        return {};
+    }
+
+    // Pick the highest writable ancestor that still lives on the same volume, so a
+    // rename into it never crosses a filesystem boundary. The folder holding the path is
+    // not a candidate, for a project folder that would put the trash inside the project.
+    std::filesystem::path best;
+    while (current.has_parent_path() && current.parent_path() != current)
+    {
+        auto parent = current.parent_path();
+        struct stat parentSt;
+        if (stat(parent.c_str(), &parentSt) != 0 || parentSt.st_dev != st.st_dev)
+            break;
+        if (access(parent.c_str(), W_OK) == 0)
+            best = parent;
+        current = parent;
+    }
+    if (best.empty())
+        return {};
+    return best / (std::string(kTrashDirName) + "-" + std::to_string(getuid()));
+#endif
+}
+
+bool TrashDeleter::moveToTrash(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+        return false;
+
+    auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+
+    std::vector<std::filesystem::path> roots = {getTrashRoot(path)};
+#ifndef _WIN32
+    // A rename cannot cross devices, the per-user trash only helps when it lives on the same one
+    struct stat st;
+    auto userRoot = getUserTrashRoot();
+    if (!userRoot.empty() && stat(path.c_str(), &st) == 0 && isOnDevice(userRoot, st.st_dev))
+        roots.push_back(userRoot);
+#endif
+    for (const auto& root : roots)
+    {
+        if (root.empty())
+            continue;
+        std::filesystem::create_directories(root, ec);
+        if (ec)
+            continue;
+
+        std::filesystem::path target;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            target = root / (std::to_string(stamp) + "-" + std::to_string(m_counter++) + "-" +
+                             path.filename().string());
+        }
+
+        std::filesystem::rename(path, target, ec);
+        if (!ec)
+        {
+            rememberRoot(root);
+            enqueue(target);
+            return true;
+        }
+    }
+
+    // The caller deletes in place instead
+    log("Could not move " + path.string() + " to trash (" + (ec ? ec.message() : "no trash on its volume") +
+        "), deleting it in place");
+    return false;
+}
+
+void TrashDeleter::rememberRoot(const std::filesystem::path& root)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_roots.empty())
+    {
+        // Merge with roots registered by previous sessions
+        try
+        {
+            std::ifstream file(Config::instance().getTrashRegistryPath());
+            if (file.is_open())
+            {
+                nlohmann::json json;
+                file >> json;
+                for (const auto& item : json["roots"])
+                {
+                    m_roots.push_back(item.get<std::string>());
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::warn("Failed to read trash registry: {}", e.what());
+        }
+    }
+
+    if (std::find(m_roots.begin(), m_roots.end(), root) != m_roots.end())
+        return;
+
+    m_roots.push_back(root);
+
+    nlohmann::json json;
+    json["roots"] = nlohmann::json::array();
+    for (const auto& r : m_roots)
+    {
+        json["roots"].push_back(r.string());
+    }
+    std::ofstream file(Config::instance().getTrashRegistryPath());
+    if (file.is_open())
+    {
+        file << json.dump(4);
+    }
+}
+
+void TrashDeleter::resume()
+{
+    std::vector<std::filesystem::path> roots;
+    try
+    {
+        std::ifstream file(Config::instance().getTrashRegistryPath());
+        if (!file.is_open())
+            return;
+
+        nlohmann::json json;
+        file >> json;
+        for (const auto& item : json["roots"])
+        {
+            roots.push_back(item.get<std::string>());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log("Failed to read trash registry: " + std::string(e.what()), true);
+        return;
+    }
+
+    size_t count = 0;
+    for (const auto& root : roots)
+    {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(root, ec))
+        {
+            enqueue(entry.path());
+            ++count;
+        }
+    }
+
+    if (count > 0)
+    {
+        log("Resuming deletion of " + std::to_string(count) + " leftover trash item(s)");
+    }
+}
+
+void TrashDeleter::enqueue(const std::filesystem::path& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(path);
+    }
+    m_condition.notify_all();
+}
+
+void TrashDeleter::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_busy || !m_pending.empty())
+    {
+        m_pending.clear();
+        m_cancelled = true;
+        log("Trash deletion stopped, it will resume on next start");
+    }
+}
+
+TrashProgress TrashDeleter::getProgress() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TrashProgress progress;
+    progress.filesDeleted = m_filesDeleted;
+    progress.bytesDeleted = m_bytesDeleted;
+    progress.pendingItems = m_pending.size();
+    progress.running = m_busy || !m_pending.empty();
+    return progress;
+}
+
+void TrashDeleter::deleterLoop()
+{
+    Trace::setThreadName("Trash deleter");
+#ifndef _WIN32
+    lowerThreadPriority();
+#endif
+
+    while (true)
+    {
+        std::filesystem::path item;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_quit || !m_pending.empty(); });
+            if (m_quit)
+                return;
+
+            if (!m_busy)
+            {
+                m_filesDeleted = 0;
+                m_bytesDeleted = 0;
+            }
+            item = m_pending.front();
+            m_pending.pop_front();
+            m_busy = true;
+            m_cancelled = false;
+        }
+
+        deleteTree(item);
+
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            drained = m_pending.empty() && !m_cancelled;
+            if (m_pending.empty())
+                m_busy = false;
+        }
+
+        if (drained)
+        {
+            log("Trash emptied: " + std::to_string(m_filesDeleted.load()) + " files, " +
+                formatBytes(m_bytesDeleted.load()));
+        }
+    }
+}
+
+void TrashDeleter::deleteTree(const std::filesystem::path& path)
+{
+    TRACE_SCOPE("Delete trash", "trash", path.string());
+#ifdef _WIN32
+    std::error_code ec;
+    auto removed = std::filesystem::remove_all(path, ec);
+    if (removed != static_cast<std::uintmax_t>(-1))
+        m_filesDeleted += removed;
+#else
+    struct stat rootSt;
+    if (lstat(path.c_str(), &rootSt) != 0)
+        return;
+
+    if (!S_ISDIR(rootSt.st_mode))
+    {
+        if (unlink(path.c_str()) == 0)
+        {
+            m_filesDeleted++;
+            m_bytesDeleted += static_cast<uint64_t>(rootSt.st_size);
+        }
+        return;
+    }
+
+    // Directories are processed by a worker pool sharing a single queue. Files are unlinked as
+    // they are found; directories are removed deepest first once the queue has drained.
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::pair<size_t, std::string>> queue = {{0, path.string()}};
+    std::vector<std::pair<size_t, std::string>> directories;
+    size_t active = 0;
+
+    auto worker = [&]()
+    {
+        lowerThreadPriority();
+
+        while (true)
+        {
+            std::pair<size_t, std::string> dir;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return !queue.empty() || active == 0 || m_cancelled; });
+                if (queue.empty() || m_cancelled)
+                    return;
+                dir = std::move(queue.back());
+                queue.pop_back();
+                directories.push_back(dir);
+                ++active;
+            }
+
+            std::vector<std::pair<size_t, std::string>> subdirs;
+            int fd = open(dir.second.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            DIR* handle = fd >= 0 ? fdopendir(fd) : nullptr;
+            if (handle)
+            {
+                while (dirent* entry = readdir(handle))
+                {
+                    if (m_cancelled)
+                        break;
+
+                    const char* name = entry->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                        continue;
+
+                    struct stat st;
+                    bool isDir = entry->d_type == DT_DIR;
+                    off_t size = 0;
+                    if (!isDir && fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                    {
+                        isDir = S_ISDIR(st.st_mode);
+                        size = st.st_size;
+                    }
+
+                    if (isDir)
+                    {
+                        subdirs.push_back({dir.first + 1, dir.second + "/" + name});
+                    }
+                    else if (unlinkat(fd, name, 0) == 0)
+                    {
+                        m_filesDeleted++;
+                        m_bytesDeleted += static_cast<uint64_t>(size);
+                    }
+                }
+                closedir(handle);
+            }
+            else if (fd >= 0)
+            {
+                close(fd);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& sub : subdirs)
+                {
+                    queue.push_back(std::move(sub));
+                }
+                --active;
+            }
+            condition.notify_all();
+        }
+    };
+
+    size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+
+    if (m_cancelled)
+        return;
+
+    std::sort(directories.begin(), directories.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& [depth, dir] : directories)
+    {
+        rmdir(dir.c_str());
+    }
+#endif
+}
+
+} // namespace unreal
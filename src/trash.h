@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace unreal
+{
+
+struct TrashProgress
+{
+    uint64_t filesDeleted = 0;
+    uint64_t bytesDeleted = 0;
+    size_t pendingItems = 0;
+    bool running = false;
+};
+
+// Moves folders out of a project with a single rename, then deletes them in the background
+// using a low priority worker pool. Leftover trash is picked up again on the next start.
+class TrashDeleter
+{
+  public:
+    using LogCallback = std::function<void(const std::string&, bool)>;
+
+    static TrashDeleter& instance();
+
+    void setLogCallback(LogCallback callback);
+
+    // Renames the path into the trash of its volume, or the per-user trash when that is on the same volume, and
+    // queues it for deletion. Returns false if the path could not be moved (it is left untouched in that case).
+    bool moveToTrash(const std::filesystem::path& path);
+
+    // Queues every leftover entry of the known trash directories.
+    void resume();
+
+    // Stops the current deletion, remaining trash is resumed on the next start.
+    void cancel();
+
+    TrashProgress getProgress() const;
+
+    // Trash on the volume of path outside the folder holding it, empty when no such folder is writable
+    static std::filesystem::path getTrashRoot(const std::filesystem::path& path);
+
+  private:
+    TrashDeleter();
+    ~TrashDeleter();
+
+    void log(const std::string& message, bool isError = false);
+    void enqueue(const std::filesystem::path& path);
+    void rememberRoot(const std::filesystem::path& root);
+    void deleterLoop();
+    void deleteTree(const std::filesystem::path& path);
+
+    std::deque<std::filesystem::path> m_pending;
+    std::vector<std::filesystem::path> m_roots;
+    mutable std::mutex m_mutex;
+    std::mutex m_logMutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    LogCallback m_logCallback;
+    uint64_t m_counter = 0;
+    bool m_busy = false;
+    bool m_quit = false;
+
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<uint64_t> m_filesDeleted{0};
+    std::atomic<uint64_t> m_bytesDeleted{0};
+};
+
+} // namespace unreal
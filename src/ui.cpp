@@ -1,5 +1,11 @@
 #include "ui.h"
 #include "config.h"
+#include "editor_supervisor.h"
+#include "package_diff.h"
+#include "prefetch.h"
+#include "targets.h"
+#include "trace.h"
+#include "trash.h"
 
 #include <GLFW/glfw3.h>
 #include <imgui.h>
@@ -11,6 +17,9 @@
 #include <stb_image.h>
 
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <ctime>
 
 namespace unreal
 {
@@ -71,23 +80,7 @@ bool UI::init()
     // Initialize operations
     m_operations =
         std::make_unique<ProjectOperations>([this](const std::string& msg, bool isError) { log(msg, isError); });
-
-    // Load default icon
-    auto defaultIconPath = Config::instance().getResourcesPath() / "default_icon.png";
-    if (std::filesystem::exists(defaultIconPath))
-    {
-        int width, height, channels;
-        unsigned char* data = stbi_load(defaultIconPath.string().c_str(), &width, &height, &channels, 4);
-        if (data)
-        {
-            glGenTextures(1, &m_defaultIcon);
-            glBindTexture(GL_TEXTURE_2D, m_defaultIcon);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-    }
+    m_buildQueue = std::make_unique<BuildQueue>([this](const std::string& msg, bool isError) { log(msg, isError); });
 
     spdlog::info("UI initialized successfully");
     return true;
@@ -95,6 +88,24 @@ bool UI::init()
 
 void UI::shutdown()
 {
+    if (!m_window)
+        return;
+
+    for (auto& [name, load] : m_iconLoads)
+    {
+        load.wait();
+    }
+    m_iconLoads.clear();
+
+    // Cancels queued and running jobs and waits for their processes to exit, watchers use the queue until they stop
+    m_watchers.clear();
+    for (auto& teardown : m_watcherTeardowns)
+    {
+        teardown.wait();
+    }
+    m_watcherTeardowns.clear();
+    m_buildQueue.reset();
+
     // Clean up textures
     for (auto& [name, tex] : m_projectIcons)
     {
@@ -137,27 +148,90 @@ void UI::log(const std::string& message, bool isError)
     m_logDirty = true;
 }
 
+UI::Image UI::decodeImage(const std::filesystem::path& path)
+{
+    TRACE_SCOPE("Decode icon", "icons", path.string());
+    Image image;
+    int channels;
+    unsigned char* data = stbi_load(path.string().c_str(), &image.width, &image.height, &channels, 4);
+    if (data)
+    {
+        image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
+        stbi_image_free(data);
+    }
+    return image;
+}
+
+GLuint UI::createTexture(const Image& image)
+{
+    if (image.pixels.empty())
+        return 0;
+
+    TRACE_SCOPE("Upload icon", "icons");
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 image.pixels.data());
+    return texture;
+}
+
+void UI::decodeDefaultIcon()
+{
+    auto defaultIconPath = Config::instance().getResourcesPath() / "default_icon.png";
+    if (std::filesystem::exists(defaultIconPath))
+    {
+        m_defaultIconImage = decodeImage(defaultIconPath);
+    }
+}
+
 void UI::loadProjectIcon(const Project& project)
 {
     if (m_projectIcons.count(project.name))
         return;
 
-    GLuint texture = 0;
-    if (project.iconPath && std::filesystem::exists(*project.iconPath))
+    // The default icon is shown until the decoded image is uploaded
+    m_projectIcons[project.name] = 0;
+    if (project.iconPath)
+    {
+        m_iconQueue.emplace_back(project.name, *project.iconPath);
+    }
+}
+
+void UI::uploadDecodedIcons()
+{
+    if (!m_defaultIconImage.pixels.empty())
+    {
+        m_defaultIcon = createTexture(m_defaultIconImage);
+        m_defaultIconImage = Image();
+    }
+
+    for (auto it = m_iconLoads.begin(); it != m_iconLoads.end();)
     {
-        int width, height, channels;
-        unsigned char* data = stbi_load(project.iconPath->string().c_str(), &width, &height, &channels, 4);
-        if (data)
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        auto image = it->second.get();
+        auto icon = m_projectIcons.find(it->first);
+        if (icon != m_projectIcons.end() && icon->second == 0)
         {
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
+            icon->second = createTexture(image);
         }
+        it = m_iconLoads.erase(it);
+    }
+
+    // A few decodes at a time, a large library must not start a thread per project
+    while (!m_iconQueue.empty() && m_iconLoads.size() < kMaxIconDecodes)
+    {
+        auto [name, path] = std::move(m_iconQueue.front());
+        m_iconQueue.pop_front();
+        m_iconLoads.emplace_back(name, std::async(std::launch::async, decodeImage, path));
     }
-    m_projectIcons[project.name] = texture;
 }
 
 GLuint UI::getProjectIcon(const std::string& projectName)
@@ -172,8 +246,12 @@ GLuint UI::getProjectIcon(const std::string& projectName)
 
 void UI::render()
 {
+    TRACE_SCOPE("UI::render", "ui");
+
     glfwPollEvents();
 
+    uploadDecodedIcons();
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -225,8 +303,25 @@ void UI::render()
     {
         renderAddProjectWindow();
     }
+    if (m_showBuildQueueWindow)
+    {
+        renderBuildQueueWindow();
+    }
+    if (m_showEditorsWindow)
+    {
+        renderEditorsWindow();
+    }
+    if (m_showBuildTimelineWindow)
+    {
+        renderBuildTimelineWindow();
+    }
+    if (m_showPackageMatrixWindow)
+    {
+        renderPackageMatrixWindow();
+    }
 
     // Rendering
+    TRACE_SCOPE("Present", "ui");
     ImGui::Render();
     int displayW, displayH;
     glfwGetFramebufferSize(m_window, &displayW, &displayH);
@@ -271,111 +366,219 @@ void UI::renderMenuBar()
             }
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("Queue"))
+        {
+            if (ImGui::MenuItem("Build Queue..."))
+            {
+                m_showBuildQueueWindow = true;
+            }
+            if (ImGui::MenuItem("Running Editors..."))
+            {
+                m_showEditorsWindow = true;
+            }
+            ImGui::Separator();
+            if (ImGui::MenuItem("Queue Build for All Projects", nullptr, false, m_projectManager != nullptr))
+            {
+                for (const auto& project : m_projectManager->getProjects())
+                {
+                    if (!project.missing)
+                        queueJob(project, JobKind::Build);
+                }
+                m_showBuildQueueWindow = true;
+            }
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Help"))
+        {
+            if (ImGui::MenuItem("Save Performance Trace"))
+            {
+                saveTrace();
+            }
+            ImGui::EndMenu();
+        }
         ImGui::EndMainMenuBar();
     }
 }
 
+void UI::saveTrace()
+{
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+
+    auto path = Config::instance().getTracesDirectory() / ("launcher-" + std::string(stamp) + ".json");
+    if (Trace::instance().dump(path))
+    {
+        log("Saved performance trace to " + path.string() + " (open it with ui.perfetto.dev)");
+    }
+    else
+    {
+        log("Failed to save performance trace to " + path.string(), true);
+    }
+}
+
 void UI::renderProjectList()
 {
+    TRACE_SCOPE("renderProjectList", "ui");
     ImGui::Text("Projects");
     ImGui::Separator();
 
     if (!m_projectManager)
         return;
 
+    // The project list was reallocated, resolve the selection again
+    if (m_projectManager->getGeneration() != m_projectsGeneration)
+    {
+        m_projectsGeneration = m_projectManager->getGeneration();
+        m_selectedProject =
+            m_selectedProjectName.empty() ? nullptr : m_projectManager->findProject(m_selectedProjectName);
+    }
+
     const auto& projects = m_projectManager->getProjects();
     bool operationRunning = m_operations && m_operations->isRunning();
-
-    for (size_t i = 0; i < projects.size(); ++i)
+    for (auto& [name, watcher] : m_watchers)
     {
-        const auto& project = projects[i];
+        watcher->setPaused(operationRunning && name == m_operationProject);
+    }
 
-        // Load icon if not loaded
-        loadProjectIcon(project);
+    // Only the visible rows are laid out and request their icon
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(projects.size()));
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+        {
+            const auto& project = projects[i];
 
-        ImGui::PushID(static_cast<int>(i));
+            // Load icon if not loaded
+            loadProjectIcon(project);
 
-        // Create selectable item with icon
-        bool isSelected = (m_selectedProject && m_selectedProject->name == project.name);
+            ImGui::PushID(static_cast<int>(i));
 
-        ImVec2 itemSize(ImGui::GetContentRegionAvail().x, 50);
-        ImVec2 cursorPos = ImGui::GetCursorScreenPos();
+            // Create selectable item with icon
+            bool isSelected = (m_selectedProject && m_selectedProject->name == project.name);
 
-        // Disable selection while operation is running
-        ImGuiSelectableFlags flags = ImGuiSelectableFlags_None;
-        if (operationRunning)
-        {
-            flags |= ImGuiSelectableFlags_Disabled;
-        }
+            ImVec2 itemSize(ImGui::GetContentRegionAvail().x, 50);
+            ImVec2 cursorPos = ImGui::GetCursorScreenPos();
 
-        if (ImGui::Selectable("##project", isSelected, flags, itemSize))
-        {
-            m_selectedProject = m_projectManager->findProject(project.name);
+            // Disable selection while operation is running
+            ImGuiSelectableFlags flags = ImGuiSelectableFlags_None;
+            if (operationRunning)
+            {
+                flags |= ImGuiSelectableFlags_Disabled;
+            }
 
-            // Update engine index
-            if (m_engineManager && m_selectedProject)
+            if (ImGui::Selectable("##project", isSelected, flags, itemSize))
             {
-                const auto& engines = m_engineManager->getVersions();
-                for (size_t j = 0; j < engines.size(); ++j)
+                m_selectedProject = m_projectManager->findProject(project.name);
+                m_selectedProjectName = project.name;
+
+                // Update engine index
+                if (m_engineManager && m_selectedProject)
                 {
-                    if (engines[j].name == m_selectedProject->engineVersion)
+                    const auto& engines = m_engineManager->getVersions();
+                    for (size_t j = 0; j < engines.size(); ++j)
                     {
-                        m_selectedEngineIndex = static_cast<int>(j);
-                        break;
+                        if (engines[j].name == m_selectedProject->engineVersion)
+                        {
+                            m_selectedEngineIndex = static_cast<int>(j);
+                            // Warm the page cache while the user gets to the launch button
+                            EditorPrefetcher::instance().prefetch(engines[j].path);
+                            break;
+                        }
                     }
                 }
-            }
 
-            // Load command line args
-            if (m_selectedProject)
-            {
-                strncpy(m_commandLineArgs, m_selectedProject->commandLineArgs.c_str(), sizeof(m_commandLineArgs) - 1);
-                m_commandLineArgs[sizeof(m_commandLineArgs) - 1] = '\0';
+                // Load command line args
+                if (m_selectedProject)
+                {
+                    strncpy(m_commandLineArgs, m_selectedProject->commandLineArgs.c_str(),
+                            sizeof(m_commandLineArgs) - 1);
+                    m_commandLineArgs[sizeof(m_commandLineArgs) - 1] = '\0';
+                }
             }
-        }
 
-        // Double-click to launch (only if not running)
-        if (!operationRunning && ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0))
-        {
-            if (m_engineManager && m_selectedProject)
+            // Double-click to launch (only if not running and the project file still exists)
+            if (!operationRunning && !project.missing && ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0))
             {
-                auto* engine = m_engineManager->findVersion(m_selectedProject->engineVersion);
-                if (engine)
+                if (m_engineManager && m_selectedProject)
                 {
-                    m_operations->run(engine->path, m_selectedProject->uprojectPath,
-                                      m_selectedProject->commandLineArgs);
+                    auto* engine = m_engineManager->findVersion(m_selectedProject->engineVersion);
+                    if (engine)
+                    {
+                        m_operations->run(engine->path, m_selectedProject->uprojectPath,
+                                          m_selectedProject->commandLineArgs);
+                        m_showEditorsWindow = true;
+                    }
                 }
             }
-        }
 
-        // Draw content over the selectable
-        ImGui::SetCursorScreenPos(cursorPos);
+            // Draw content over the selectable
+            ImGui::SetCursorScreenPos(cursorPos);
 
-        // Icon
-        GLuint icon = getProjectIcon(project.name);
-        if (icon)
-        {
-            ImGui::Image(static_cast<ImTextureID>(icon), ImVec2(40, 40));
-        }
-        else
-        {
-            ImGui::Dummy(ImVec2(40, 40));
-        }
+            // Icon
+            GLuint icon = getProjectIcon(project.name);
+            if (icon)
+            {
+                ImGui::Image(static_cast<ImTextureID>(icon), ImVec2(40, 40));
+            }
+            else
+            {
+                ImGui::Dummy(ImVec2(40, 40));
+            }
 
-        ImGui::SameLine();
+            ImGui::SameLine();
 
-        // Text
-        ImGui::BeginGroup();
-        ImGui::Text("%s", project.name.c_str());
-        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "UE %s", project.engineVersion.c_str());
-        ImGui::EndGroup();
+            // Text
+            ImGui::BeginGroup();
+            if (project.missing)
+            {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s (missing)", project.name.c_str());
+            }
+            else
+            {
+                ImGui::Text("%s", project.name.c_str());
+            }
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "UE %s", project.engineVersion.c_str());
+            auto watcher = m_watchers.find(project.name);
+            if (watcher != m_watchers.end())
+            {
+                ImGui::SameLine();
+                auto state = watcher->second->getState();
+                switch (state.status)
+                {
+                    case WatchStatus::Watching:
+                        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "- watching");
+                        break;
+                    case WatchStatus::Pending:
+                        ImGui::TextColored(ImVec4(0.9f, 0.8f, 0.3f, 1.0f), "- changes pending");
+                        break;
+                    case WatchStatus::Building:
+                        ImGui::TextColored(ImVec4(0.4f, 0.7f, 1.0f, 1.0f), "- building...");
+                        break;
+                    case WatchStatus::Succeeded:
+                    case WatchStatus::Failed:
+                    {
+                        auto time = static_cast<std::time_t>(state.finishedAt);
+                        char clock[16];
+                        strftime(clock, sizeof(clock), "%H:%M:%S", localtime(&time));
+                        bool success = state.status == WatchStatus::Succeeded;
+                        ImGui::TextColored(success ? ImVec4(0.4f, 0.8f, 0.4f, 1.0f) : ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                                           "- %s %s", success ? "built" : "failed", clock);
+                        break;
+                    }
+                }
+            }
+            ImGui::EndGroup();
 
-        ImGui::PopID();
+            ImGui::PopID();
+        }
     }
 }
 
 void UI::renderProjectDetails()
 {
+    TRACE_SCOPE("renderProjectDetails", "ui");
     ImGui::Text("Details");
     ImGui::Separator();
 
@@ -388,6 +591,11 @@ void UI::renderProjectDetails()
     // Project name and path
     ImGui::Text("Name: %s", m_selectedProject->name.c_str());
     ImGui::Text("Path: %s", m_selectedProject->path.string().c_str());
+    if (m_selectedProject->missing)
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Project file not found: %s",
+                           m_selectedProject->uprojectPath.string().c_str());
+    }
     ImGui::Spacing();
 
     // Engine version combo
@@ -411,6 +619,7 @@ void UI::renderProjectDetails()
                 if (m_selectedEngineIndex >= 0 && m_selectedEngineIndex < static_cast<int>(engines.size()))
                 {
                     m_selectedProject->engineVersion = engines[m_selectedEngineIndex].name;
+                    m_projectManager->markDirty();
                 }
             }
         }
@@ -432,6 +641,7 @@ void UI::renderProjectDetails()
     if (ImGui::InputText("##CommandLineArgs", m_commandLineArgs, sizeof(m_commandLineArgs)))
     {
         m_selectedProject->commandLineArgs = m_commandLineArgs;
+        m_projectManager->markDirty();
     }
 
     ImGui::Spacing();
@@ -440,13 +650,16 @@ void UI::renderProjectDetails()
 
     // Action buttons
     bool operationRunning = m_operations && m_operations->isRunning();
+    bool actionsDisabled = operationRunning || m_selectedProject->missing || isWatchBuilding(m_selectedProject->name);
 
-    ImGui::BeginDisabled(operationRunning);
+    ImGui::BeginDisabled(actionsDisabled);
 
     if (ImGui::Button("Clean", ImVec2(100, 30)))
     {
         log("Starting clean operation...");
-        m_currentOperation = m_operations->clean(m_selectedProject->path);
+        m_operationProject = m_selectedProject->name;
+        m_currentOperation =
+            m_operations->clean(m_selectedProject->path, m_fastClean ? CleanMode::Fast : CleanMode::Standard);
     }
 
     ImGui::SameLine();
@@ -459,6 +672,7 @@ void UI::renderProjectDetails()
             if (engine)
             {
                 log("Generating project files...");
+                m_operationProject = m_selectedProject->name;
                 m_currentOperation = m_operations->generateProjectFiles(engine->path, m_selectedProject->uprojectPath);
             }
             else
@@ -478,6 +692,7 @@ void UI::renderProjectDetails()
             if (engine)
             {
                 log("Building project...");
+                m_operationProject = m_selectedProject->name;
                 m_currentOperation = m_operations->build(engine->path, m_selectedProject->uprojectPath);
             }
             else
@@ -496,8 +711,8 @@ void UI::renderProjectDetails()
             auto* engine = m_engineManager->findVersion(m_selectedProject->engineVersion);
             if (engine)
             {
-                m_currentOperation = m_operations->run(engine->path, m_selectedProject->uprojectPath,
-                                                       m_selectedProject->commandLineArgs);
+                m_operations->run(engine->path, m_selectedProject->uprojectPath, m_selectedProject->commandLineArgs);
+                m_showEditorsWindow = true;
             }
             else
             {
@@ -507,6 +722,83 @@ void UI::renderProjectDetails()
     }
 
     ImGui::EndDisabled();
+    renderStartupTrend();
+
+    ImGui::BeginDisabled(m_selectedProject->missing);
+    if (ImGui::Button("Queue Build", ImVec2(100, 30)))
+    {
+        queueJob(*m_selectedProject, JobKind::Build);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Build in the background queue, alongside other projects");
+    }
+    ImGui::EndDisabled();
+
+    ImGui::BeginDisabled(actionsDisabled);
+    ImGui::Checkbox("Fast clean", &m_fastClean);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Move folders to the trash instantly and delete them in the background");
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Skip up-to-date builds", &m_skipUpToDateBuilds))
+    {
+        m_operations->setSkipUpToDateBuilds(m_skipUpToDateBuilds);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Don't start UBT when sources, config and engine match the last successful build");
+    }
+
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(m_selectedProject->missing);
+    bool watching = m_watchers.count(m_selectedProject->name) > 0;
+    if (ImGui::Checkbox("Watch sources", &watching))
+    {
+        auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+        if (!watching)
+        {
+            stopWatching(m_selectedProject->name);
+        }
+        else if (engine)
+        {
+            BuildJob build;
+            build.projectName = m_selectedProject->name;
+            build.enginePath = engine->path;
+            build.uprojectPath = m_selectedProject->uprojectPath;
+            m_watchers[m_selectedProject->name] = std::make_unique<SourceWatcher>(
+                *m_buildQueue, std::move(build), [this](const std::string& msg, bool isError) { log(msg, isError); });
+        }
+        else
+        {
+            log("Engine version not found: " + m_selectedProject->engineVersion, true);
+        }
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Build the editor target in the background whenever source files are saved");
+    }
+    ImGui::EndDisabled();
+
+    // Background trash deletion
+    auto trash = TrashDeleter::instance().getProgress();
+    if (trash.running)
+    {
+        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Emptying trash: %llu files, %s (%zu queued)",
+                           static_cast<unsigned long long>(trash.filesDeleted),
+                           formatBytes(trash.bytesDeleted).c_str(), trash.pendingItems);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Stop"))
+        {
+            TrashDeleter::instance().cancel();
+        }
+    }
+
+    renderTargetSelection(actionsDisabled);
+    renderModuleSelection(actionsDisabled);
 
     ImGui::Spacing();
     ImGui::Separator();
@@ -522,7 +814,7 @@ void UI::renderProjectDetails()
 
     ImGui::SameLine();
 
-    ImGui::BeginDisabled(operationRunning);
+    ImGui::BeginDisabled(actionsDisabled);
     if (ImGui::Button("Package", ImVec2(100, 0)))
     {
         if (m_engineManager)
@@ -533,8 +825,10 @@ void UI::renderProjectDetails()
                 Platform platform = static_cast<Platform>(m_selectedPlatformIndex);
                 auto outputPath = m_selectedProject->path / "Package" / platformToString(platform);
                 log("Packaging for " + platformToString(platform) + "...");
+                m_operationProject = m_selectedProject->name;
                 m_currentOperation =
-                    m_operations->package(engine->path, m_selectedProject->uprojectPath, platform, outputPath);
+                    m_operations->package(engine->path, m_selectedProject->uprojectPath, platform, outputPath, 0,
+                                          m_packageOptions);
             }
             else
             {
@@ -544,6 +838,57 @@ void UI::renderProjectDetails()
     }
     ImGui::EndDisabled();
 
+    ImGui::SameLine();
+
+    ImGui::BeginDisabled(m_selectedProject->missing);
+    if (ImGui::Button("Queue Package", ImVec2(120, 0)))
+    {
+        queueJob(*m_selectedProject, JobKind::Package);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Package Matrix...", ImVec2(130, 0)))
+    {
+        m_showPackageMatrixWindow = true;
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::Checkbox("Incremental", &m_packageOptions.incremental);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Cook iteratively, keep the staged files and report which files of the package changed");
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Compress", &m_packageOptions.compress);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Write a zstd compressed tarball of the package, starting as soon as staging is done");
+    }
+
+    ImGui::Text("Deploy to:");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(250);
+    ImGui::InputText("##DeployPath", m_deployPath, sizeof(m_deployPath));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(actionsDisabled || m_deployPath[0] == '\0');
+    if (ImGui::Button("Deploy", ImVec2(100, 0)))
+    {
+        Platform platform = static_cast<Platform>(m_selectedPlatformIndex);
+        auto packagePath = m_selectedProject->path / "Package" / platformToString(platform);
+        m_operationProject = m_selectedProject->name;
+        auto manifestPath = PackageManifest::getPath(m_selectedProject->uprojectPath, platformToUbtName(platform));
+        m_currentOperation = m_operations->deploy(packagePath, m_deployPath, manifestPath);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Sync the archived package to this folder, only changed chunks are copied");
+    }
+    ImGui::EndDisabled();
+
+    ImGui::Spacing();
+    renderMultiplayer();
+    renderProfiling();
+    renderBuildHistory();
+    renderPackageSizes();
     ImGui::Spacing();
 
     // Remove project button
@@ -564,7 +909,9 @@ void UI::renderProjectDetails()
         if (ImGui::Button("Yes", ImVec2(80, 0)))
         {
             std::string nameToRemove = m_selectedProject->name;
+            stopWatching(nameToRemove);
             m_selectedProject = nullptr;
+            m_selectedProjectName.clear();
             m_projectManager->removeProject(nameToRemove);
             ImGui::CloseCurrentPopup();
         }
@@ -577,46 +924,1027 @@ void UI::renderProjectDetails()
     }
 }
 
-void UI::renderEngineVersionsWindow()
+void UI::renderTargetSelection(bool actionsDisabled)
 {
-    ImGui::SetNextWindowSize(ImVec2(600, 400), ImGuiCond_FirstUseEver);
+    if (!ImGui::CollapsingHeader("Targets"))
+        return;
 
-    if (ImGui::Begin("Engine Versions", &m_showEngineVersionsWindow))
+    auto hostPlatform = static_cast<int>(getCurrentPlatform());
+    if (m_targetsProject != m_selectedProject->name)
     {
-        // Add new engine version
-        ImGui::Text("Add Engine Version:");
+        m_targetsProject = m_selectedProject->name;
+        m_selectedTargets.clear();
+        std::fill(std::begin(m_targetPlatforms), std::end(m_targetPlatforms), false);
+        m_targetPlatforms[hostPlatform] = true;
+    }
 
-        ImGui::InputText("Name", m_newEngineName, sizeof(m_newEngineName));
-        ImGui::InputText("Path", m_newEnginePath, sizeof(m_newEnginePath));
+    // Cached by modification time, so this is a few stat calls per frame
+    auto targets = TargetDiscovery::instance().getTargets(m_selectedProject->uprojectPath);
+    for (const auto& target : targets)
+    {
+        bool selected = m_selectedTargets.count(target.name) > 0;
+        auto label = target.name + " (" + TargetDiscovery::targetTypeToString(target.type) + ")";
+        if (ImGui::Checkbox(label.c_str(), &selected))
+        {
+            if (selected)
+                m_selectedTargets.insert(target.name);
+            else
+                m_selectedTargets.erase(target.name);
+        }
+    }
 
-        if (ImGui::Button("Add Engine"))
+    static const Platform platforms[] = {Platform::Windows, Platform::Linux, Platform::Mac, Platform::Android};
+    static const BuildConfiguration configs[] = {BuildConfiguration::Development, BuildConfiguration::Shipping,
+                                                 BuildConfiguration::Debug};
+    ImGui::Text("Platforms:");
+    for (int i = 0; i < IM_ARRAYSIZE(platforms); ++i)
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox(platformToString(platforms[i]).c_str(), &m_targetPlatforms[i]);
+    }
+    ImGui::Text("Configurations:");
+    for (int i = 0; i < IM_ARRAYSIZE(configs); ++i)
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox(buildConfigToString(configs[i]).c_str(), &m_targetConfigs[i]);
+    }
+
+    // Every selected combination, minus the ones UBT refuses: editors only build for the host and never
+    // for Shipping
+    std::vector<BuildTargetSpec> specs;
+    for (const auto& target : targets)
+    {
+        if (!m_selectedTargets.count(target.name))
+            continue;
+        for (int p = 0; p < IM_ARRAYSIZE(platforms); ++p)
         {
-            if (strlen(m_newEngineName) > 0 && strlen(m_newEnginePath) > 0)
+            for (int c = 0; c < IM_ARRAYSIZE(configs); ++c)
             {
-                m_engineManager->addVersion(m_newEngineName, m_newEnginePath);
-                m_newEngineName[0] = '\0';
-                m_newEnginePath[0] = '\0';
+                if (!m_targetPlatforms[p] || !m_targetConfigs[c])
+                    continue;
+                if (target.type == TargetType::Editor &&
+                    (p != hostPlatform || configs[c] == BuildConfiguration::Shipping))
+                    continue;
+                specs.push_back({target.name, platforms[p], configs[c]});
             }
         }
+    }
 
-        ImGui::Separator();
-
-        // List existing engines
-        ImGui::Text("Configured Engines:");
-
-        if (m_engineManager)
+    ImGui::BeginDisabled(actionsDisabled || specs.empty());
+    if (ImGui::Button("Build Selected", ImVec2(120, 0)))
+    {
+        auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+        if (engine)
         {
-            const auto& engines = m_engineManager->getVersions();
+            m_operationProject = m_selectedProject->name;
+            m_currentOperation = m_operations->buildTargets(engine->path, m_selectedProject->uprojectPath, specs);
+        }
+        else
+        {
+            log("Engine version not found: " + m_selectedProject->engineVersion, true);
+        }
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::TextDisabled("%zu combination(s) in one UBT run", specs.size());
+    if (ImGui::IsItemHovered() && !specs.empty())
+    {
+        std::string list;
+        for (const auto& spec : specs)
+        {
+            list +=
+                spec.target + " " + platformToUbtName(spec.platform) + " " + buildConfigToString(spec.config) + "\n";
+        }
+        ImGui::SetTooltip("%s", list.c_str());
+    }
+}
 
-            if (ImGui::BeginTable("EnginesTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
-            {
-                ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 100);
-                ImGui::TableSetupColumn("Path", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 130);
-                ImGui::TableHeadersRow();
+void UI::renderModuleSelection(bool actionsDisabled)
+{
+    if (!ImGui::CollapsingHeader("Modules"))
+        return;
 
-                std::string toRemove;
-                std::string toEdit;
+    if (m_modulesProject != m_selectedProject->name)
+    {
+        m_modulesProject = m_selectedProject->name;
+        m_selectedModules.clear();
+        m_sourceFilesModule.clear();
+        m_sourceFiles.clear();
+        m_sourceFileIndex = -1;
+    }
+
+    auto modules = TargetDiscovery::instance().getModules(m_selectedProject->uprojectPath);
+    if (modules.empty())
+    {
+        ImGui::TextDisabled("No C++ modules");
+        return;
+    }
+
+    for (const auto& module : modules)
+    {
+        bool selected = m_selectedModules.count(module.name) > 0;
+        auto label = module.type.empty() ? module.name : module.name + " (" + module.type + ")";
+        if (ImGui::Checkbox(label.c_str(), &selected))
+        {
+            if (selected)
+                m_selectedModules.insert(module.name);
+            else
+                m_selectedModules.erase(module.name);
+        }
+    }
+
+    ImGui::BeginDisabled(actionsDisabled || m_selectedModules.empty());
+    if (ImGui::Button("Build Modules", ImVec2(120, 0)))
+    {
+        BuildScope scope;
+        scope.modules.assign(m_selectedModules.begin(), m_selectedModules.end());
+        startScopedBuild(std::move(scope));
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Compile and link only the selected modules of the editor target");
+    }
+    ImGui::EndDisabled();
+
+    // Single file compile
+    auto current = std::find_if(modules.begin(), modules.end(),
+                                [this](const ProjectModule& module) { return module.name == m_sourceFilesModule; });
+    ImGui::SetNextItemWidth(200);
+    if (ImGui::BeginCombo("##SourceModule", current == modules.end() ? "Module..." : current->name.c_str()))
+    {
+        for (const auto& module : modules)
+        {
+            if (ImGui::Selectable(module.name.c_str(), module.name == m_sourceFilesModule))
+            {
+                m_sourceFilesModule = module.name;
+                m_sourceFiles = TargetDiscovery::listSourceFiles(module);
+                m_sourceFileIndex = -1;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputText("##SourceFilter", m_sourceFileFilter, sizeof(m_sourceFileFilter));
+
+    if (current != modules.end() && ImGui::BeginListBox("##SourceFiles", ImVec2(-1, 120)))
+    {
+        std::string filter = m_sourceFileFilter;
+        std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
+        for (int i = 0; i < static_cast<int>(m_sourceFiles.size()); ++i)
+        {
+            auto name = m_sourceFiles[i].generic_string();
+            auto lower = name;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            if (!filter.empty() && lower.find(filter) == std::string::npos)
+                continue;
+            if (ImGui::Selectable(name.c_str(), m_sourceFileIndex == i))
+            {
+                m_sourceFileIndex = i;
+            }
+        }
+        ImGui::EndListBox();
+    }
+
+    bool hasFile = current != modules.end() && m_sourceFileIndex >= 0 &&
+                   m_sourceFileIndex < static_cast<int>(m_sourceFiles.size());
+    ImGui::BeginDisabled(actionsDisabled || !hasFile);
+    if (ImGui::Button("Compile File", ImVec2(120, 0)))
+    {
+        BuildScope scope;
+        scope.singleFile = current->directory / m_sourceFiles[m_sourceFileIndex];
+        startScopedBuild(std::move(scope));
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Compile only this file, to check it builds without linking");
+    }
+    ImGui::EndDisabled();
+}
+
+void UI::startScopedBuild(BuildScope scope)
+{
+    auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+    if (!engine)
+    {
+        log("Engine version not found: " + m_selectedProject->engineVersion, true);
+        return;
+    }
+    m_operationProject = m_selectedProject->name;
+    m_currentOperation = m_operations->build(engine->path, m_selectedProject->uprojectPath,
+                                             BuildConfiguration::Development, 0, std::move(scope));
+}
+
+void UI::renderMultiplayer()
+{
+    if (!ImGui::CollapsingHeader("Multiplayer"))
+        return;
+
+    auto& supervisor = EditorSupervisor::instance();
+    bool running = supervisor.isSessionRunning(m_multiplayerSession);
+
+    ImGui::BeginDisabled(running);
+    int clients = static_cast<int>(m_multiplayer.clients);
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::InputInt("Clients", &clients))
+        m_multiplayer.clients = static_cast<unsigned>(std::clamp(clients, 1, 16));
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::InputInt("Port", &m_multiplayer.port))
+        m_multiplayer.port = std::clamp(m_multiplayer.port, 1, 65535);
+    ImGui::InputText("Map", m_multiplayerMap, sizeof(m_multiplayerMap));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Empty for the project's GameDefaultMap");
+    ImGui::InputText("Server arguments", m_multiplayerServerArgs, sizeof(m_multiplayerServerArgs));
+    ImGui::InputText("Client arguments", m_multiplayerClientArgs, sizeof(m_multiplayerClientArgs));
+    int stagger = static_cast<int>(m_multiplayer.staggerSeconds);
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::InputInt("Stagger (s)", &stagger))
+        m_multiplayer.staggerSeconds = static_cast<unsigned>(std::max(0, stagger));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Longest wait for an instance to initialize before the next one starts");
+    ImGui::Checkbox("Pin to physical cores", &m_multiplayer.pinCpus);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Give every instance its own cores so they do not compete for the same caches");
+    ImGui::EndDisabled();
+
+    ImGui::BeginDisabled(running || m_selectedProject->missing);
+    if (ImGui::Button("Launch Session", ImVec2(150, 0)))
+    {
+        auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+        if (engine)
+        {
+            m_multiplayer.map = m_multiplayerMap;
+            m_multiplayer.serverArgs = m_multiplayerServerArgs;
+            m_multiplayer.clientArgs = m_multiplayerClientArgs;
+            m_multiplayerSession =
+                m_operations->runMultiplayer(engine->path, m_selectedProject->uprojectPath, m_multiplayer);
+            if (m_multiplayerSession != 0)
+                m_showEditorsWindow = true;
+        }
+        else
+        {
+            log("Engine version not found: " + m_selectedProject->engineVersion, true);
+        }
+    }
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!running);
+    if (ImGui::Button("Close Session", ImVec2(150, 0)))
+    {
+        supervisor.closeSession(m_multiplayerSession);
+    }
+    ImGui::EndDisabled();
+}
+
+void UI::renderProfiling()
+{
+    if (!ImGui::CollapsingHeader("Profiling"))
+        return;
+
+    ImGui::Checkbox("CSV profiler", &m_profileOptions.csv);
+    ImGui::SameLine();
+    ImGui::Checkbox("Insights trace", &m_profileOptions.insights);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("-trace=cpu,frame,gpu, open the .utrace with Unreal Insights");
+    ImGui::SameLine();
+    ImGui::Checkbox("Game", &m_profileOptions.game);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Profile the standalone game (-game) rather than the editor");
+
+    ImGui::BeginDisabled(m_selectedProject->missing || (!m_profileOptions.csv && !m_profileOptions.insights));
+    if (ImGui::Button("Profile", ImVec2(100, 0)))
+    {
+        auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+        if (engine)
+        {
+            if (m_operations->runProfile(engine->path, m_selectedProject->uprojectPath, m_profileOptions,
+                                         m_selectedProject->commandLineArgs) != 0)
+                m_showEditorsWindow = true;
+        }
+        else
+        {
+            log("Engine version not found: " + m_selectedProject->engineVersion, true);
+        }
+    }
+    ImGui::EndDisabled();
+
+    auto& history = ProfilingHistory::instance();
+    if (m_profilingProject != m_selectedProject->name || m_profilingRevision != history.getRevision())
+    {
+        // A new session becomes the compared one, against the session that was compared before
+        bool sameProject = m_profilingProject == m_selectedProject->name;
+        m_profilingProject = m_selectedProject->name;
+        m_profilingRevision = history.getRevision();
+        m_profilingSessions = history.load(m_profilingProject);
+        int count = static_cast<int>(m_profilingSessions.size());
+        m_profileBaseline = sameProject && m_profileCompared >= 0 ? m_profileCompared : count - 2;
+        m_profileCompared = count - 1;
+    }
+
+    if (m_profilingSessions.empty())
+    {
+        ImGui::TextDisabled("No profile sessions recorded yet");
+        return;
+    }
+
+    if (ImGui::BeginTable("ProfilingTable", 8,
+                          ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                          ImVec2(0, 150)))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("A", ImGuiTableColumnFlags_WidthFixed, 20);
+        ImGui::TableSetupColumn("B", ImGuiTableColumnFlags_WidthFixed, 20);
+        ImGui::TableSetupColumn("Date", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableSetupColumn("Frames", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableSetupColumn("P50", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableSetupColumn("P99", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableSetupColumn("Hitches", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableHeadersRow();
+
+        // Newest first
+        for (int i = static_cast<int>(m_profilingSessions.size()) - 1; i >= 0; --i)
+        {
+            const auto& session = m_profilingSessions[i];
+            ImGui::TableNextRow();
+            ImGui::PushID(i);
+
+            ImGui::TableNextColumn();
+            if (ImGui::RadioButton("##Baseline", m_profileBaseline == i))
+                m_profileBaseline = i;
+            ImGui::TableNextColumn();
+            if (ImGui::RadioButton("##Compared", m_profileCompared == i))
+                m_profileCompared = i;
+
+            ImGui::TableNextColumn();
+            auto time = static_cast<std::time_t>(session.timestamp);
+            char date[32];
+            strftime(date, sizeof(date), "%d %b %H:%M", localtime(&time));
+            ImGui::Text("%s", date);
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                ImGui::Text("%s", session.arguments.c_str());
+                for (const auto& file : session.csvFiles)
+                    ImGui::BulletText("%s", file.c_str());
+                for (const auto& file : session.traceFiles)
+                    ImGui::BulletText("%s", file.c_str());
+                ImGui::EndTooltip();
+            }
+            if (ImGui::BeginPopupContextItem("ProfileFiles"))
+            {
+                for (const auto& file : session.traceFiles)
+                {
+                    if (ImGui::MenuItem(("Copy " + std::filesystem::path(file).filename().string()).c_str()))
+                        ImGui::SetClipboardText(file.c_str());
+                }
+                ImGui::EndPopup();
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0fs", session.durationSeconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", session.summary.frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", session.summary.p50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", session.summary.p99);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", session.summary.hitches);
+
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    int count = static_cast<int>(m_profilingSessions.size());
+    if (m_profileCompared < 0 || m_profileCompared >= count)
+        return;
+    const auto& compared = m_profilingSessions[m_profileCompared].summary;
+    const ProfileSummary* baseline =
+        m_profileBaseline >= 0 && m_profileBaseline < count && m_profileBaseline != m_profileCompared
+            ? &m_profilingSessions[m_profileBaseline].summary
+            : nullptr;
+
+    // Frame times in ms, B against A, slower in orange
+    if (ImGui::BeginTable("ProfileCompareTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Stat (ms)", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("A", ImGuiTableColumnFlags_WidthFixed, 70);
+        ImGui::TableSetupColumn("B", ImGuiTableColumnFlags_WidthFixed, 70);
+        ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 70);
+        ImGui::TableHeadersRow();
+
+        auto row = [](const char* name, double before, double after, const char* format = "%.2f")
+        {
+            if (after < 0.0)
+                return;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", name);
+            ImGui::TableNextColumn();
+            if (before >= 0.0)
+                ImGui::Text(format, before);
+            ImGui::TableNextColumn();
+            ImGui::Text(format, after);
+            ImGui::TableNextColumn();
+            if (before > 0.0)
+            {
+                double change = (after - before) / before * 100.0;
+                ImVec4 color = change > 5.0    ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f)
+                               : change < -5.0 ? ImVec4(0.4f, 0.9f, 0.4f, 1.0f)
+                                               : ImVec4(0.7f, 0.7f, 0.7f, 1.0f);
+                ImGui::TextColored(color, "%+.0f%%", change);
+            }
+        };
+
+        row("Frame (average)", baseline ? baseline->averageFrame : -1.0, compared.averageFrame);
+        row("Frame P50", baseline ? baseline->p50 : -1.0, compared.p50);
+        row("Frame P90", baseline ? baseline->p90 : -1.0, compared.p90);
+        row("Frame P99", baseline ? baseline->p99 : -1.0, compared.p99);
+        row("Frame max", baseline ? baseline->maxFrame : -1.0, compared.maxFrame);
+        row("Hitches", baseline ? static_cast<double>(baseline->hitches) : -1.0,
+            static_cast<double>(compared.hitches), "%.0f");
+        row("Game thread", baseline ? baseline->gameThread : -1.0, compared.gameThread);
+        row("Render thread", baseline ? baseline->renderThread : -1.0, compared.renderThread);
+        row("GPU", baseline ? baseline->gpu : -1.0, compared.gpu);
+
+        for (const auto& stat : compared.topStats)
+        {
+            double before = -1.0;
+            if (baseline)
+            {
+                auto it = std::find_if(baseline->topStats.begin(), baseline->topStats.end(),
+                                       [&stat](const ProfileStat& other) { return other.name == stat.name; });
+                if (it != baseline->topStats.end())
+                    before = it->average;
+            }
+            row(stat.name.c_str(), before, stat.average);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void UI::renderBuildHistory()
+{
+    if (!ImGui::CollapsingHeader("Build History"))
+        return;
+
+    auto& history = BuildHistory::instance();
+    if (m_historyProject != m_selectedProject->name || m_historyRevision != history.getRevision())
+    {
+        m_historyProject = m_selectedProject->name;
+        m_historyRevision = history.getRevision();
+        m_historyRecords = history.load(m_historyProject);
+        m_historyRegressions = BuildHistory::findRegressions(m_historyRecords);
+        m_historySelected = m_historyRecords.empty() ? -1 : static_cast<int>(m_historyRecords.size()) - 1;
+    }
+
+    if (m_historyRecords.empty())
+    {
+        ImGui::TextDisabled("No builds recorded yet");
+        return;
+    }
+
+    // Wall time trend of successful builds
+    std::vector<float> totals;
+    for (const auto& record : m_historyRecords)
+    {
+        if (record.success)
+            totals.push_back(static_cast<float>(record.totalSeconds));
+    }
+    if (totals.size() > 1)
+    {
+        ImGui::PlotLines("##BuildTimes", totals.data(), static_cast<int>(totals.size()), 0, "Build time (s)", 0.0f,
+                         FLT_MAX, ImVec2(-1, 60));
+    }
+
+    for (const auto& regression : m_historyRegressions)
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%s", regression.describe().c_str());
+    }
+
+    if (ImGui::BeginTable("BuildHistoryTable", 6,
+                          ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                          ImVec2(0, 150)))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Date", ImGuiTableColumnFlags_WidthFixed, 120);
+        ImGui::TableSetupColumn("Target", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableSetupColumn("UHT", ImGuiTableColumnFlags_WidthFixed, 50);
+        ImGui::TableSetupColumn("Link", ImGuiTableColumnFlags_WidthFixed, 50);
+        ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableHeadersRow();
+
+        // Newest first
+        for (int i = static_cast<int>(m_historyRecords.size()) - 1; i >= 0; --i)
+        {
+            const auto& record = m_historyRecords[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+
+            auto time = static_cast<std::time_t>(record.timestamp);
+            char date[32];
+            strftime(date, sizeof(date), "%d %b %H:%M", localtime(&time));
+            ImGui::PushID(i);
+            if (!record.success)
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
+            if (ImGui::Selectable(date, m_historySelected == i, ImGuiSelectableFlags_SpanAllColumns))
+            {
+                m_historySelected = i;
+            }
+            if (!record.success)
+                ImGui::PopStyleColor();
+            ImGui::PopID();
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%s %s", record.target.c_str(), record.configuration.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0fs", record.totalSeconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fs", record.uhtSeconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fs", record.linkSeconds);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", record.actions.size());
+        }
+        ImGui::EndTable();
+    }
+
+    if (m_historySelected < 0 || m_historySelected >= static_cast<int>(m_historyRecords.size()))
+        return;
+
+    // Slowest actions and modules of the selected build
+    const auto& record = m_historyRecords[m_historySelected];
+    std::vector<const ActionTiming*> actions;
+    std::unordered_map<std::string, float> modules;
+    for (const auto& action : record.actions)
+    {
+        actions.push_back(&action);
+        modules[action.module.empty() ? "Other" : action.module] += action.seconds;
+    }
+    size_t shown = std::min<size_t>(actions.size(), 15);
+    std::partial_sort(actions.begin(), actions.begin() + shown, actions.end(),
+                      [](const ActionTiming* a, const ActionTiming* b) { return a->seconds > b->seconds; });
+
+    std::vector<std::pair<std::string, float>> moduleTotals(modules.begin(), modules.end());
+    std::sort(moduleTotals.begin(), moduleTotals.end(),
+              [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    ImGui::Text("%u UBT processes, durations estimated from completion order", record.parallelism);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Timeline..."))
+    {
+        m_timelineRecord = record;
+        m_timeline = analyzeTimeline(record);
+        m_timelineFit = true;
+        m_showBuildTimelineWindow = true;
+    }
+    if (ImGui::BeginTable("SlowestActions", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Slowest actions", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Module", ImGuiTableColumnFlags_WidthFixed, 120);
+        ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < shown; ++i)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s %s", actions[i]->kind.c_str(), actions[i]->name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", actions[i]->module.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fs", actions[i]->seconds);
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::BeginTable("ModuleTimes", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Module", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 60);
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < moduleTotals.size() && i < 10; ++i)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", moduleTotals[i].first.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fs", moduleTotals[i].second);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void UI::renderStartupTrend()
+{
+    auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+    if (!engine)
+        return;
+
+    auto& history = EditorStartupHistory::instance();
+    auto engineKey = engine->path.string();
+    if (m_startupProject != m_selectedProject->name || m_startupEngine != engineKey ||
+        m_startupRevision != history.getRevision())
+    {
+        m_startupProject = m_selectedProject->name;
+        m_startupEngine = engineKey;
+        m_startupRevision = history.getRevision();
+        m_startupRecords = history.load(m_startupProject, m_startupEngine);
+        m_startupRegressions = EditorStartupHistory::findRegressions(m_startupRecords);
+    }
+
+    // Time to ready of the recent startups
+    constexpr size_t maxPoints = 30;
+    std::vector<float> ready;
+    for (size_t i = m_startupRecords.size() > maxPoints ? m_startupRecords.size() - maxPoints : 0;
+         i < m_startupRecords.size(); ++i)
+    {
+        if (m_startupRecords[i].ready >= 0.0)
+            ready.push_back(static_cast<float>(m_startupRecords[i].ready));
+    }
+    if (ready.empty())
+        return;
+
+    ImGui::SameLine();
+    ImGui::BeginGroup();
+    if (ready.size() > 1)
+    {
+        ImGui::PlotLines("##StartupTrend", ready.data(), static_cast<int>(ready.size()), 0, nullptr, 0.0f, FLT_MAX,
+                         ImVec2(120, 30));
+        ImGui::SameLine();
+    }
+    ImGui::AlignTextToFramePadding();
+    if (m_startupRegressions.empty())
+        ImGui::Text("Ready in %.0fs", ready.back());
+    else
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Ready in %.0fs", ready.back());
+    ImGui::EndGroup();
+
+    if (ImGui::IsItemHovered())
+    {
+        const auto& last = m_startupRecords.back();
+        ImGui::BeginTooltip();
+        ImGui::Text("Last editor startup%s", last.prefetched ? " (prefetched)" : "");
+        ImGui::Text("First output:          %.1fs", last.firstOutput);
+        ImGui::Text("Engine initialized:    %.1fs", last.engineInitialized);
+        if (last.shadersCompiled >= 0.0)
+            ImGui::Text("Shaders compiled:      %.1fs", last.shadersCompiled);
+        ImGui::Text("Ready:                 %.1fs", last.ready);
+        for (const auto& regression : m_startupRegressions)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%s", regression.describe().c_str());
+        }
+        ImGui::EndTooltip();
+    }
+}
+
+void UI::renderPackageSizes()
+{
+    if (!ImGui::CollapsingHeader("Package Size"))
+        return;
+
+    auto& history = PackageSizeHistory::instance();
+    bool reload = false;
+    if (m_sizeProject != m_selectedProject->name || m_sizeRevision != history.getRevision())
+    {
+        m_sizeProject = m_selectedProject->name;
+        m_sizeRevision = history.getRevision();
+        m_sizePlatforms = history.getPlatforms(m_sizeProject);
+        int last = std::max(0, static_cast<int>(m_sizePlatforms.size()) - 1);
+        m_sizePlatformIndex = std::clamp(m_sizePlatformIndex, 0, last);
+        reload = true;
+    }
+    if (m_sizePlatforms.empty())
+    {
+        ImGui::TextDisabled("No packages indexed yet");
+        return;
+    }
+
+    ImGui::SetNextItemWidth(200);
+    if (ImGui::BeginCombo("##SizePlatform", m_sizePlatforms[m_sizePlatformIndex].c_str()))
+    {
+        for (int i = 0; i < static_cast<int>(m_sizePlatforms.size()); ++i)
+        {
+            if (ImGui::Selectable(m_sizePlatforms[i].c_str(), i == m_sizePlatformIndex))
+            {
+                m_sizePlatformIndex = i;
+                reload = true;
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    const auto& platform = m_sizePlatforms[m_sizePlatformIndex];
+    if (reload)
+    {
+        auto indexes = history.load(m_sizeProject, platform, 2);
+        m_sizeIndex = indexes.empty() ? PackageSizeIndex{} : std::move(indexes.front());
+        auto budget = Config::instance().getPackageBudget(platform.substr(0, platform.find('-')));
+        m_sizeReport = comparePackageSizes(indexes.size() > 1 ? &indexes[1] : nullptr, m_sizeIndex, budget);
+    }
+
+    auto signedBytes = [](int64_t delta)
+    { return (delta < 0 ? "-" : "+") + formatBytes(static_cast<uint64_t>(delta < 0 ? -delta : delta)); };
+
+    ImGui::SameLine();
+    if (m_sizeReport.hasPrevious)
+    {
+        int64_t growth =
+            static_cast<int64_t>(m_sizeReport.totalAfter) - static_cast<int64_t>(m_sizeReport.totalBefore);
+        ImGui::Text("%s (%s)", formatBytes(m_sizeReport.totalAfter).c_str(), signedBytes(growth).c_str());
+    }
+    else
+    {
+        ImGui::Text("%s", formatBytes(m_sizeReport.totalAfter).c_str());
+    }
+    for (const auto& violation : m_sizeReport.violations)
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", violation.c_str());
+    }
+
+    if (ImGui::BeginTable("PackageTypes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                          ImVec2(0, 150)))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableHeadersRow();
+        for (const auto& type : m_sizeReport.types)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", type.subject.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatBytes(type.after).c_str());
+            ImGui::TableNextColumn();
+            if (m_sizeReport.hasPrevious && type.getDelta() != 0)
+                ImGui::Text("%s", signedBytes(type.getDelta()).c_str());
+        }
+        ImGui::EndTable();
+    }
+
+    if (!m_sizeReport.hasPrevious)
+        return;
+    if (ImGui::BeginTable("PackageGrowers", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Largest growers", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableHeadersRow();
+        for (const auto& grower : m_sizeReport.growers)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", grower.subject.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatBytes(grower.after).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", signedBytes(grower.getDelta()).c_str());
+        }
+        ImGui::EndTable();
+    }
+}
+
+void UI::renderBuildTimelineWindow()
+{
+    TRACE_SCOPE("renderBuildTimelineWindow", "ui");
+    ImGui::SetNextWindowSize(ImVec2(900, 500), ImGuiCond_FirstUseEver);
+
+    if (!ImGui::Begin("Build Timeline", &m_showBuildTimelineWindow))
+    {
+        ImGui::End();
+        return;
+    }
+
+    const auto& timeline = m_timeline;
+    const auto& actions = m_timelineRecord.actions;
+    if (!timeline.isValid())
+    {
+        ImGui::TextDisabled("This build was recorded before timelines were kept");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("%s %s: %.0fs, %zu actions on %u slots", m_timelineRecord.target.c_str(),
+                m_timelineRecord.configuration.c_str(), m_timelineRecord.totalSeconds, actions.size(), timeline.slots);
+    ImGui::Text("UHT %.1fs, actions %.0fs, critical path %.1fs", m_timelineRecord.uhtSeconds, timeline.actionsSeconds,
+                timeline.criticalSeconds);
+    ImGui::SameLine();
+    ImGui::TextDisabled("(estimated)");
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("UBT only reports when an action completes. Each action is assumed to start when the "
+                          "action one slot count earlier finished, so the slots always look busy.");
+    }
+
+    // Whether more cores would help: compare the wall time with the dependency chain that no amount of
+    // parallelism can shorten
+    if (timeline.criticalSeconds >= timeline.actionsSeconds * 0.8)
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f),
+                           "Bound by the critical path: more cores won't help, split the modules on it");
+    }
+    else
+    {
+        double doubled = std::max(timeline.criticalSeconds, timeline.actionsSeconds / 2.0);
+        ImGui::TextColored(ImVec4(0.4f, 0.8f, 0.4f, 1.0f),
+                           "Throughput bound: twice the cores could bring the actions down to ~%.0fs", doubled);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Estimated from completion order. Compiles wait for UHT and a module links after its "
+                          "compiles; other dependencies are not visible in the log.");
+    }
+    for (auto index : timeline.criticalPath)
+    {
+        ImGui::BulletText("%s %s (%.1fs)", actions[index].kind.c_str(), actions[index].name.c_str(),
+                          actions[index].seconds);
+    }
+
+    ImGui::SetNextItemWidth(150);
+    ImGui::SliderFloat("Zoom", &m_timelineZoom, 0.5f, 500.0f, "%.1f px/s");
+    ImGui::SameLine();
+    if (ImGui::Button("Fit"))
+    {
+        m_timelineFit = true;
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("Ctrl+wheel to zoom");
+
+    ImGui::BeginChild("TimelineCanvas", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+    const float rowHeight = 18.0f;
+    const float axisHeight = 20.0f;
+    float visibleWidth = ImGui::GetWindowWidth();
+    if (m_timelineFit)
+    {
+        m_timelineZoom = std::max(0.5f, (visibleWidth - 30.0f) / static_cast<float>(timeline.duration));
+        m_timelineFit = false;
+    }
+
+    // Ctrl+wheel zooms around the time under the mouse
+    ImGuiIO& io = ImGui::GetIO();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float scrollX = ImGui::GetScrollX();
+    if (ImGui::IsWindowHovered() && io.KeyCtrl && io.MouseWheel != 0.0f)
+    {
+        float mouseTime = (io.MousePos.x - origin.x) / m_timelineZoom;
+        float zoom = std::clamp(m_timelineZoom * std::pow(1.25f, io.MouseWheel), 0.5f, 500.0f);
+        scrollX = std::max(0.0f, scrollX + mouseTime * (zoom - m_timelineZoom));
+        ImGui::SetScrollX(scrollX);
+        origin.x -= mouseTime * (zoom - m_timelineZoom);
+        m_timelineZoom = zoom;
+    }
+
+    float zoom = m_timelineZoom;
+    float height = axisHeight + rowHeight * (timeline.slots + 1);
+    ImGui::Dummy(ImVec2(static_cast<float>(timeline.duration) * zoom + 20.0f, height));
+
+    // Only the visible time range is drawn, which keeps builds with tens of thousands of actions smooth
+    float t0 = scrollX / zoom;
+    float t1 = (scrollX + visibleWidth) / zoom;
+    auto* drawList = ImGui::GetWindowDrawList();
+    auto toX = [&](float t) { return origin.x + t * zoom; };
+    float top = origin.y + axisHeight;
+    float bottom = top + rowHeight * (timeline.slots + 1);
+    const ImU32 denseColor = IM_COL32(90, 110, 150, 255);
+
+    // Time axis with a tick spacing of at least 80 px
+    static const float steps[] = {1, 2, 5, 10, 15, 30, 60, 120, 300, 600, 1800, 3600};
+    float step = steps[IM_ARRAYSIZE(steps) - 1];
+    for (float candidate : steps)
+    {
+        if (candidate * zoom >= 80.0f)
+        {
+            step = candidate;
+            break;
+        }
+    }
+    for (float t = std::floor(t0 / step) * step; t <= t1; t += step)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), t >= 60.0f ? "%.0fm%02.0fs" : "%.0fs", t >= 60.0f ? std::floor(t / 60.0f) : t,
+                 std::fmod(t, 60.0f));
+        drawList->AddLine(ImVec2(toX(t), top - 4.0f), ImVec2(toX(t), bottom), IM_COL32(255, 255, 255, 30));
+        drawList->AddText(ImVec2(toX(t) + 2.0f, origin.y), IM_COL32(180, 180, 180, 255), label);
+    }
+
+    // Row 0 is UHT, then one row per process slot
+    if (timeline.uhtEnd > timeline.uhtStart)
+    {
+        drawList->AddRectFilled(ImVec2(toX(static_cast<float>(timeline.uhtStart)), top + 1.0f),
+                                ImVec2(toX(static_cast<float>(timeline.uhtEnd)), top + rowHeight - 1.0f),
+                                IM_COL32(200, 160, 60, 255));
+        drawList->AddText(ImVec2(toX(static_cast<float>(timeline.uhtStart)) + 2.0f, top + 2.0f),
+                          IM_COL32(0, 0, 0, 255), "UHT");
+    }
+
+    const BuildTimeline::Bar* hovered = nullptr;
+    for (unsigned slot = 0; slot < timeline.slots; ++slot)
+    {
+        const auto& row = timeline.rows[slot];
+        float y0 = top + rowHeight * (slot + 1) + 1.0f;
+        float y1 = y0 + rowHeight - 2.0f;
+
+        // Bars within a slot never overlap, so ends are sorted as well as starts
+        auto it = std::partition_point(row.begin(), row.end(), [t0](const auto& bar) { return bar.end < t0; });
+
+        // Bars narrower than a pixel are merged into one dense block instead of drawn one by one
+        float runStart = -1.0f;
+        float runEnd = -1.0f;
+        for (; it != row.end() && it->start <= t1; ++it)
+        {
+            float x0 = toX(it->start);
+            float x1 = toX(it->end);
+            if (x1 - x0 < 1.5f && !it->critical)
+            {
+                if (runStart >= 0.0f && x0 <= runEnd + 1.0f)
+                {
+                    runEnd = std::max(runEnd, x1);
+                    continue;
+                }
+                if (runStart >= 0.0f)
+                    drawList->AddRectFilled(ImVec2(runStart, y0), ImVec2(runEnd + 1.0f, y1), denseColor);
+                runStart = x0;
+                runEnd = x1;
+                continue;
+            }
+
+            const auto& action = actions[it->action];
+            ImU32 color = action.kind == "Link"      ? IM_COL32(150, 100, 200, 255)
+                          : action.kind == "Compile" ? IM_COL32(70, 130, 200, 255)
+                                                     : IM_COL32(120, 120, 120, 255);
+            if (it->critical)
+                color = IM_COL32(220, 70, 70, 255);
+            drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1 - 1.0f, y1), color);
+            if (x1 - x0 > 40.0f)
+            {
+                drawList->PushClipRect(ImVec2(x0, y0), ImVec2(x1 - 1.0f, y1), true);
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 1.0f), IM_COL32(255, 255, 255, 255), action.name.c_str());
+                drawList->PopClipRect();
+            }
+            if (io.MousePos.y >= y0 && io.MousePos.y < y1 && io.MousePos.x >= x0 && io.MousePos.x < x1)
+                hovered = &*it;
+        }
+        if (runStart >= 0.0f)
+            drawList->AddRectFilled(ImVec2(runStart, y0), ImVec2(runEnd + 1.0f, y1), denseColor);
+    }
+
+    if (hovered && ImGui::IsWindowHovered())
+    {
+        const auto& action = actions[hovered->action];
+        ImGui::SetTooltip("%s %s\nModule: %s\nStart %.1fs, %.1fs%s", action.kind.c_str(), action.name.c_str(),
+                          action.module.empty() ? "-" : action.module.c_str(), hovered->start, action.seconds,
+                          hovered->critical ? "\nOn the critical path" : "");
+    }
+
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+void UI::renderEngineVersionsWindow()
+{
+    ImGui::SetNextWindowSize(ImVec2(600, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Engine Versions", &m_showEngineVersionsWindow))
+    {
+        // Add new engine version
+        ImGui::Text("Add Engine Version:");
+
+        ImGui::InputText("Name", m_newEngineName, sizeof(m_newEngineName));
+        ImGui::InputText("Path", m_newEnginePath, sizeof(m_newEnginePath));
+
+        if (ImGui::Button("Add Engine"))
+        {
+            if (strlen(m_newEngineName) > 0 && strlen(m_newEnginePath) > 0)
+            {
+                m_engineManager->addVersion(m_newEngineName, m_newEnginePath);
+                m_newEngineName[0] = '\0';
+                m_newEnginePath[0] = '\0';
+            }
+        }
+
+        ImGui::Separator();
+
+        // List existing engines
+        ImGui::Text("Configured Engines:");
+
+        if (m_engineManager)
+        {
+            const auto& engines = m_engineManager->getVersions();
+
+            if (ImGui::BeginTable("EnginesTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 100);
+                ImGui::TableSetupColumn("Path", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 130);
+                ImGui::TableHeadersRow();
+
+                std::string toRemove;
+                std::string toEdit;
                 for (const auto& engine : engines)
                 {
                     ImGui::TableNextRow();
@@ -742,8 +2070,528 @@ void UI::renderAddProjectWindow()
     ImGui::End();
 }
 
+void UI::queueJob(const Project& project, JobKind kind)
+{
+    auto* engine = m_engineManager ? m_engineManager->findVersion(project.engineVersion) : nullptr;
+    if (!engine)
+    {
+        log("Engine version not found for " + project.name + ": " + project.engineVersion, true);
+        return;
+    }
+
+    BuildJob job;
+    job.projectName = project.name;
+    job.enginePath = engine->path;
+    job.uprojectPath = project.uprojectPath;
+    job.kind = kind;
+    if (kind == JobKind::Package)
+    {
+        job.platform = static_cast<Platform>(m_selectedPlatformIndex);
+        job.outputPath = project.path / "Package" / platformToString(job.platform);
+        job.packageOptions = m_packageOptions;
+    }
+    m_buildQueue->enqueue(std::move(job));
+}
+
+void UI::stopWatching(const std::string& projectName)
+{
+    auto it = m_watchers.find(projectName);
+    if (it == m_watchers.end())
+        return;
+
+    auto finished = [](const std::future<void>& teardown)
+    { return teardown.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+    m_watcherTeardowns.erase(std::remove_if(m_watcherTeardowns.begin(), m_watcherTeardowns.end(), finished),
+                             m_watcherTeardowns.end());
+    // Joining the watch thread waits out a poll or a whole rescan of the sources
+    m_watcherTeardowns.push_back(
+        std::async(std::launch::async, [watcher = std::move(it->second)]() mutable { watcher.reset(); }));
+    m_watchers.erase(it);
+}
+
+bool UI::isWatchBuilding(const std::string& projectName) const
+{
+    auto it = m_watchers.find(projectName);
+    return it != m_watchers.end() && it->second->getState().status == WatchStatus::Building;
+}
+
+void UI::renderPackageMatrixWindow()
+{
+    TRACE_SCOPE("renderPackageMatrixWindow", "ui");
+    ImGui::SetNextWindowSize(ImVec2(700, 350), ImGuiCond_FirstUseEver);
+
+    if (!ImGui::Begin("Package Matrix", &m_showPackageMatrixWindow))
+    {
+        ImGui::End();
+        return;
+    }
+
+    static const Platform platforms[] = {Platform::Windows, Platform::Linux, Platform::Mac, Platform::Android};
+    static const BuildConfiguration configs[] = {BuildConfiguration::Development, BuildConfiguration::Shipping,
+                                                 BuildConfiguration::Debug};
+
+    if (m_selectedProject)
+    {
+        ImGui::Text("Project: %s", m_selectedProject->name.c_str());
+        ImGui::Text("Platforms:");
+        for (int i = 0; i < IM_ARRAYSIZE(platforms); ++i)
+        {
+            ImGui::SameLine();
+            ImGui::Checkbox(platformToString(platforms[i]).c_str(), &m_matrixPlatforms[i]);
+        }
+        ImGui::Text("Configurations:");
+        for (int i = 0; i < IM_ARRAYSIZE(configs); ++i)
+        {
+            ImGui::SameLine();
+            ImGui::Checkbox(buildConfigToString(configs[i]).c_str(), &m_matrixConfigs[i]);
+        }
+
+        std::vector<Platform> selectedPlatforms;
+        std::vector<BuildConfiguration> selectedConfigs;
+        for (int i = 0; i < IM_ARRAYSIZE(platforms); ++i)
+        {
+            if (m_matrixPlatforms[i])
+                selectedPlatforms.push_back(platforms[i]);
+        }
+        for (int i = 0; i < IM_ARRAYSIZE(configs); ++i)
+        {
+            if (m_matrixConfigs[i])
+                selectedConfigs.push_back(configs[i]);
+        }
+
+        auto* engine = m_engineManager ? m_engineManager->findVersion(m_selectedProject->engineVersion) : nullptr;
+        ImGui::BeginDisabled(!engine || m_selectedProject->missing || selectedPlatforms.empty() ||
+                             selectedConfigs.empty());
+        if (ImGui::Button("Start Matrix", ImVec2(120, 0)))
+        {
+            BuildJob base;
+            base.projectName = m_selectedProject->name;
+            base.enginePath = engine->path;
+            base.uprojectPath = m_selectedProject->uprojectPath;
+            base.outputPath = m_selectedProject->path / "Package";
+            m_packageMatrixId = m_buildQueue->enqueuePackageMatrix(base, selectedPlatforms, selectedConfigs);
+            m_packageMatrixProject = m_selectedProject->name;
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::TextDisabled("Compiles run in parallel, each platform is cooked once for all configurations");
+    }
+
+    if (m_packageMatrixId == 0)
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Cells of the last matrix, looked up in the queue
+    auto jobs = m_buildQueue->getJobs();
+    auto now = std::chrono::steady_clock::now();
+    auto findJob = [&](JobKind kind, Platform platform, const BuildConfiguration* config) -> const BuildJob*
+    {
+        for (const auto& job : jobs)
+        {
+            if (job.matrixId == m_packageMatrixId && job.kind == kind && job.platform == platform &&
+                (!config || job.config == *config))
+                return &job;
+        }
+        return nullptr;
+    };
+    auto showJob = [&](const char* label, const BuildJob* job)
+    {
+        if (!job)
+        {
+            ImGui::TextDisabled("%s: -", label);
+            return;
+        }
+        ImVec4 color(0.6f, 0.6f, 0.6f, 1.0f);
+        if (job->state == JobState::Running)
+            color = ImVec4(0.4f, 0.7f, 1.0f, 1.0f);
+        else if (job->state == JobState::Succeeded)
+            color = ImVec4(0.4f, 0.8f, 0.4f, 1.0f);
+        else if (job->state == JobState::Failed || job->state == JobState::Cancelled)
+            color = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+
+        if (job->state == JobState::Queued)
+        {
+            ImGui::TextColored(color, "%s: queued", label);
+            return;
+        }
+        auto end = job->state == JobState::Running ? now : job->finishedAt;
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(end - job->startedAt).count();
+        ImGui::TextColored(color, "%s: %s %lldm%02llds", label, BuildQueue::jobStateToString(job->state).c_str(),
+                           static_cast<long long>(seconds / 60), static_cast<long long>(seconds % 60));
+    };
+
+    ImGui::Separator();
+    ImGui::Text("Matrix for %s", m_packageMatrixProject.c_str());
+    for (const auto& job : jobs)
+    {
+        if (job.matrixId == m_packageMatrixId && job.kind == JobKind::Build)
+            showJob("Editor build", &job);
+    }
+
+    // Configurations that are part of this matrix, in display order
+    std::vector<BuildConfiguration> matrixConfigs;
+    std::vector<Platform> matrixPlatforms;
+    for (auto platform : platforms)
+    {
+        if (findJob(JobKind::Cook, platform, nullptr))
+            matrixPlatforms.push_back(platform);
+    }
+    for (const auto& config : configs)
+    {
+        for (auto platform : matrixPlatforms)
+        {
+            if (findJob(JobKind::Compile, platform, &config))
+            {
+                matrixConfigs.push_back(config);
+                break;
+            }
+        }
+    }
+
+    if (ImGui::BeginTable("PackageMatrix", static_cast<int>(matrixConfigs.size()) + 2,
+                          ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Platform", ImGuiTableColumnFlags_WidthFixed, 80);
+        ImGui::TableSetupColumn("Cook", ImGuiTableColumnFlags_WidthStretch);
+        for (auto config : matrixConfigs)
+        {
+            ImGui::TableSetupColumn(buildConfigToString(config).c_str(), ImGuiTableColumnFlags_WidthStretch);
+        }
+        ImGui::TableHeadersRow();
+
+        for (auto platform : matrixPlatforms)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", platformToString(platform).c_str());
+            ImGui::TableNextColumn();
+            showJob("Cook", findJob(JobKind::Cook, platform, nullptr));
+            for (const auto& config : matrixConfigs)
+            {
+                ImGui::TableNextColumn();
+                showJob("Compile", findJob(JobKind::Compile, platform, &config));
+                showJob("Stage", findJob(JobKind::Stage, platform, &config));
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void UI::renderBuildQueueWindow()
+{
+    TRACE_SCOPE("renderBuildQueueWindow", "ui");
+    ImGui::SetNextWindowSize(ImVec2(700, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Build Queue", &m_showBuildQueueWindow))
+    {
+        auto capacity = m_buildQueue->getCapacity();
+        auto jobs = m_buildQueue->getJobs();
+
+        unsigned usedCores = 0;
+        uint64_t reserved = 0;
+        for (const auto& job : jobs)
+        {
+            if (job.state == JobState::Running)
+            {
+                usedCores += job.cores;
+                reserved += job.memoryReserved;
+            }
+        }
+
+        ImGui::Text("Cores: %u / %u in use", usedCores, capacity.cores);
+        if (capacity.memoryTotal > 0)
+        {
+            ImGui::SameLine();
+            ImGui::Text("  Memory: %s available of %s, %s reserved by jobs",
+                        formatBytes(capacity.memoryAvailable).c_str(), formatBytes(capacity.memoryTotal).c_str(),
+                        formatBytes(reserved).c_str());
+        }
+
+        auto& monitor = m_buildQueue->getPressureMonitor();
+        auto pressure = monitor.getPressure();
+        if (pressure.memory.available)
+        {
+            ImGui::Text("Pressure: memory %.1f%% full, CPU %.1f%% some (avg10)", pressure.memory.fullAvg10,
+                        pressure.cpu.someAvg10);
+        }
+
+        // Admission settings
+        if (ImGui::CollapsingHeader("Settings"))
+        {
+            auto settings = m_buildQueue->getSettings();
+            int concurrent = static_cast<int>(settings.targetConcurrentJobs);
+            int minCores = static_cast<int>(settings.minCoresPerJob);
+            float perAction = static_cast<float>(settings.memoryPerAction) / (1ull << 30);
+            float cook = static_cast<float>(settings.memoryForCook) / (1ull << 30);
+            float reserve = static_cast<float>(settings.memoryReserve) / (1ull << 30);
+
+            bool changed = false;
+            ImGui::SetNextItemWidth(120);
+            changed |= ImGui::InputInt("Concurrent jobs", &concurrent);
+            ImGui::SetNextItemWidth(120);
+            changed |= ImGui::InputInt("Min cores per job", &minCores);
+            ImGui::SetNextItemWidth(120);
+            changed |= ImGui::InputFloat("GiB per compile action", &perAction, 0.5f, 1.0f, "%.1f");
+            ImGui::SetNextItemWidth(120);
+            changed |= ImGui::InputFloat("GiB for cooking", &cook, 1.0f, 2.0f, "%.1f");
+            ImGui::SetNextItemWidth(120);
+            changed |= ImGui::InputFloat("GiB kept free", &reserve, 0.5f, 1.0f, "%.1f");
+
+            if (changed)
+            {
+                settings.targetConcurrentJobs = static_cast<unsigned>(std::max(1, concurrent));
+                settings.minCoresPerJob = static_cast<unsigned>(std::max(1, minCores));
+                settings.memoryPerAction = static_cast<uint64_t>(std::max(0.1f, perAction) * (1ull << 30));
+                settings.memoryForCook = static_cast<uint64_t>(std::max(0.0f, cook) * (1ull << 30));
+                settings.memoryReserve = static_cast<uint64_t>(std::max(0.0f, reserve) * (1ull << 30));
+                m_buildQueue->setSettings(settings);
+            }
+
+            auto throttle = monitor.getSettings();
+            bool throttleChanged = ImGui::Checkbox("Pause or deprioritize jobs under pressure", &throttle.enabled);
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Uses /proc/pressure, jobs are resumed once pressure falls back");
+            }
+            ImGui::BeginDisabled(!throttle.enabled);
+            ImGui::SetNextItemWidth(120);
+            throttleChanged |=
+                ImGui::InputFloat("Pause at memory full %", &throttle.memoryPause, 1.0f, 5.0f, "%.1f");
+            ImGui::SetNextItemWidth(120);
+            throttleChanged |=
+                ImGui::InputFloat("Resume below memory full %", &throttle.memoryResume, 1.0f, 5.0f, "%.1f");
+            ImGui::SetNextItemWidth(120);
+            throttleChanged |=
+                ImGui::InputFloat("Deprioritize at CPU some %", &throttle.cpuDeprioritize, 5.0f, 10.0f, "%.1f");
+            ImGui::EndDisabled();
+            if (throttleChanged)
+            {
+                throttle.memoryResume = std::min(throttle.memoryResume, throttle.memoryPause);
+                monitor.setSettings(throttle);
+            }
+        }
+
+        if (ImGui::Button("Clear Finished"))
+        {
+            m_buildQueue->clearFinished();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel All"))
+        {
+            m_buildQueue->cancelAll();
+        }
+
+        if (ImGui::BeginTable("JobsTable", 6,
+                              ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+        {
+            ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Job", ImGuiTableColumnFlags_WidthFixed, 70);
+            ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 80);
+            ImGui::TableSetupColumn("Cores", ImGuiTableColumnFlags_WidthFixed, 50);
+            ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 60);
+            ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 60);
+            ImGui::TableHeadersRow();
+
+            auto now = std::chrono::steady_clock::now();
+            for (const auto& job : jobs)
+            {
+                ImGui::TableNextRow();
+                ImGui::PushID(static_cast<int>(job.id));
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", job.projectName.c_str());
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%s", BuildQueue::jobKindToString(job.kind).c_str());
+
+                ImGui::TableSetColumnIndex(2);
+                ImVec4 color(0.8f, 0.8f, 0.8f, 1.0f);
+                if (job.state == JobState::Succeeded)
+                    color = ImVec4(0.4f, 0.9f, 0.4f, 1.0f);
+                else if (job.state == JobState::Failed)
+                    color = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
+                else if (job.state == JobState::Queued || job.state == JobState::Cancelled)
+                    color = ImVec4(0.5f, 0.5f, 0.5f, 1.0f);
+                if (!job.throttleReason.empty())
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Throttled");
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("%s", job.throttleReason.c_str());
+                    }
+                }
+                else
+                {
+                    ImGui::TextColored(color, "%s", BuildQueue::jobStateToString(job.state).c_str());
+                }
+
+                ImGui::TableSetColumnIndex(3);
+                if (job.cores > 0)
+                    ImGui::Text("%u", job.cores);
+
+                ImGui::TableSetColumnIndex(4);
+                if (job.state != JobState::Queued && job.cores > 0)
+                {
+                    auto end = job.state == JobState::Running ? now : job.finishedAt;
+                    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(end - job.startedAt).count();
+                    ImGui::Text("%lld:%02lld", static_cast<long long>(seconds / 60),
+                                static_cast<long long>(seconds % 60));
+                }
+
+                ImGui::TableSetColumnIndex(5);
+                if (job.state == JobState::Queued || job.state == JobState::Running)
+                {
+                    if (ImGui::SmallButton("Cancel"))
+                    {
+                        m_buildQueue->cancel(job.id);
+                    }
+                }
+
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
+
+void UI::renderEditorsWindow()
+{
+    TRACE_SCOPE("renderEditorsWindow", "ui");
+    ImGui::SetNextWindowSize(ImVec2(760, 420), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Running Editors", &m_showEditorsWindow))
+    {
+        auto& supervisor = EditorSupervisor::instance();
+        auto instances = supervisor.getInstances();
+        if (instances.empty())
+        {
+            ImGui::TextDisabled("No editor launched yet");
+        }
+        else
+        {
+            if (ImGui::BeginTable("EditorsTable", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg,
+                                  ImVec2(0, 160)))
+            {
+                ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("PID", ImGuiTableColumnFlags_WidthFixed, 60);
+                ImGui::TableSetupColumn("Uptime", ImGuiTableColumnFlags_WidthFixed, 70);
+                ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_WidthFixed, 60);
+                ImGui::TableSetupColumn("Memory", ImGuiTableColumnFlags_WidthFixed, 80);
+                ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 80);
+                ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 120);
+                ImGui::TableHeadersRow();
+
+                for (const auto& instance : instances)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::PushID(static_cast<int>(instance.id));
+
+                    ImGui::TableSetColumnIndex(0);
+                    auto name = instance.label.empty() ? instance.project : instance.project + " " + instance.label;
+                    if (ImGui::Selectable(name.c_str(), m_editorSelected == instance.id,
+                                          ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap))
+                    {
+                        m_editorSelected = instance.id;
+                    }
+                    if (!instance.cpus.empty() && ImGui::IsItemHovered())
+                    {
+                        std::string cpus;
+                        for (int cpu : instance.cpus)
+                            cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+                        ImGui::SetTooltip("Pinned to CPUs %s", cpus.c_str());
+                    }
+
+                    ImGui::TableSetColumnIndex(1);
+                    if (instance.pid > 0)
+                        ImGui::Text("%d", instance.pid);
+
+                    if (instance.running)
+                    {
+                        ImGui::TableSetColumnIndex(2);
+                        auto seconds = static_cast<long long>(instance.uptimeSeconds);
+                        ImGui::Text("%lld:%02lld:%02lld", seconds / 3600, seconds / 60 % 60, seconds % 60);
+
+                        // Shader workers run in the editor's process group and are included
+                        ImGui::TableSetColumnIndex(3);
+                        if (instance.processes > 0)
+                            ImGui::Text("%.0f%%", instance.cpuPercent);
+                        ImGui::TableSetColumnIndex(4);
+                        if (instance.processes > 0)
+                        {
+                            ImGui::Text("%s", formatBytes(instance.residentBytes).c_str());
+                            if (ImGui::IsItemHovered())
+                                ImGui::SetTooltip("%zu process(es)", instance.processes);
+                        }
+                    }
+
+                    ImGui::TableSetColumnIndex(5);
+                    if (instance.running)
+                        ImGui::TextColored(ImVec4(0.4f, 0.9f, 0.4f, 1.0f), "%s",
+                                           instance.killRequested ? "Closing" : "Running");
+                    else if (instance.exitCode == 0 || instance.killRequested)
+                        ImGui::TextDisabled("Closed");
+                    else
+                        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Exit %d", instance.exitCode);
+
+                    ImGui::TableSetColumnIndex(6);
+                    if (instance.running)
+                    {
+                        ImGui::BeginDisabled(instance.pid == 0);
+                        if (ImGui::SmallButton("Focus"))
+                        {
+                            supervisor.focus(instance.id);
+                        }
+                        ImGui::EndDisabled();
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton(instance.killRequested ? "Kill" : "Close"))
+                        {
+                            supervisor.kill(instance.id);
+                        }
+                    }
+                    else if (ImGui::SmallButton("Dismiss"))
+                    {
+                        supervisor.dismiss(instance.id);
+                        if (m_editorSelected == instance.id)
+                            m_editorSelected = 0;
+                    }
+
+                    ImGui::PopID();
+                }
+                ImGui::EndTable();
+            }
+
+            // Output tail of the selected editor, the newest one by default
+            auto selected =
+                std::find_if(instances.begin(), instances.end(),
+                             [this](const EditorInstanceInfo& info) { return info.id == m_editorSelected; });
+            const auto& shown = selected != instances.end() ? *selected : instances.back();
+            ImGui::Text("Output of %s%s%s", shown.project.c_str(), shown.label.empty() ? "" : " ",
+                        shown.label.c_str());
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Full output in %s", shown.logPath.string().c_str());
+            ImGui::BeginChild("EditorOutput", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+            for (const auto& line : supervisor.getLogTail(shown.id))
+            {
+                ImGui::Text("%s", line.c_str());
+            }
+            if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 10)
+            {
+                ImGui::SetScrollHereY(1.0f);
+            }
+            ImGui::EndChild();
+        }
+    }
+    ImGui::End();
+}
+
 void UI::renderLogPanel()
 {
+    TRACE_SCOPE("renderLogPanel", "ui");
     ImGui::Text("Log");
     ImGui::SameLine();
     if (ImGui::Button("Clear"))
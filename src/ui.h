@@ -1,10 +1,18 @@
 #pragma once
 
+#include "build_history.h"
+#include "editor_startup.h"
+#include "package_size.h"
+#include "profiling.h"
+#include "build_queue.h"
 #include "engine.h"
+#include "multiplayer.h"
 #include "project.h"
+#include "source_watcher.h"
 #include "utils.h"
 #include <deque>
 #include <mutex>
+#include <set>
 #include <string>
 #include <unordered_map>
 
@@ -17,9 +25,19 @@ namespace unreal
 class UI
 {
   public:
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
     UI();
     ~UI();
 
+    // Decodes the default project icon, safe to call from another thread before the first render()
+    void decodeDefaultIcon();
+
     bool init();
     void shutdown();
     void render();
@@ -43,20 +61,47 @@ class UI
     void renderEngineVersionsWindow();
     void renderAddProjectWindow();
     void renderLogPanel();
+    void renderBuildQueueWindow();
+    void renderEditorsWindow();
+    void renderPackageMatrixWindow();
+    void renderTargetSelection(bool actionsDisabled);
+    void renderModuleSelection(bool actionsDisabled);
+    void startScopedBuild(BuildScope scope);
+    void renderBuildHistory();
+    void renderStartupTrend();
+    void renderMultiplayer();
+    void renderProfiling();
+    void renderPackageSizes();
+    void renderBuildTimelineWindow();
+    void queueJob(const Project& project, JobKind kind);
+    // Destroys the project's watcher in the background, it may take a moment to stop
+    void stopWatching(const std::string& projectName);
+    bool isWatchBuilding(const std::string& projectName) const;
+    void saveTrace();
 
     void loadProjectIcon(const Project& project);
+    void uploadDecodedIcons();
     GLuint getProjectIcon(const std::string& projectName);
 
+    static Image decodeImage(const std::filesystem::path& path);
+    static GLuint createTexture(const Image& image);
+
     GLFWwindow* m_window = nullptr;
     ProjectManager* m_projectManager = nullptr;
     EngineManager* m_engineManager = nullptr;
 
     // UI State
     Project* m_selectedProject = nullptr;
+    std::string m_selectedProjectName;
+    uint64_t m_projectsGeneration = 0;
     int m_selectedEngineIndex = 0;
     int m_selectedPlatformIndex = 0;
     bool m_showEngineVersionsWindow = false;
     bool m_showAddProjectWindow = false;
+    bool m_showBuildQueueWindow = false;
+    bool m_showEditorsWindow = false;
+    // Editor instance whose output is shown
+    uint64_t m_editorSelected = 0;
     bool m_addProjectIsFolder = false;
     char m_newEngineName[256] = "";
     char m_newEnginePath[1024] = "";
@@ -71,6 +116,12 @@ class UI
     // Project command line args
     char m_commandLineArgs[1024] = "";
 
+    bool m_fastClean = true;
+    bool m_skipUpToDateBuilds = true;
+    PackageOptions m_packageOptions;
+    // Folder that packages are synced to, e.g. a mounted test machine share
+    char m_deployPath[512] = "";
+
     // Log
     std::deque<std::pair<std::string, bool>> m_logMessages;
     std::mutex m_logMutex;
@@ -81,11 +132,89 @@ class UI
 
     // Icons
     std::unordered_map<std::string, GLuint> m_projectIcons;
+    std::vector<std::pair<std::string, std::future<Image>>> m_iconLoads;
+    // Icons waiting for one of the kMaxIconDecodes decode slots
+    std::deque<std::pair<std::string, std::filesystem::path>> m_iconQueue;
+    static constexpr size_t kMaxIconDecodes = 4;
+    Image m_defaultIconImage;
     GLuint m_defaultIcon = 0;
 
     // Operations
     std::unique_ptr<ProjectOperations> m_operations;
     std::future<bool> m_currentOperation;
+    std::unique_ptr<BuildQueue> m_buildQueue;
+    // Package matrix of the selected project, the queue holds the jobs
+    bool m_showPackageMatrixWindow = false;
+    bool m_matrixPlatforms[4] = {};
+    bool m_matrixConfigs[3] = {true, true, false};
+    std::string m_packageMatrixProject;
+    uint64_t m_packageMatrixId = 0;
+
+    // Projects in watch mode, by name
+    std::unordered_map<std::string, std::unique_ptr<SourceWatcher>> m_watchers;
+    // Watchers being destroyed off the UI thread
+    std::vector<std::future<void>> m_watcherTeardowns;
+    // Project the current operation runs on, its watcher is paused meanwhile
+    std::string m_operationProject;
+
+    // Multi-target build selection, reset when another project is selected
+    std::string m_targetsProject;
+    std::set<std::string> m_selectedTargets;
+    bool m_targetPlatforms[4] = {};
+    bool m_targetConfigs[3] = {true, false, false};
+
+    // Module-scoped and single file builds, reset when another project is selected
+    std::string m_modulesProject;
+    std::set<std::string> m_selectedModules;
+    std::string m_sourceFilesModule;
+    std::vector<std::filesystem::path> m_sourceFiles;
+    int m_sourceFileIndex = -1;
+    char m_sourceFileFilter[128] = "";
+
+    // Build history of the selected project, reloaded when the project or the store revision changes
+    std::string m_historyProject;
+    uint64_t m_historyRevision = 0;
+    std::vector<BuildRecord> m_historyRecords;
+    std::vector<BuildRegression> m_historyRegressions;
+    int m_historySelected = -1;
+
+    // Editor startups of the selected project with its engine
+    std::string m_startupProject;
+    std::string m_startupEngine;
+    uint64_t m_startupRevision = 0;
+    std::vector<EditorStartupRecord> m_startupRecords;
+    std::vector<BuildRegression> m_startupRegressions;
+
+    // Listen server and clients test session
+    MultiplayerProfile m_multiplayer;
+    char m_multiplayerMap[256] = "";
+    char m_multiplayerServerArgs[512] = "";
+    char m_multiplayerClientArgs[512] = "";
+    uint64_t m_multiplayerSession = 0;
+
+    // Profile sessions of the selected project, the baseline and the session compared with it
+    ProfileOptions m_profileOptions;
+    std::string m_profilingProject;
+    uint64_t m_profilingRevision = 0;
+    std::vector<ProfileSession> m_profilingSessions;
+    int m_profileBaseline = -1;
+    int m_profileCompared = -1;
+
+    // Latest package size index of the selected project and platform against the one before it
+    std::string m_sizeProject;
+    uint64_t m_sizeRevision = 0;
+    std::vector<std::string> m_sizePlatforms;
+    int m_sizePlatformIndex = 0;
+    PackageSizeIndex m_sizeIndex;
+    PackageSizeReport m_sizeReport;
+
+    // Timeline of one recorded build
+    bool m_showBuildTimelineWindow = false;
+    BuildRecord m_timelineRecord;
+    BuildTimeline m_timeline;
+    // Pixels per second
+    float m_timelineZoom = 20.0f;
+    bool m_timelineFit = false;
 };
 
 } // namespace unreal
@@ -1,20 +1,46 @@
 #include "utils.h"
+#include "archive.h"
+#include "artifact_cache.h"
+#include "build_history.h"
+#include "cgroup.h"
+#include "config.h"
+#include "deploy.h"
+#include "editor_supervisor.h"
+#include "fingerprint.h"
+#include "multiplayer.h"
+#include "package_diff.h"
+#include "package_size.h"
+#include "profiling.h"
+#include "system.h"
+#include "trace.h"
+#include "trash.h"
+#include <algorithm>
 #include <array>
 #include <cstdio>
+#include <cstring>
 #include <spdlog/spdlog.h>
 #include <thread>
 
 #ifdef _WIN32
+#include <io.h>
 #include <windows.h>
 #else
+#include <cerrno>
 #include <climits>
 #include <csignal>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #ifdef __APPLE__
 #include <mach-o/dyld.h>
 #endif
+#ifdef __linux__
+#include <sched.h>
+#endif
 #endif
 
 namespace unreal
@@ -31,6 +57,7 @@ int CommandExecutor::execute(const std::string& command)
 {
     m_running = true;
     m_cancelled = false;
+    m_detached = false;
 
     output("Executing: " + command);
 
@@ -42,6 +69,7 @@ int CommandExecutor::execute(const std::string& command)
         m_running = false;
         return -1;
     }
+    TRACE_SCOPE("Child process", "process", command);
 
     std::array<char, 256> buffer;
     std::string line;
@@ -59,9 +87,21 @@ int CommandExecutor::execute(const std::string& command)
 
     int result = _pclose(pipe);
 #else
-    // Use pipe + fork for real-time output on Unix
+    // Use pipe + fork for real-time output on Unix. Jobs fork concurrently (queue, watchers, editors), so both ends
+    // are close-on-exec: a child must not inherit another job's write end and hold its reader open. dup2 clears the
+    // flag on the child's stdout/stderr.
     int pipefd[2];
-    if (pipe(pipefd) == -1)
+#ifdef __linux__
+    int piped = pipe2(pipefd, O_CLOEXEC);
+#else
+    int piped = pipe(pipefd);
+    if (piped == 0)
+    {
+        fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+        fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    if (piped == -1)
     {
         output("Failed to create pipe", true);
         m_running = false;
@@ -80,24 +120,72 @@ int CommandExecutor::execute(const std::string& command)
 
     if (pid == 0)
     {
-        // Child process
+        // Child process, leading its own group so the whole tree can be signalled at once
+        setpgid(0, 0);
+
+        // Only async-signal-safe calls until exec
+        if (!m_launchPolicy.cgroupProcs.empty())
+        {
+            int fd = open(m_launchPolicy.cgroupProcs.c_str(), O_WRONLY | O_CLOEXEC);
+            if (fd >= 0)
+            {
+                // "0" moves the writing process
+                ssize_t written = write(fd, "0", 1);
+                (void)written;
+                close(fd);
+            }
+        }
+        if (m_launchPolicy.nice > 0)
+        {
+            setpriority(PRIO_PROCESS, 0, m_launchPolicy.nice);
+        }
+#ifdef __linux__
+        if (!m_launchPolicy.cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : m_launchPolicy.cpus)
+            {
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                    CPU_SET(cpu, &set);
+            }
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+        if (m_launchPolicy.idleIo)
+        {
+            constexpr int ioprioWhoProcess = 1;
+            constexpr int ioprioClassIdle = 3;
+            constexpr int ioprioClassShift = 13;
+            syscall(SYS_ioprio_set, ioprioWhoProcess, 0, ioprioClassIdle << ioprioClassShift);
+        }
+#endif
         close(pipefd[0]); // Close read end
 
-        // Redirect stdout and stderr to pipe
-        dup2(pipefd[1], STDOUT_FILENO);
-        dup2(pipefd[1], STDERR_FILENO);
+        // Redirect stdout and stderr to pipe, or to the output file so the parent's end sees EOF right away
+        int outputFd = pipefd[1];
+        if (!m_launchPolicy.outputFile.empty())
+        {
+            int fd = open(m_launchPolicy.outputFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd >= 0)
+                outputFd = fd;
+        }
+        dup2(outputFd, STDOUT_FILENO);
+        dup2(outputFd, STDERR_FILENO);
+        if (outputFd != pipefd[1])
+            close(outputFd);
         close(pipefd[1]);
 
-        // Disable buffering
-        setvbuf(stdout, nullptr, _IONBF, 0);
-        setvbuf(stderr, nullptr, _IONBF, 0);
-
+        // No stdio calls here: they would flush output the parent had buffered into the pipe, and exec
+        // starts the command with fresh streams anyway
         execl("/bin/sh", "sh", "-c", command.c_str(), nullptr);
         _exit(127); // exec failed
     }
 
     // Parent process
+    setpgid(pid, pid);
+    m_processGroup = pid;
     close(pipefd[1]); // Close write end
+    TRACE_SCOPE("Child process", "process", "pid " + std::to_string(pid) + ": " + command);
 
     // Read output in real-time
     std::array<char, 256> buffer;
@@ -108,7 +196,7 @@ int CommandExecutor::execute(const std::string& command)
     {
         if (m_cancelled)
         {
-            kill(pid, SIGTERM);
+            kill(-pid, SIGTERM);
             break;
         }
 
@@ -141,10 +229,27 @@ int CommandExecutor::execute(const std::string& command)
 
     close(pipefd[0]);
 
-    // Wait for child and get exit status
-    int status;
-    waitpid(pid, &status, 0);
-    int result = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    // The output may go to a file and end long before the process, wait for its exit without reaping it so
+    // detach() can stop waiting and cancel() can still signal the group
+    siginfo_t exited{};
+    while (!m_detached)
+    {
+        exited.si_pid = 0;
+        if (waitid(P_PID, pid, &exited, WEXITED | WNOHANG | WNOWAIT) != 0 || exited.si_pid != 0)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // The pid stays reserved until it is reaped, so signals sent up to here cannot hit another process
+    m_processGroup = 0;
+
+    int result = -1;
+    if (!m_detached)
+    {
+        int status;
+        waitpid(pid, &status, 0);
+        result = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
 #endif
 
     m_running = false;
@@ -198,6 +303,14 @@ std::future<int> CommandExecutor::executeAsync(const std::vector<std::string>& a
 void CommandExecutor::cancel()
 {
     m_cancelled = true;
+#ifndef _WIN32
+    // Signal right away, a stopped or silent process would never reach the check in the read loop
+    if (int group = m_processGroup)
+    {
+        kill(-group, SIGTERM);
+        kill(-group, SIGCONT);
+    }
+#endif
 }
 
 // ProjectOperations
@@ -207,60 +320,126 @@ ProjectOperations::ProjectOperations(LogCallback callback) : m_logCallback(callb
     m_executor.setOutputCallback(callback);
 }
 
-std::future<bool> ProjectOperations::clean(const std::filesystem::path& projectPath)
+int ProjectOperations::execute(JobClass jobClass, const std::filesystem::path& uprojectPath,
+                               const std::string& command, const CommandExecutor::OutputCallback& observer)
+{
+    auto& groups = ResourceGroups::instance();
+    auto placement = groups.place(jobClass, uprojectPath.stem().string());
+
+    if (observer)
+    {
+        m_executor.setOutputCallback(
+            [this, &observer](const std::string& line, bool isError)
+            {
+                observer(line, isError);
+                m_logCallback(line, isError);
+            });
+    }
+    m_executor.setLaunchPolicy(placement.launch);
+    int result = m_executor.execute(command);
+    m_executor.setLaunchPolicy({});
+    if (observer)
+    {
+        m_executor.setOutputCallback(m_logCallback);
+    }
+
+    if (auto oomKills = groups.release(placement))
+    {
+        m_logCallback("[ERR] " + std::to_string(oomKills) + " process(es) killed for exceeding the memory.max of the " +
+                          ResourceGroups::jobClassToString(jobClass) + " job class",
+                      true);
+    }
+    return result;
+}
+
+std::vector<std::filesystem::path> ProjectOperations::getCleanTargets(const std::filesystem::path& projectPath)
+{
+    std::vector<std::filesystem::path> targets;
+    for (const auto& folder : {"Binaries", "DerivedDataCache", "Intermediate", "Saved", "Script"})
+    {
+        auto folderPath = projectPath / folder;
+        if (std::filesystem::exists(folderPath))
+        {
+            targets.push_back(folderPath);
+        }
+    }
+
+    // Plugins
+    auto pluginsPath = projectPath / "Plugins";
+    if (std::filesystem::exists(pluginsPath))
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(pluginsPath))
+        {
+            if (entry.is_directory())
+            {
+                for (const auto& subfolder : {"Binaries", "Intermediate"})
+                {
+                    auto subPath = entry.path() / subfolder;
+                    if (std::filesystem::exists(subPath))
+                    {
+                        targets.push_back(subPath);
+                    }
+                }
+            }
+        }
+    }
+    return targets;
+}
+
+std::future<bool> ProjectOperations::clean(const std::filesystem::path& projectPath, CleanMode mode)
 {
+    m_cleanRunning = true;
+    m_cleanCancelled = false;
+
     return std::async(std::launch::async,
-                      [this, projectPath]()
+                      [this, projectPath, mode]()
                       {
+                          TRACE_SCOPE("Clean", "operations", projectPath.string());
+                          ResourceGroups::instance().applyToCurrentThread(JobClass::Clean);
                           m_logCallback("Cleaning project: " + projectPath.string(), false);
 
-                          std::vector<std::string> foldersToDelete = {"Binaries", "DerivedDataCache", "Intermediate",
-                                                                      "Saved", "Script"};
+                          std::vector<std::filesystem::path> targets;
+                          try
+                          {
+                              targets = getCleanTargets(projectPath);
+                          }
+                          catch (const std::exception& e)
+                          {
+                              m_logCallback("Failed to list folders to clean: " + std::string(e.what()), true);
+                              m_cleanRunning = false;
+                              return false;
+                          }
 
                           bool success = true;
-                          for (const auto& folder : foldersToDelete)
+                          for (size_t i = 0; i < targets.size(); ++i)
                           {
-                              auto folderPath = projectPath / folder;
-                              if (std::filesystem::exists(folderPath))
+                              if (m_cleanCancelled)
                               {
-                                  try
-                                  {
-                                      std::filesystem::remove_all(folderPath);
-                                      m_logCallback("Deleted: " + folderPath.string(), false);
-                                  }
-                                  catch (const std::exception& e)
-                                  {
-                                      m_logCallback("Failed to delete " + folderPath.string() + ": " + e.what(), true);
-                                      success = false;
-                                  }
+                                  m_logCallback("[ERR] Clean cancelled", true);
+                                  m_cleanRunning = false;
+                                  return false;
+                              }
+
+                              const auto& folderPath = targets[i];
+                              std::string progress =
+                                  "[" + std::to_string(i + 1) + "/" + std::to_string(targets.size()) + "] ";
+
+                              if (mode == CleanMode::Fast && TrashDeleter::instance().moveToTrash(folderPath))
+                              {
+                                  m_logCallback(progress + "Moved to trash: " + folderPath.string(), false);
+                                  continue;
                               }
-                          }
 
-                          // Clean plugins
-                          auto pluginsPath = projectPath / "Plugins";
-                          if (std::filesystem::exists(pluginsPath))
-                          {
                               try
                               {
-                                  for (const auto& entry : std::filesystem::directory_iterator(pluginsPath))
-                                  {
-                                      if (entry.is_directory())
-                                      {
-                                          for (const auto& subfolder : {"Binaries", "Intermediate"})
-                                          {
-                                              auto subPath = entry.path() / subfolder;
-                                              if (std::filesystem::exists(subPath))
-                                              {
-                                                  std::filesystem::remove_all(subPath);
-                                                  m_logCallback("Deleted: " + subPath.string(), false);
-                                              }
-                                          }
-                                      }
-                                  }
+                                  auto removed = std::filesystem::remove_all(folderPath);
+                                  m_logCallback(progress + "Deleted: " + folderPath.string() + " (" +
+                                                    std::to_string(removed) + " entries)",
+                                                false);
                               }
                               catch (const std::exception& e)
                               {
-                                  m_logCallback("Failed to clean plugins: " + std::string(e.what()), true);
+                                  m_logCallback("Failed to delete " + folderPath.string() + ": " + e.what(), true);
                                   success = false;
                               }
                           }
@@ -269,6 +448,7 @@ std::future<bool> ProjectOperations::clean(const std::filesystem::path& projectP
                           {
                               m_logCallback("[DONE] Project cleaned successfully", false);
                           }
+                          m_cleanRunning = false;
                           return success;
                       });
 }
@@ -280,6 +460,7 @@ std::future<bool> ProjectOperations::generateProjectFiles(const std::filesystem:
     return std::async(std::launch::async,
                       [this, enginePath, uprojectPath]()
                       {
+                          TRACE_SCOPE("Generate", "operations", uprojectPath.string());
                           m_logCallback("Generating project files...", false);
 
 #ifdef _WIN32
@@ -293,18 +474,20 @@ std::future<bool> ProjectOperations::generateProjectFiles(const std::filesystem:
                           std::string command =
                               "\"" + script.string() + "\" \"" + uprojectPath.string() + "\" -game 2>&1";
 
-                          int result = m_executor.execute(command);
+                          int result = execute(JobClass::Build, uprojectPath, command);
                           return result == 0;
                       });
 }
 
 std::future<bool> ProjectOperations::build(const std::filesystem::path& enginePath,
-                                           const std::filesystem::path& uprojectPath, BuildConfiguration config)
+                                           const std::filesystem::path& uprojectPath, BuildConfiguration config,
+                                           unsigned maxParallelActions, BuildScope scope)
 {
 
     return std::async(std::launch::async,
-                      [this, enginePath, uprojectPath, config]()
+                      [this, enginePath, uprojectPath, config, maxParallelActions, scope = std::move(scope)]()
                       {
+                          TRACE_SCOPE("Build", "operations", uprojectPath.string());
                           auto projectName = uprojectPath.stem().string();
                           std::string configStr = buildConfigToString(config);
                           std::string target = projectName + "Editor";
@@ -320,73 +503,355 @@ std::future<bool> ProjectOperations::build(const std::filesystem::path& enginePa
                           std::string platform = "Linux";
 #endif
 
-                          m_logCallback("Building " + target + " (" + platform + " " + configStr + ")...", false);
-
                           std::string command = "\"" + buildScript.string() + "\" " + target + " " + platform + " " +
                                                 configStr + " -Project=\"" + uprojectPath.string() +
-                                                "\" -WaitMutex -Progress -NoHotReload 2>&1";
+                                                "\" -WaitMutex -Progress -NoHotReload";
+                          if (maxParallelActions > 0)
+                          {
+                              command += " -MaxParallelActions=" + std::to_string(maxParallelActions);
+                          }
+
+                          if (!scope.isEmpty())
+                          {
+                              // Only part of the target is compiled, so neither the fingerprint nor the artifact
+                              // cache apply
+                              std::string label;
+                              if (!scope.singleFile.empty())
+                              {
+                                  command += " -SingleFile=\"" + scope.singleFile.string() + "\"";
+                                  label = scope.singleFile.filename().string();
+                              }
+                              for (const auto& module : scope.modules)
+                              {
+                                  command += " -Module=" + module;
+                                  label += (label.empty() ? "" : ", ") + module;
+                              }
+                              command += " 2>&1";
+                              m_logCallback("Building " + label + " of " + target + " (" + platform + " " + configStr +
+                                                ")...",
+                                            false);
+
+                              BuildTimingParser timings(maxParallelActions);
+                              int result =
+                                  execute(JobClass::Build, uprojectPath, command,
+                                          [&timings](const std::string& line, bool) { timings.feed(line); });
+                              recordBuild(timings, result == 0, projectName, target + " [" + label + "]", platform,
+                                          configStr);
+                              return result == 0;
+                          }
+                          command += " 2>&1";
+
+                          BuildFingerprints fingerprints(uprojectPath);
+                          auto key = BuildFingerprints::makeKey(target, platform, configStr, enginePath);
+                          auto fingerprint = fingerprints.compute(enginePath);
+                          char summary[128];
+                          snprintf(summary, sizeof(summary), "%016llx, %zu files, %zu rehashed, %.0f ms",
+                                   static_cast<unsigned long long>(fingerprint.value), fingerprint.files,
+                                   fingerprint.rehashed, fingerprint.durationMs);
+
+                          ArtifactTarget artifactTarget{target, platform, configStr};
+                          if (m_skipUpToDate && fingerprints.isUpToDate(key, fingerprint.value, artifactTarget))
+                          {
+                              m_logCallback("[DONE] " + target + " is up to date (" + summary + ")", false);
+                              return true;
+                          }
+
+                          auto& artifacts = ArtifactCache::instance();
+                          auto artifactKey = ArtifactCache::makeKey(fingerprint.value, key);
+                          if (m_skipUpToDate && artifacts.isEnabled())
+                          {
+                              auto restored =
+                                  artifacts.restore(uprojectPath.parent_path(), artifactKey, artifactTarget);
+                              if (restored.success)
+                              {
+                                  fingerprints.recordSuccess(key, fingerprint.value);
+                                  char stats[128];
+                                  snprintf(stats, sizeof(stats), "%zu files, %s, %zu stale removed, %.0f ms",
+                                           restored.files, formatBytes(restored.bytes).c_str(), restored.removed,
+                                           restored.durationMs);
+                                  m_logCallback("[DONE] Restored " + target + " from the artifact cache (" + stats +
+                                                    ")",
+                                                false);
+                                  return true;
+                              }
+                          }
+
+                          m_logCallback("Building " + target + " (" + platform + " " + configStr + ")...", false);
+                          m_logCallback("Source fingerprint " + std::string(summary), false);
+
+                          BuildTimingParser timings(maxParallelActions);
+                          int result = execute(JobClass::Build, uprojectPath, command,
+                                               [&timings](const std::string& line, bool) { timings.feed(line); });
+                          recordBuild(timings, result == 0, projectName, target, platform, configStr);
 
-                          int result = m_executor.execute(command);
+                          if (result == 0)
+                          {
+                              fingerprints.recordSuccess(key, fingerprint.value);
+                              if (artifacts.isEnabled())
+                              {
+                                  auto stored =
+                                      artifacts.store(uprojectPath.parent_path(), artifactKey, artifactTarget);
+                                  if (stored.success)
+                                  {
+                                      m_logCallback("Stored " + std::to_string(stored.files) + " files (" +
+                                                        formatBytes(stored.bytes) + ") in the artifact cache",
+                                                    false);
+                                  }
+                              }
+                          }
                           return result == 0;
                       });
 }
 
-std::future<bool> ProjectOperations::run(const std::filesystem::path& enginePath,
-                                         const std::filesystem::path& uprojectPath, const std::string& additionalArgs)
+std::future<bool> ProjectOperations::buildTargets(const std::filesystem::path& enginePath,
+                                                  const std::filesystem::path& uprojectPath,
+                                                  std::vector<BuildTargetSpec> targets, unsigned maxParallelActions)
 {
-
     return std::async(std::launch::async,
-                      [this, enginePath, uprojectPath, additionalArgs]()
+                      [this, enginePath, uprojectPath, targets = std::move(targets), maxParallelActions]()
                       {
-                          m_logCallback("Launching project...", false);
+                          TRACE_SCOPE("Build targets", "operations", uprojectPath.string());
+                          auto projectName = uprojectPath.stem().string();
 
 #ifdef _WIN32
-                          auto editor = enginePath / "Engine" / "Binaries" / "Win64" / "UnrealEditor.exe";
+                          auto buildScript = enginePath / "Engine" / "Build" / "BatchFiles" / "Build.bat";
 #elif __APPLE__
-                          auto editor = enginePath / "Engine" / "Binaries" / "Mac" / "UnrealEditor.app" /
-                                        "Contents" / "MacOS" / "UnrealEditor";
+                          auto buildScript = enginePath / "Engine" / "Build" / "BatchFiles" / "Mac" / "Build.sh";
 #else
-                          auto editor = enginePath / "Engine" / "Binaries" / "Linux" / "UnrealEditor";
+                          auto buildScript = enginePath / "Engine" / "Build" / "BatchFiles" / "Linux" / "Build.sh";
 #endif
 
-                          std::string command = "\"" + editor.string() + "\" \"" + uprojectPath.string() + "\"";
-                          if (!additionalArgs.empty())
+                          // Targets whose inputs match their last successful build are left out of the invocation
+                          BuildFingerprints fingerprints(uprojectPath);
+                          auto fingerprint = fingerprints.compute(enginePath);
+                          std::vector<std::string> keys;
+                          std::string command = "\"" + buildScript.string() + "\"";
+                          std::string names, platforms, configs;
+                          for (const auto& spec : targets)
+                          {
+                              auto platform = platformToUbtName(spec.platform);
+                              auto configStr = buildConfigToString(spec.config);
+                              auto description = spec.target + " " + platform + " " + configStr;
+                              auto key = BuildFingerprints::makeKey(spec.target, platform, configStr, enginePath);
+                              ArtifactTarget artifactTarget{spec.target, platform, configStr};
+                              if (m_skipUpToDate && fingerprints.isUpToDate(key, fingerprint.value, artifactTarget))
+                              {
+                                  m_logCallback(description + " is up to date", false);
+                                  continue;
+                              }
+
+                              keys.push_back(key);
+                              command += " -Target=\"" + description + " -Project=\\\"" + uprojectPath.string() +
+                                         "\\\"\"";
+                              names += (names.empty() ? "" : ", ") + description;
+                              if (platforms.find(platform) == std::string::npos)
+                                  platforms += (platforms.empty() ? "" : "+") + platform;
+                              if (configs.find(configStr) == std::string::npos)
+                                  configs += (configs.empty() ? "" : "+") + configStr;
+                          }
+
+                          if (keys.empty())
+                          {
+                              m_logCallback("[DONE] All " + std::to_string(targets.size()) + " targets are up to date",
+                                            false);
+                              return true;
+                          }
+
+                          m_logCallback("Building " + std::to_string(keys.size()) +
+                                            " target(s) in one UBT invocation: " + names,
+                                        false);
+                          command += " -WaitMutex -Progress -NoHotReload";
+                          if (maxParallelActions > 0)
                           {
-                              command += " " + additionalArgs;
+                              command += " -MaxParallelActions=" + std::to_string(maxParallelActions);
                           }
                           command += " 2>&1";
 
-                          int result = m_executor.execute(command);
+                          BuildTimingParser timings(maxParallelActions);
+                          int result = execute(JobClass::Build, uprojectPath, command,
+                                               [&timings](const std::string& line, bool) { timings.feed(line); });
+                          recordBuild(timings, result == 0, projectName, names, platforms, configs);
+
+                          if (result == 0)
+                          {
+                              for (const auto& key : keys)
+                              {
+                                  fingerprints.recordSuccess(key, fingerprint.value);
+                              }
+                          }
                           return result == 0;
                       });
 }
 
+void ProjectOperations::recordBuild(BuildTimingParser& timings, bool success, const std::string& project,
+                                    const std::string& target, const std::string& platform,
+                                    const std::string& configuration)
+{
+    auto record = timings.finish(success);
+    record.project = project;
+    record.target = target;
+    record.platform = platform;
+    record.configuration = configuration;
+
+    auto& history = BuildHistory::instance();
+    history.append(record);
+    if (!success)
+        return;
+
+    auto regressions = BuildHistory::findRegressions(history.load(project));
+    for (size_t i = 0; i < regressions.size() && i < 3; ++i)
+    {
+        m_logCallback("Build time regression: " + regressions[i].describe(), false);
+    }
+}
+
+uint64_t ProjectOperations::run(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                               const std::string& additionalArgs)
+{
+    return EditorSupervisor::instance().launch(enginePath, uprojectPath, additionalArgs);
+}
+
+uint64_t ProjectOperations::runMultiplayer(const std::filesystem::path& enginePath,
+                                           const std::filesystem::path& uprojectPath, const MultiplayerProfile& profile)
+{
+    auto project = uprojectPath.stem().string();
+    auto map = profile.map.empty() ? readDefaultMap(uprojectPath) : profile.map;
+    if (map.empty())
+    {
+        m_logCallback("[ERR] No map to host: " + project + " has no GameDefaultMap in Config/DefaultEngine.ini", true);
+        return 0;
+    }
+
+    std::vector<std::vector<int>> cores;
+    if (profile.pinCpus)
+    {
+        cores = readPhysicalCores();
+        if (cores.size() < profile.clients + 1)
+        {
+            m_logCallback(std::to_string(cores.size()) + " physical core(s) for " +
+                              std::to_string(profile.clients + 1) + " instances, some of them share a core",
+                          false);
+        }
+    }
+
+    auto instances = planMultiplayerLaunch(profile, project, map, cores);
+    m_logCallback("Starting " + map + " with " + std::to_string(profile.clients) + " client(s)", false);
+    return EditorSupervisor::instance().launchSession(enginePath, uprojectPath, std::move(instances),
+                                                      std::chrono::seconds(profile.staggerSeconds));
+}
+
+uint64_t ProjectOperations::runProfile(const std::filesystem::path& enginePath,
+                                       const std::filesystem::path& uprojectPath, const ProfileOptions& options,
+                                       const std::string& additionalArgs)
+{
+    if (!options.csv && !options.insights)
+    {
+        m_logCallback("[ERR] Nothing to profile: enable the CSV profiler or the Insights trace", true);
+        return 0;
+    }
+
+    auto project = uprojectPath.stem().string();
+    auto projectDir = uprojectPath.parent_path();
+    auto stamp = std::to_string(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::string args;
+    auto addArg = [&args](const std::string& arg) { args += (args.empty() ? "" : " ") + arg; };
+    if (options.game)
+        addArg("-game");
+    if (options.csv)
+        addArg("-csvCapture");
+    if (options.insights)
+    {
+        auto traceFile = projectDir / "Saved" / "Profiling" / (project + "_" + stamp + ".utrace");
+        addArg("-trace=cpu,frame,gpu -tracefile=\"" + traceFile.string() + "\"");
+    }
+    if (!additionalArgs.empty())
+        addArg(additionalArgs);
+
+    // File times are compared with the filesystem clock, a second of slack covers coarse timestamps
+    auto since = std::filesystem::file_time_type::clock::now() - std::chrono::seconds(1);
+    auto start = std::chrono::steady_clock::now();
+    auto engine = enginePath.string();
+
+    EditorLaunchOptions launch;
+    launch.label = "Profile";
+    launch.editor = false;
+    launch.onExit = [project, projectDir, engine, args, since, start](int)
+    {
+        ProfileSession session;
+        session.project = project;
+        session.engine = engine;
+        session.arguments = args;
+        session.durationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        session.timestamp =
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        collectProfilingFiles(projectDir, since, session.csvFiles, session.traceFiles);
+        if (session.csvFiles.empty() && session.traceFiles.empty())
+            return std::string("[ERR] No profiling capture found in " + (projectDir / "Saved" / "Profiling").string());
+
+        CsvProfileParser parser;
+        for (const auto& file : session.csvFiles)
+        {
+            if (!parser.parseFile(file))
+                spdlog::warn("Failed to read CSV profile {}", file);
+        }
+        session.summary = parser.finish();
+        ProfilingHistory::instance().append(session);
+
+        char summary[200];
+        snprintf(summary, sizeof(summary),
+                 "Profile of %s: %zu frames, p50 %.1f ms, p99 %.1f ms, %zu hitch(es), %zu trace(s)", project.c_str(),
+                 session.summary.frames, session.summary.p50, session.summary.p99, session.summary.hitches,
+                 session.traceFiles.size());
+        return std::string(summary);
+    };
+    return EditorSupervisor::instance().launch(enginePath, uprojectPath, args, launch);
+}
+
+namespace
+{
+// BuildCookRun stages into Saved/StagedBuilds/<Platform>, with a NoEditor suffix on UE4 and a texture format suffix
+// on Android. The most recently written match is the one of this package.
+// Newest "<Platform>[NoEditor|Client|...]" folder under parent, the layout of both StagedBuilds and the archive
+// folder UAT fills
+std::filesystem::path findPlatformDirectory(const std::filesystem::path& parent, Platform platform)
+{
+    std::string name = platform == Platform::Windows ? "Windows" : platformToUbtName(platform);
+    std::filesystem::path newest;
+    std::filesystem::file_time_type newestTime;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(parent, ec))
+    {
+        auto folder = entry.path().filename().string();
+        if (!entry.is_directory(ec) || folder.compare(0, name.size(), name) != 0)
+            continue;
+        auto time = entry.last_write_time(ec);
+        if (newest.empty() || time > newestTime)
+        {
+            newest = entry.path();
+            newestTime = time;
+        }
+    }
+    return newest;
+}
+} // namespace
+
 std::future<bool> ProjectOperations::package(const std::filesystem::path& enginePath,
                                              const std::filesystem::path& uprojectPath, Platform platform,
-                                             const std::filesystem::path& outputPath)
+                                             const std::filesystem::path& outputPath, unsigned maxParallelActions,
+                                             PackageOptions options)
 {
+    m_archiveCancelled = false;
 
     return std::async(std::launch::async,
-                      [this, enginePath, uprojectPath, platform, outputPath]()
+                      [this, enginePath, uprojectPath, platform, outputPath, maxParallelActions, options]()
                       {
+                          TRACE_SCOPE("Package", "operations", uprojectPath.string());
                           m_logCallback("Packaging project for " + platformToString(platform) + "...", false);
 
-                          std::string platformStr;
-                          switch (platform)
-                          {
-                              case Platform::Windows:
-                                  platformStr = "Win64";
-                                  break;
-                              case Platform::Linux:
-                                  platformStr = "Linux";
-                                  break;
-                              case Platform::Mac:
-                                  platformStr = "Mac";
-                                  break;
-                              case Platform::Android:
-                                  platformStr = "Android";
-                                  break;
-                          }
+                          std::string platformStr = platformToUbtName(platform);
 
 #ifdef _WIN32
                           auto uatPath = enginePath / "Engine" / "Build" / "BatchFiles" / "RunUAT.bat";
@@ -399,17 +864,415 @@ std::future<bool> ProjectOperations::package(const std::filesystem::path& engine
                                                 "-clientconfig=Shipping -serverconfig=Shipping " +
                                                 "-cook -allmaps -build -stage -pak -archive " + "-archivedirectory=\"" +
                                                 outputPath.string() + "\"";
+                          // Waits for another UBT instance on the project instead of failing
+                          std::string ubtArgs = "-WaitMutex";
+                          if (maxParallelActions > 0)
+                          {
+                              ubtArgs += " -MaxParallelActions=" + std::to_string(maxParallelActions);
+                          }
+                          command += " -ubtargs=\"" + ubtArgs + "\"";
 
-                          int result = m_executor.execute(command);
-                          return result == 0;
+                          // The archive as it was before this package, to report what actually changed
+                          PackageManifest previous;
+                          auto manifestPath = PackageManifest::getPath(uprojectPath, platformStr);
+                          if (options.incremental)
+                          {
+                              // Only recook changed assets and keep the staged files of the last package
+                              command += " -iterate -nocleanstage";
+                              std::error_code ec;
+                              if (!previous.load(manifestPath) && std::filesystem::exists(outputPath, ec))
+                              {
+                                  m_logCallback("Indexing the previous package...", false);
+                                  previous = PackageManifest::scan(outputPath);
+                              }
+                          }
+
+                          // The staged files are final once UAT reports the stage complete, compressing them right
+                          // away overlaps with the copy to the archive folder
+                          auto archiveName = uprojectPath.stem().string() + "-" + platformStr + ".tar.zst";
+                          auto archivePath = outputPath.parent_path() / archiveName;
+                          std::future<bool> archive;
+                          CommandExecutor::OutputCallback observer;
+                          if (options.compress)
+                          {
+                              observer = [&](const std::string& line, bool)
+                              {
+                                  if (archive.valid() || line.find("STAGE COMMAND COMPLETED") == std::string::npos)
+                                      return;
+                                  auto staged = findPlatformDirectory(
+                                      uprojectPath.parent_path() / "Saved" / "StagedBuilds", platform);
+                                  if (!staged.empty())
+                                  {
+                                      archive = std::async(std::launch::async, &ProjectOperations::compressPackage,
+                                                           this, staged, archivePath);
+                                  }
+                              };
+                          }
+
+                          int result = execute(JobClass::Package, uprojectPath, command, observer);
+                          if (result != 0)
+                          {
+                              if (archive.valid())
+                              {
+                                  m_archiveCancelled = true;
+                                  archive.wait();
+                              }
+                              return false;
+                          }
+
+                          if (options.incremental)
+                              reportPackageDiff(previous, outputPath, manifestPath);
+                          bool withinBudget = checkPackageSize(uprojectPath, platformStr, "Shipping", outputPath);
+
+                          if (options.compress)
+                          {
+                              // No stage marker in the output, compress the same platform folder from the
+                              // archive folder instead
+                              bool compressed = false;
+                              if (archive.valid())
+                              {
+                                  compressed = archive.get();
+                              }
+                              else
+                              {
+                                  auto archived = findPlatformDirectory(outputPath, platform);
+                                  compressed = compressPackage(archived.empty() ? outputPath : archived, archivePath);
+                              }
+                              return withinBudget && compressed;
+                          }
+                          return withinBudget;
+                      });
+}
+
+void ProjectOperations::reportPackageDiff(const PackageManifest& previous, const std::filesystem::path& outputPath,
+                                          const std::filesystem::path& manifestPath)
+{
+    auto start = std::chrono::steady_clock::now();
+    // An incremental package rewrites only part of the archive
+    auto current = PackageManifest::scan(outputPath, previous);
+    auto diff = diffPackages(previous, current);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (previous.isEmpty())
+    {
+        m_logCallback("Package indexed (" + formatBytes(current.getTotalBytes()) +
+                          "), the next incremental package reports its changes",
+                      false);
+    }
+    else
+    {
+        char elapsed[32];
+        snprintf(elapsed, sizeof(elapsed), "%.1f", seconds);
+        m_logCallback("Package diff: " + diff.describe() + " (indexed in " + elapsed + " s)", false);
+        size_t shown = std::min<size_t>(diff.files.size(), 10);
+        for (size_t i = 0; i < shown; ++i)
+        {
+            const auto& file = diff.files[i];
+            std::string line = "  " + packageChangeToString(file.change) + " " + file.path;
+            if (file.change != PackageChange::Removed)
+            {
+                line += ": " + formatBytes(file.changedBytes) + " new in " + std::to_string(file.changedChunks) +
+                        " of " + std::to_string(file.totalChunks) + " chunks";
+            }
+            m_logCallback(line, false);
+        }
+        if (diff.files.size() > shown)
+        {
+            m_logCallback("  ... and " + std::to_string(diff.files.size() - shown) + " more files", false);
+        }
+    }
+
+    if (!current.save(manifestPath))
+    {
+        spdlog::warn("Failed to write package manifest {}", manifestPath.string());
+    }
+}
+
+bool ProjectOperations::checkPackageSize(const std::filesystem::path& uprojectPath, const std::string& platform,
+                                         const std::string& configuration, const std::filesystem::path& archiveDir)
+{
+    auto project = uprojectPath.stem().string();
+    auto key = platform + "-" + configuration;
+    auto& history = PackageSizeHistory::instance();
+    auto previous = history.load(project, key, 1);
+
+    auto index = indexPackageSizes(archiveDir);
+    index.platform = key;
+    auto report = comparePackageSizes(previous.empty() ? nullptr : &previous.front(), index,
+                                      Config::instance().getPackageBudget(platform), 5);
+    history.save(project, index);
+
+    auto signedBytes = [](int64_t delta)
+    { return (delta < 0 ? "-" : "+") + formatBytes(static_cast<uint64_t>(delta < 0 ? -delta : delta)); };
+
+    std::string summary = "Package size: " + formatBytes(report.totalAfter) + " in " +
+                          std::to_string(index.files.size()) + " files, " + std::to_string(index.pakEntries.size()) +
+                          " pak entries";
+    int64_t growth = static_cast<int64_t>(report.totalAfter) - static_cast<int64_t>(report.totalBefore);
+    if (report.hasPrevious)
+        summary += " (" + signedBytes(growth) + " since the previous " + key + " package)";
+    m_logCallback(summary, false);
+    // Against nothing every file is a grower, only list them once there is a previous package
+    if (report.hasPrevious)
+    {
+        for (const auto& grower : report.growers)
+        {
+            m_logCallback("  " + signedBytes(grower.getDelta()) + " " + grower.subject, false);
+        }
+    }
+    if (!index.opaquePaks.empty())
+    {
+        m_logCallback("  " + std::to_string(index.opaquePaks.size()) +
+                          " paks have an encrypted or unreadable index and are counted as a whole",
+                      false);
+    }
+    for (const auto& violation : report.violations)
+    {
+        m_logCallback("[ERR] " + violation, true);
+    }
+    return report.violations.empty();
+}
+
+bool ProjectOperations::compressPackage(const std::filesystem::path& root, const std::filesystem::path& archivePath)
+{
+    m_logCallback("Compressing " + root.string() + " to " + archivePath.filename().string() + "...", false);
+    auto start = std::chrono::steady_clock::now();
+    auto rate = [start](uint64_t bytes)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return formatBytes(seconds > 0.0 ? static_cast<uint64_t>(bytes / seconds) : 0) + "/s";
+    };
+
+    int reported = 0;
+    // Entries always start with the platform folder name, wherever the files were taken from
+    auto result = writeCompressedArchive(root, root.filename().string(), archivePath, m_archiveCancelled,
+                                         [&](uint64_t done, uint64_t total)
+                                         {
+                                             int percent = total > 0 ? static_cast<int>(done * 100 / total) : 100;
+                                             if (percent / 10 <= reported / 10)
+                                                 return;
+                                             reported = percent;
+                                             m_logCallback("Compressing: " + std::to_string(percent) + "% (" +
+                                                               formatBytes(done) + " of " + formatBytes(total) +
+                                                               ", " + rate(done) + ")",
+                                                           false);
+                                         });
+
+    if (result.cancelled)
+    {
+        m_logCallback("[ERR] Compression cancelled", true);
+    }
+    else if (!result.success)
+    {
+        m_logCallback("[ERR] Failed to write " + archivePath.string(), true);
+    }
+    else
+    {
+        char ratio[32];
+        snprintf(ratio, sizeof(ratio), "%.1f%%",
+                 result.inputBytes > 0 ? 100.0 * result.outputBytes / result.inputBytes : 100.0);
+        m_logCallback("[DONE] Compressed " + std::to_string(result.files) + " files, " +
+                          formatBytes(result.inputBytes) + " to " + formatBytes(result.outputBytes) + " (" + ratio +
+                          ", " + rate(result.inputBytes) + "): " + archivePath.string(),
+                      false);
+    }
+    return result.success;
+}
+
+std::future<bool> ProjectOperations::deploy(const std::filesystem::path& packagePath,
+                                            const std::filesystem::path& destination,
+                                            const std::filesystem::path& manifestPath)
+{
+    m_deployRunning = true;
+    m_deployCancelled = false;
+
+    return std::async(std::launch::async,
+                      [this, packagePath, destination, manifestPath]()
+                      {
+                          ResourceGroups::instance().applyToCurrentThread(JobClass::Package);
+                          std::error_code ec;
+                          if (!std::filesystem::is_directory(packagePath, ec))
+                          {
+                              m_logCallback("Nothing to deploy, " + packagePath.string() + " does not exist", true);
+                              m_deployRunning = false;
+                              return false;
+                          }
+
+                          m_logCallback("Deploying " + packagePath.string() + " to " + destination.string() + "...",
+                                        false);
+                          auto result = deployPackage(packagePath, destination, m_deployCancelled, manifestPath);
+
+                          char elapsed[32];
+                          snprintf(elapsed, sizeof(elapsed), "%.1f", result.durationMs / 1000.0);
+                          std::string summary = std::to_string(result.filesUpdated) + " files updated, " +
+                                                std::to_string(result.filesUnchanged) + " unchanged, " +
+                                                std::to_string(result.filesRemoved) + " removed; " +
+                                                formatBytes(result.bytesTransferred) + " transferred, " +
+                                                formatBytes(result.bytesReused) + " reused (" + elapsed + " s)";
+                          if (!result.error.empty())
+                          {
+                              m_logCallback("[ERR] " + result.error, true);
+                          }
+                          else if (result.cancelled)
+                          {
+                              m_logCallback("[ERR] Deploy cancelled", true);
+                          }
+                          else if (!result.success)
+                          {
+                              m_logCallback("[ERR] Deploy failed for " + std::to_string(result.filesFailed) +
+                                                " files: " + summary,
+                                            true);
+                          }
+                          else
+                          {
+                              m_logCallback("[DONE] Deployed: " + summary, false);
+                          }
+                          m_deployRunning = false;
+                          return result.success;
+                      });
+}
+
+std::future<bool> ProjectOperations::packageStep(const std::filesystem::path& enginePath,
+                                                 const std::filesystem::path& uprojectPath, PackageStep step,
+                                                 Platform platform, BuildConfiguration config,
+                                                 const std::filesystem::path& outputPath, unsigned maxParallelActions)
+{
+    return std::async(std::launch::async,
+                      [this, enginePath, uprojectPath, step, platform, config, outputPath, maxParallelActions]()
+                      {
+                          TRACE_SCOPE("Package step", "operations",
+                                      packageStepToString(step) + " " + uprojectPath.string());
+                          std::string platformStr = platformToUbtName(platform);
+                          std::string configStr = buildConfigToString(config);
+
+#ifdef _WIN32
+                          auto uatPath = enginePath / "Engine" / "Build" / "BatchFiles" / "RunUAT.bat";
+#else
+                          auto uatPath = enginePath / "Engine" / "Build" / "BatchFiles" / "RunUAT.sh";
+#endif
+
+                          // The editor is built beforehand, no step compiles it again
+                          std::string command = "\"" + uatPath.string() + "\" BuildCookRun -project=\"" +
+                                                uprojectPath.string() + "\" -noP4 -nocompileeditor -platform=" +
+                                                platformStr;
+                          switch (step)
+                          {
+                              case PackageStep::Compile:
+                              {
+                                  m_logCallback("Compiling " + platformStr + " " + configStr + "...", false);
+                                  // Waits for another UBT instance on the project instead of failing
+                                  std::string ubtArgs = "-WaitMutex";
+                                  if (maxParallelActions > 0)
+                                  {
+                                      ubtArgs += " -MaxParallelActions=" + std::to_string(maxParallelActions);
+                                  }
+                                  command += " -clientconfig=" + configStr + " -serverconfig=" + configStr +
+                                             " -build -ubtargs=\"" + ubtArgs + "\"";
+                                  break;
+                              }
+                              case PackageStep::Cook:
+                                  m_logCallback("Cooking content for " + platformStr + "...", false);
+                                  command += " -cook -allmaps -nocompile";
+                                  break;
+                              case PackageStep::Stage:
+                              {
+                                  // Each configuration stages to its own folder so they can run side by side
+                                  m_logCallback("Staging " + platformStr + " " + configStr + "...", false);
+                                  auto staging = uprojectPath.parent_path() / "Saved" / "StagedBuilds" / configStr;
+                                  command += " -clientconfig=" + configStr + " -serverconfig=" + configStr +
+                                             " -skipcook -nocompile -stage -pak -archive -stagingdirectory=\"" +
+                                             staging.string() + "\" -archivedirectory=\"" +
+                                             (outputPath / platformStr / configStr).string() + "\"";
+                                  break;
+                              }
+                          }
+
+                          int result = execute(JobClass::Package, uprojectPath, command);
+                          if (result != 0)
+                              return false;
+                          if (step == PackageStep::Stage)
+                              return checkPackageSize(uprojectPath, platformStr, configStr,
+                                                      outputPath / platformStr / configStr);
+                          return true;
                       });
 }
 
 void ProjectOperations::cancel()
 {
+    m_cleanCancelled = true;
+    m_deployCancelled = true;
+    m_archiveCancelled = true;
     m_executor.cancel();
 }
 
+// MappedFile
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+    close();
+
+#ifdef _WIN32
+    FILE* file = fopen(path.string().c_str(), "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length > 0)
+    {
+        m_buffer.resize(static_cast<size_t>(length));
+        if (fread(m_buffer.data(), 1, m_buffer.size(), file) != m_buffer.size())
+            m_buffer.clear();
+    }
+    fclose(file);
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return m_size > 0;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const unsigned char*>(mapping);
+    m_size = static_cast<size_t>(st.st_size);
+    m_mapped = true;
+    return true;
+#endif
+}
+
+void MappedFile::close()
+{
+#ifndef _WIN32
+    if (m_mapped)
+    {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+}
+
 // Utility functions
 
 Platform getCurrentPlatform()
@@ -439,6 +1302,22 @@ std::string platformToString(Platform platform)
     return "Unknown";
 }
 
+std::string platformToUbtName(Platform platform)
+{
+    switch (platform)
+    {
+        case Platform::Windows:
+            return "Win64";
+        case Platform::Linux:
+            return "Linux";
+        case Platform::Mac:
+            return "Mac";
+        case Platform::Android:
+            return "Android";
+    }
+    return "Unknown";
+}
+
 std::string buildConfigToString(BuildConfiguration config)
 {
     switch (config)
@@ -453,6 +1332,175 @@ std::string buildConfigToString(BuildConfiguration config)
     return "Development";
 }
 
+std::string packageStepToString(PackageStep step)
+{
+    switch (step)
+    {
+        case PackageStep::Compile:
+            return "Compile";
+        case PackageStep::Cook:
+            return "Cook";
+        case PackageStep::Stage:
+            return "Stage";
+    }
+    return "Unknown";
+}
+
+std::string formatBytes(uint64_t bytes)
+{
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024.0 && unit < 4)
+    {
+        value /= 1024.0;
+        ++unit;
+    }
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buffer;
+}
+
+bool writeFileAtomic(const std::filesystem::path& path, const std::string& contents)
+{
+    std::error_code ec;
+    auto parentPath = path.parent_path();
+    if (!parentPath.empty())
+    {
+        std::filesystem::create_directories(parentPath, ec);
+    }
+
+    // Unique per call, threads of this process writing the same file must not rename each other's temp file
+    static std::atomic<uint64_t> nextTemp{0};
+    auto tempSuffix = ".tmp" + std::to_string(nextTemp++) + "-";
+
+#ifdef _WIN32
+    auto tempPath = path;
+    tempPath += tempSuffix + std::to_string(GetCurrentProcessId());
+
+    FILE* file = fopen(tempPath.string().c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    written = fflush(file) == 0 && written;
+    written = _commit(_fileno(file)) == 0 && written;
+    fclose(file);
+#else
+    auto tempPath = path;
+    tempPath += tempSuffix + std::to_string(getpid());
+
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    bool written = true;
+    size_t offset = 0;
+    while (offset < contents.size())
+    {
+        ssize_t count = write(fd, contents.data() + offset, contents.size() - offset);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            written = false;
+            break;
+        }
+        offset += static_cast<size_t>(count);
+    }
+    written = fsync(fd) == 0 && written;
+    close(fd);
+#endif
+
+    if (!written)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+#ifndef _WIN32
+    // Persist the rename itself
+    int dirFd = open(parentPath.empty() ? "." : parentPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0)
+    {
+        fsync(dirFd);
+        close(dirFd);
+    }
+#endif
+    return true;
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    // 64-bit multiply/rotate hash over 8 byte words with a murmur3 style finalizer
+    constexpr uint64_t k1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t k2 = 0xC2B2AE3D27D4EB4Full;
+
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * k1);
+
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + offset, 8);
+        hash ^= rotl(word * k2, 31) * k1;
+        hash = rotl(hash, 27) * k1 + 0x52DCE729;
+    }
+
+    uint64_t tail = 0;
+    for (size_t i = 0; offset + i < size; ++i)
+    {
+        tail |= static_cast<uint64_t>(bytes[offset + i]) << (8 * i);
+    }
+    hash ^= rotl(tail * k2, 31) * k1;
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& work, size_t maxWorkers)
+{
+    if (maxWorkers == 0)
+        maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    size_t workerCount = std::min(maxWorkers, count);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            work(i);
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < workerCount; ++i)
+    {
+        workers.push_back(std::async(std::launch::async, worker));
+    }
+    if (workerCount > 0)
+        worker();
+    for (auto& w : workers)
+    {
+        w.get();
+    }
+}
+
 std::filesystem::path getExecutablePath()
 {
 #ifdef _WIN32
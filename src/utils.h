@@ -1,13 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace unreal
 {
+class BuildTimingParser;
+class PackageManifest;
+struct MultiplayerProfile;
+struct ProfileOptions;
+
 enum class Platform
 {
     Windows,
@@ -23,6 +31,79 @@ enum class BuildConfiguration
     Debug
 };
 
+enum class CleanMode
+{
+    // Delete folders in place
+    Standard,
+    // Rename folders to the trash and delete them in the background
+    Fast
+};
+
+// Scheduling class of a launcher job, see ResourceGroups
+enum class JobClass
+{
+    Build,
+    Package,
+    Clean,
+    Editor
+};
+
+// Stages of BuildCookRun run as separate UAT invocations, so cooked content can be shared between the
+// configurations of a platform
+enum class PackageStep
+{
+    // Compile the game target for one platform and configuration
+    Compile,
+    // Cook content for a platform, independent of the configuration
+    Cook,
+    // Stage, pak and archive one configuration from its binaries and the platform's cooked content
+    Stage
+};
+
+// One target/platform/configuration combination of a multi-target build
+struct BuildTargetSpec
+{
+    std::string target;
+    Platform platform = Platform::Linux;
+    BuildConfiguration config = BuildConfiguration::Development;
+};
+
+// Narrows a build to some modules or to a single source file, an empty scope builds the whole target
+struct BuildScope
+{
+    std::vector<std::string> modules;
+    std::filesystem::path singleFile;
+
+    bool isEmpty() const
+    {
+        return modules.empty() && singleFile.empty();
+    }
+};
+
+// Optional steps of ProjectOperations::package
+struct PackageOptions
+{
+    // Cook iteratively, keep the staged files and report the chunks of the archive that changed since the last
+    // incremental package of the platform
+    bool incremental = false;
+    // Write Package/<Project>-<Platform>.tar.zst and its checksum manifest
+    bool compress = false;
+};
+
+// How the next child process is placed, applied in the child before exec so its whole tree inherits it
+struct LaunchPolicy
+{
+    // cgroup.procs of the leaf to join, empty to stay in the launcher's cgroup
+    std::string cgroupProcs;
+    int nice = 0;
+    bool idleIo = false;
+    // Logical CPUs the process tree is pinned to, empty to inherit the launcher's affinity. Linux only.
+    std::vector<int> cpus;
+    // Where the process tree writes its stdout and stderr instead of the output callback, empty for the callback.
+    // Unix only, Windows commands redirect themselves.
+    std::string outputFile;
+};
+
 class CommandExecutor
 {
   public:
@@ -34,6 +115,17 @@ class CommandExecutor
     {
         m_outputCallback = callback;
     }
+    void setLaunchPolicy(const LaunchPolicy& policy)
+    {
+        std::lock_guard<std::mutex> lock(m_launchMutex);
+        m_launchPolicy = policy;
+    }
+    // Policy the running command was launched with, read from other threads (pressure throttling)
+    LaunchPolicy getLaunchPolicy() const
+    {
+        std::lock_guard<std::mutex> lock(m_launchMutex);
+        return m_launchPolicy;
+    }
 
     // Synchronous execution
     int execute(const std::string& command);
@@ -45,17 +137,33 @@ class CommandExecutor
 
     // Cancel running command
     void cancel();
+    // Stops waiting for the running command and leaves it running on its own, execute() then returns -1. Only for
+    // commands whose output goes to a file, Unix only.
+    void detach()
+    {
+        m_detached = true;
+    }
     bool isRunning() const
     {
         return m_running;
     }
 
+    // Process group of the running command (its shell is the leader), 0 when idle or unsupported
+    int getProcessGroup() const
+    {
+        return m_processGroup;
+    }
+
   private:
     void output(const std::string& message, bool isError = false);
 
     OutputCallback m_outputCallback;
+    LaunchPolicy m_launchPolicy;
+    mutable std::mutex m_launchMutex;
+    std::atomic<int> m_processGroup{0};
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_cancelled{false};
+    std::atomic<bool> m_detached{false};
 };
 
 // Project operations
@@ -66,31 +174,128 @@ class ProjectOperations
 
     ProjectOperations(LogCallback callback);
 
-    std::future<bool> clean(const std::filesystem::path& projectPath);
+    std::future<bool> clean(const std::filesystem::path& projectPath, CleanMode mode = CleanMode::Standard);
     std::future<bool> generateProjectFiles(const std::filesystem::path& enginePath,
                                            const std::filesystem::path& uprojectPath);
+    // maxParallelActions limits UBT's local executor, 0 lets UBT use every core. A scoped build only compiles
+    // the given modules or file and never counts as an up-to-date build of the whole target.
     std::future<bool> build(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
-                            BuildConfiguration config = BuildConfiguration::Development);
-    std::future<bool> run(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
-                          const std::string& additionalArgs = "");
+                            BuildConfiguration config = BuildConfiguration::Development,
+                            unsigned maxParallelActions = 0, BuildScope scope = {});
+    // Builds every spec in a single UBT invocation so the targets share one action graph and executor
+    std::future<bool> buildTargets(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                                   std::vector<BuildTargetSpec> targets, unsigned maxParallelActions = 0);
+    // Hands the editor to the EditorSupervisor and returns its instance id, the editor never occupies this executor
+    uint64_t run(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                 const std::string& additionalArgs = "");
+    // Starts a listen server and its clients as one supervised session and returns the session id, 0 on error
+    uint64_t runMultiplayer(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                            const MultiplayerProfile& profile);
+    // Runs the project with the CSV profiler and/or an Insights trace, the captures it leaves in Saved/Profiling are
+    // summarized into the ProfilingHistory once it exits. Returns the instance id, 0 on error.
+    uint64_t runProfile(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                        const ProfileOptions& options, const std::string& additionalArgs = "");
     std::future<bool> package(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
-                              Platform platform, const std::filesystem::path& outputPath);
+                              Platform platform, const std::filesystem::path& outputPath,
+                              unsigned maxParallelActions = 0, PackageOptions options = {});
+    // Syncs an archived package to destination, only sending the chunks that changed since the last deploy.
+    // manifestPath is the saved manifest of the package, only the files that changed since are read again.
+    std::future<bool> deploy(const std::filesystem::path& packagePath, const std::filesystem::path& destination,
+                             const std::filesystem::path& manifestPath = {});
+    // One step of a split package, Stage archives into outputPath/<Platform>/<Configuration>
+    std::future<bool> packageStep(const std::filesystem::path& enginePath, const std::filesystem::path& uprojectPath,
+                                  PackageStep step, Platform platform, BuildConfiguration config,
+                                  const std::filesystem::path& outputPath, unsigned maxParallelActions = 0);
 
     void cancel();
     bool isRunning() const
     {
-        return m_executor.isRunning();
+        return m_executor.isRunning() || m_cleanRunning || m_deployRunning;
+    }
+    // When set, build() returns immediately if the inputs match the last successful build
+    void setSkipUpToDateBuilds(bool skip)
+    {
+        m_skipUpToDate = skip;
+    }
+    int getProcessGroup() const
+    {
+        return m_executor.getProcessGroup();
     }
+    LaunchPolicy getLaunchPolicy() const
+    {
+        return m_executor.getLaunchPolicy();
+    }
+
+    static std::vector<std::filesystem::path> getCleanTargets(const std::filesystem::path& projectPath);
 
   private:
+    // observer sees every output line before it is forwarded to the log callback
+    int execute(JobClass jobClass, const std::filesystem::path& uprojectPath, const std::string& command,
+                const CommandExecutor::OutputCallback& observer = nullptr);
+    // Appends a finished build to the history and reports timing regressions
+    void recordBuild(BuildTimingParser& timings, bool success, const std::string& project, const std::string& target,
+                     const std::string& platform, const std::string& configuration);
+    // Scans the archive of an incremental package and logs what changed since the previous one
+    void reportPackageDiff(const PackageManifest& previous, const std::filesystem::path& outputPath,
+                           const std::filesystem::path& manifestPath);
+    // Indexes the sizes of an archived package, reports the largest growers since the previous package of the same
+    // platform and configuration, and returns false when the package is over its budget
+    bool checkPackageSize(const std::filesystem::path& uprojectPath, const std::string& platform,
+                          const std::string& configuration, const std::filesystem::path& archiveDir);
+    // Archives root with its folder name as the prefix of every entry
+    bool compressPackage(const std::filesystem::path& root, const std::filesystem::path& archivePath);
+
     CommandExecutor m_executor;
     LogCallback m_logCallback;
+    std::atomic<bool> m_cleanRunning{false};
+    std::atomic<bool> m_cleanCancelled{false};
+    std::atomic<bool> m_deployRunning{false};
+    std::atomic<bool> m_deployCancelled{false};
+    std::atomic<bool> m_archiveCancelled{false};
+    std::atomic<bool> m_skipUpToDate{true};
+};
+
+// Read-only view of a whole file, memory mapped where the platform allows it
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    const unsigned char* data() const
+    {
+        return m_data;
+    }
+    size_t size() const
+    {
+        return m_size;
+    }
+
+  private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<unsigned char> m_buffer;
+    bool m_mapped = false;
 };
 
 // Utility functions
 Platform getCurrentPlatform();
 std::string platformToString(Platform platform);
+// Platform name as UBT and UAT expect it
+std::string platformToUbtName(Platform platform);
 std::string buildConfigToString(BuildConfiguration config);
+std::string packageStepToString(PackageStep step);
+std::string formatBytes(uint64_t bytes);
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// Calls work(index) for every index in [0, count) from up to maxWorkers threads (0 = hardware concurrency)
+void parallelFor(size_t count, const std::function<void(size_t)>& work, size_t maxWorkers = 0);
+bool writeFileAtomic(const std::filesystem::path& path, const std::string& contents);
 std::filesystem::path getExecutablePath();
 std::filesystem::path getConfigDirectory();
 